@@ -0,0 +1,24 @@
+﻿#pragma once
+#include <cstdint>
+
+// 是否替换全局 operator new/delete 来统计堆分配
+// 统计只是每个线程一个计数器加一，发布版本也保留
+#ifndef ENABLE_ALLOC_COUNTER
+#define ENABLE_ALLOC_COUNTER 1
+#endif
+
+// 堆分配计数：只统计当前线程，音频线程、解码线程的分配不会混进游戏线程的数字
+namespace AllocCounter {
+    uint64_t getThreadAllocations();   // 当前线程累计的分配次数
+    uint64_t getThreadBytes();         // 当前线程累计分配的字节数
+}
+
+// 统计一段代码里发生的分配次数
+class AllocationScope {
+public:
+    AllocationScope() : start(AllocCounter::getThreadAllocations()) {}
+    uint64_t count() const { return AllocCounter::getThreadAllocations() - start; }
+
+private:
+    uint64_t start;
+};
@@ -0,0 +1,78 @@
+﻿#pragma once
+#include <windows.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 资源包格式：文件头 + 条目表 + 数据区（每段数据按16字节对齐）
+// 图片存为已经缩放好的 32 位像素（可直接拷进 IMAGE 的显示缓冲区），
+// 音效存为已经解码好的 16 位 PCM，启动时不再需要 JPG/WAV 解码
+enum AssetType {
+    ASSET_IMAGE = 1,   // param0 = 宽，param1 = 高
+    ASSET_PCM = 2      // param0 = 声道数，param1 = 采样率
+};
+
+#pragma pack(push, 1)
+struct AssetBundleHeader {
+    char magic[4];          // "FBPK"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct AssetEntry {
+    char name[48];          // 原始资源路径，例如 "assets/jump.wav"
+    uint32_t type;
+    uint32_t param0;
+    uint32_t param1;
+    uint32_t reserved;
+    uint64_t offset;        // 数据在文件中的偏移
+    uint64_t size;          // 数据字节数
+};
+#pragma pack(pop)
+
+#define ASSET_BUNDLE_VERSION 1
+// 不提交到仓库：Project2 每次生成后在项目目录运行一次 FlappyBird.exe --pack 重新打包
+#define ASSET_BUNDLE_PATH "assets/assets.pak"
+
+// 资源包写入器：由打包工具（FlappyBird.exe --pack）使用
+class AssetBundleWriter {
+public:
+    void addImage(const std::string& name, const DWORD* pixels, int width, int height);
+    void addPCM(const std::string& name, const int16_t* samples, size_t sampleCount,
+        unsigned channels, unsigned sampleRate);
+    bool write(const std::string& path) const;
+
+private:
+    void addEntry(const std::string& name, uint32_t type, uint32_t param0, uint32_t param1,
+        const void* data, size_t size);
+
+    std::vector<AssetEntry> entries;
+    std::vector<char> blob;
+};
+
+// 资源包读取器：把整个文件映射进内存，条目数据直接指向映射区，不做拷贝
+class AssetBundle {
+public:
+    AssetBundle();
+    ~AssetBundle();
+
+    AssetBundle(const AssetBundle&) = delete;
+    void operator=(const AssetBundle&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    int getEntryCount() const { return header ? (int)header->entryCount : 0; }
+    const AssetEntry* getEntry(int index) const { return &entries[index]; }
+    const AssetEntry* find(const char* name) const;
+    const void* getData(const AssetEntry* entry) const { return base + entry->offset; }
+
+private:
+    HANDLE file;
+    HANDLE mapping;
+    const char* base;
+    uint64_t fileSize;
+    const AssetBundleHeader* header;
+    const AssetEntry* entries;
+};
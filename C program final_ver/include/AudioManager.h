@@ -1,8 +1,42 @@
 ﻿#pragma once
 #include <SFML/Audio.hpp>
-#include <map>
 #include <string>
-#include <vector>
+#include "AudioMixer.h"
+#include "MusicStream.h"
+
+// 音效ID：编译期确定的整数，同时也是混音器里的片段槽位号
+enum SoundId {
+    SOUND_JUMP,
+    SOUND_SCORE,
+    SOUND_COIN,
+    SOUND_HIT,
+    SOUND_MENU_MOVE,
+    SOUND_MENU_SELECT,
+    SOUND_LEVEL_1,      // 每通过5根管道播放的特殊音效（1~5轮换）
+    SOUND_LEVEL_2,
+    SOUND_LEVEL_3,
+    SOUND_LEVEL_4,
+    SOUND_LEVEL_5,
+    SOUND_UI_BGM,
+    SOUND_COUNT
+};
+
+// 声卡后端：SFML 的流线程不断向混音器要数据，
+// 这个线程也就是音频线程，游戏线程的命令在这里被取出执行
+class MixerStream : public sf::SoundStream {
+public:
+    static const int CHUNK_FRAMES = 512;   // 每次提交约11.6毫秒的音频
+
+    explicit MixerStream(AudioMixer& mixer);
+
+protected:
+    bool onGetData(Chunk& data) override;
+    void onSeek(sf::Time timeOffset) override;
+
+private:
+    AudioMixer& mixer;
+    int16_t chunk[CHUNK_FRAMES * AudioMixer::CHANNELS];
+};
 
 class AudioManager {
 public:
@@ -17,35 +51,55 @@ public:
     void operator=(const AudioManager&) = delete;
 
     // --- 音效方法 ---
-    bool loadSoundEffect(const std::string& name, const std::string& filepath);
-    void playSound(const std::string& name, float volume = 100.0f, float pitch = 1.0f);
+    bool loadSoundEffect(SoundId id, const std::string& filepath);
+    // 从已解码的 PCM 加载（资源包使用）；不同 id 可以在多个线程上同时加载
+    bool loadSoundEffect(SoundId id, const int16_t* samples, size_t sampleCount,
+        unsigned channels, unsigned sampleRate);
+    void playSound(SoundId id, float volume = 100.0f);
+
+    // --- 循环音效（找不到 UI 背景音乐文件时的替补：播放启动时解码好的片段）---
+    void startLoop(SoundId id, float volume = 100.0f);
+    void stopLoop();
 
     // --- 音乐方法 ---
+    // 不阻塞：上一次切歌还没被混音线程接手时返回 false，调用方下一帧再试
     bool playMusic(const std::string& filepath, bool loop = true);
     void stopMusic();
     void pauseMusic();   // 确保这一行存在
     void resumeMusic();  // 确保这一行存在
 
-    // --- 音量控制 ---
+    // --- 音量控制（0~100）---
     void setMasterVolume(float volume);
     void setSoundsVolume(float volume);
     void setMusicVolume(float volume);
+    void setMaxVoices(int count);    // 同时发声上限
 
     float getMasterVolume() const;
     float getSoundsVolume() const;
     float getMusicVolume() const;
     bool isMusicPlaying() const;
 
+    // 当前音乐流（查看欠载次数、缓冲水位，用于调节缓冲区大小）
+    const MusicStream& getMusicStream() const { return musicStreams[currentMusicStream]; }
+    void setMusicBufferFrames(size_t frames) { musicBufferFrames = frames; }
+
+    // 混音器（无头渲染、性能统计用）
+    AudioMixer& getMixer() { return mixer; }
+
     void cleanup();
 
 private:
     AudioManager();
     ~AudioManager();
-    void cleanFinishedSounds();
 
-    std::map<std::string, sf::SoundBuffer> soundBuffers;
-    std::vector<sf::Sound> activeSounds;
-    sf::Music backgroundMusic;
+    AudioMixer mixer;
+    MixerStream outputStream;
+
+    // 两个音乐流交替使用：切歌时新流在后台预读，旧流等混音线程放手后才会被重用
+    MusicStream musicStreams[2];
+    int currentMusicStream;
+    size_t musicBufferFrames;
+    bool musicPlaying;
 
     float masterVolume;
     float soundsVolume;
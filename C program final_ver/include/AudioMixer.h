@@ -0,0 +1,144 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "SpscQueue.h"
+
+// 混音总线：每条总线有独立音量，最终再乘以总音量
+enum MixBus {
+    MIX_BUS_SFX,     // 游戏音效
+    MIX_BUS_MUSIC,   // 背景音乐
+    MIX_BUS_UI,      // 菜单/暂停界面音乐
+    MIX_BUS_COUNT
+};
+
+// 流式音源接口：由混音线程按需拉取已解码好的交错立体声 float 数据
+// read() 运行在混音线程上，实现方不能阻塞或分配内存
+class MixStreamSource {
+public:
+    virtual ~MixStreamSource() {}
+    // 最多写入 frames 帧，返回实际写入的帧数（不足时其余部分由混音器补静音）
+    virtual size_t read(float* out, size_t frames) = 0;
+};
+
+// 混音命令：游戏线程压入，输出线程在 render() 开头统一处理
+enum MixCommandType {
+    MIX_CMD_PLAY,
+    MIX_CMD_STOP_BUS,
+    MIX_CMD_PAUSE_BUS,
+    MIX_CMD_RESUME_BUS,
+    MIX_CMD_SET_STREAM
+};
+
+struct MixCommand {
+    MixCommandType type;
+    int clip;
+    int bus;
+    float gain;
+    bool loop;
+    MixStreamSource* stream;
+};
+
+// 软件混音器：把所有声部混到一个 44.1kHz 立体声输出缓冲区
+// 不依赖 SFML / Windows，可以接到声卡后端，也可以无头渲染成 WAV 文件
+class AudioMixer {
+public:
+    static const int SAMPLE_RATE = 44100;
+    static const int CHANNELS = 2;
+    static const int MAX_VOICES = 32;        // 声部池大小（同时发声上限的最大值）
+    static const int MAX_CLIPS = 64;
+    static const int MAX_BLOCK_FRAMES = 1024; // render() 内部每次处理的最大帧数
+
+    AudioMixer();
+
+    AudioMixer(const AudioMixer&) = delete;
+    void operator=(const AudioMixer&) = delete;
+
+    // 启动时调用：把一段 int16 PCM 转成输出格式（立体声 float、44.1kHz）存入指定槽位
+    // 该槽位正在播放时不能重新加载
+    bool loadClip(int clipId, const int16_t* samples, size_t sampleCount,
+        unsigned channels, unsigned sampleRate);
+    bool isClipLoaded(int clipId) const;
+
+    // --- 生产者接口（游戏线程）：只压入定长命令，不分配内存 ---
+    bool play(int clipId, MixBus bus, float gain, bool loop = false);
+    void stopBus(MixBus bus);
+    void pauseBus(MixBus bus);
+    void resumeBus(MixBus bus);
+
+    // 设置音乐总线上的流式音源（nullptr 表示卸下）；停止音乐总线也会卸下它
+    void setMusicStream(MixStreamSource* stream);
+    // 混音线程当前正在使用的音源，调用方据此判断旧音源何时可以安全重用
+    MixStreamSource* getActiveMusicStream() const { return activeStream.load(std::memory_order_acquire); }
+
+    // 音量（0~1），任意线程可调用
+    void setBusVolume(MixBus bus, float volume);
+    void setMasterVolume(float volume);
+    float getBusVolume(MixBus bus) const;
+    float getMasterVolume() const;
+
+    // 同时发声上限（1 ~ MAX_VOICES）。新声音优先使用空闲声部，
+    // 上限内全部在发声时才抢占最早开始的非循环声部
+    void setVoiceLimit(int limit);
+    int getVoiceLimit() const;
+
+    // --- 消费者接口（输出线程）：处理命令并混出 frames 帧交错立体声 ---
+    void render(int16_t* out, size_t frames);
+
+    // 无头后端：在调用线程上渲染 seconds 秒并写成 16 位立体声 WAV 文件。
+    // beforeBlock 在每块（MAX_BLOCK_FRAMES 帧）渲染前以该块的起始帧调用，用来按时间压入脚本里的命令
+    bool renderToWav(const char* path, float seconds,
+        const std::function<void(uint64_t frame)>& beforeBlock = nullptr);
+
+    // --- 统计信息（用于性能测试）---
+    int getActiveVoices() const { return activeVoiceCount.load(std::memory_order_relaxed); }
+    uint64_t getRenderedFrames() const { return renderedFrames.load(std::memory_order_relaxed); }
+    // 每混一秒音频实际消耗的 CPU 时间（微秒）
+    double getMicrosPerSecondOfAudio() const;
+
+private:
+    struct Voice {
+        bool active;
+        bool loop;
+        int clip;
+        int bus;
+        float gain;
+        size_t position;   // 当前播放到的帧
+        uint64_t startOrder;    // 开始播放的序号，越小越早
+    };
+
+    void drainCommands();
+    void startVoice(const MixCommand& cmd);
+    int allocateVoice(int limit);
+
+    // 每个槽位是交错立体声 float 数据
+    std::vector<float> clips[MAX_CLIPS];
+    bool clipLoaded[MAX_CLIPS];
+
+    // 声部和混音缓冲区只由输出线程访问
+    Voice voices[MAX_VOICES];
+    uint64_t nextStartOrder;
+    bool busPaused[MIX_BUS_COUNT];
+    float mixBuffer[MAX_BLOCK_FRAMES * CHANNELS];
+    float streamBuffer[MAX_BLOCK_FRAMES * CHANNELS];
+    MixStreamSource* musicStream;
+    std::atomic<MixStreamSource*> activeStream;
+
+    SpscQueue<MixCommand, 256> commandQueue;
+
+    std::atomic<float> busVolume[MIX_BUS_COUNT];
+    std::atomic<float> masterVolume;
+    std::atomic<int> voiceLimit;
+
+    std::atomic<int> activeVoiceCount;
+    std::atomic<uint64_t> renderedFrames;
+    std::atomic<uint64_t> renderNanos;
+};
+
+// SIMD 混音内核（SSE2，不支持时退回标量实现）
+// dst[i] += src[i] * gain
+void mixAccumulate(float* dst, const float* src, float gain, size_t count);
+// out[i] = clamp(src[i] * gain) 转为 int16
+void mixToInt16(int16_t* out, const float* src, float gain, size_t count);
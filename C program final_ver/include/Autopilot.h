@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <cstdint>
+#include "Simulation.h"
+
+// 自动驾驶（展台待机演示、参考机器人）：对未来若干帧做束搜索（beam search），规划跳跃时机。
+// 搜索在 Simulation 上进行，当前局面由 Game 从 Bird 和 PipeManager 复制成 SimState。
+// 每帧的耗时有硬上限：超时就停止，用已经搜到的最深结果；
+// 上一帧的计划向前平移后继续使用，只在它即将失败或到了重新规划的间隔时才搜索。
+
+#define AUTOPILOT_HORIZON_TICKS 120     // 向前看的帧数（2秒，足够看到下一根管道）
+#define AUTOPILOT_TICKS_PER_STEP 3      // 每个决策点覆盖的帧数：第一帧跳或不跳，其余不跳
+#define AUTOPILOT_BEAM_WIDTH 32         // 每层保留的局面数
+#define AUTOPILOT_REPLAN_TICKS 10       // 计划仍然有效时，最多隔这么多帧重新规划一次
+#define AUTOPILOT_BUDGET_MICROS 1000    // 每帧搜索的时间上限（微秒）
+
+class Autopilot {
+public:
+    Autopilot();
+
+    // 新的一局：丢弃旧计划
+    void reset();
+
+    // 根据当前局面决定本帧是否跳跃；保证在时间上限内返回
+    bool decide(const SimState& state);
+
+    void setBudgetMicros(int micros) { budgetMicros = micros; }
+
+    // 统计（显示在性能面板上）
+    double getNodesPerSecond() const { return nodesPerSecond; }   // 搜索吞吐量：每秒模拟的帧数
+    double getAverageSearchMicros() const { return averageSearchMicros; }
+    int getPlanTicks() const { return planSurvival; }             // 当前计划能存活的帧数
+    uint64_t getBudgetOverruns() const { return budgetOverruns; } // 搜索因超时提前停止的次数
+
+private:
+    static const int DEPTH = AUTOPILOT_HORIZON_TICKS / AUTOPILOT_TICKS_PER_STEP;
+    static const int CANDIDATES = AUTOPILOT_BEAM_WIDTH * 2;
+
+    // 按计划从 state 开始模拟，返回存活的帧数（最多 AUTOPILOT_HORIZON_TICKS）
+    int evaluatePlan(const SimState& state, const uint8_t* actions, int length);
+    // 束搜索，结果写入 searchPlan；返回计划的长度（帧数）
+    int search(const SimState& root, int64_t deadlineNs);
+    float heuristic(const SimState& state) const;
+
+    // 当前计划：plan[0] 是本帧的动作
+    uint8_t plan[AUTOPILOT_HORIZON_TICKS];
+    int planLength;
+    int planSurvival;
+    int ticksSinceSearch;
+    int budgetMicros;
+
+    // 搜索用的缓冲区（构造时一次分配好，搜索过程中不再分配）
+    SimState beam[AUTOPILOT_BEAM_WIDTH];
+    SimState candidates[CANDIDATES];
+    float candidateScore[CANDIDATES];
+    int candidateOrigin[CANDIDATES];                // 来源：上一层局面编号 * 2 + 是否跳跃
+    int candidateOrder[CANDIDATES];
+    uint8_t parent[DEPTH][AUTOPILOT_BEAM_WIDTH];    // 每层每个局面来自上一层的哪个局面
+    uint8_t action[DEPTH][AUTOPILOT_BEAM_WIDTH];    // 以及在那个决策点是否跳跃
+    uint8_t searchPlan[AUTOPILOT_HORIZON_TICKS];
+
+    // 统计：每秒（60次决策）更新一次
+    uint64_t windowNodes;
+    int64_t windowSearchNs;
+    int windowDecisions;
+    int windowSearches;
+    double nodesPerSecond;
+    double averageSearchMicros;
+    uint64_t budgetOverruns;
+};
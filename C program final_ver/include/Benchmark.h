@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 一项测试的结果，时间均为“每次调用”的纳秒数
+struct BenchmarkResult {
+    std::string name;
+    long long param;        // 规模参数（管道数、粒子数、条目数……），没有时为0
+    int samples;            // 样本数
+    long long iterations;   // 每个样本内调用的次数
+    double meanNs;
+    double stddevNs;
+    double ci95Ns;          // 均值的95%置信区间半宽
+    double minNs;
+    double medianNs;
+};
+
+// 防止编译器把被测代码当作无用代码优化掉
+template <typename T>
+inline void benchmarkKeep(const T& value) {
+    static volatile char sink;
+    sink = *(const volatile char*)&value;
+}
+
+// 微基准测试套件：预热 -> 自动确定每个样本的调用次数 -> 在时间预算内采样 -> 统计
+class BenchmarkSuite {
+public:
+    explicit BenchmarkSuite(double secondsPerBenchmark = 1.0);
+
+    // body 会在一个样本内被连续调用多次；
+    // 给了 setup 时，每个样本开始前先调用一次 setup（不计时），
+    // 此时每个样本内的调用次数固定为 itersPerSample（用于会改变状态的测试）
+    void run(const std::string& name, long long param, const std::function<void()>& body,
+        const std::function<void()>& setup = nullptr, long long itersPerSample = 1);
+
+    const std::vector<BenchmarkResult>& getResults() const { return results; }
+    bool writeJson(const std::string& path) const;
+
+private:
+    static int64_t nowNs();
+
+    double secondsPerBenchmark;
+    std::vector<BenchmarkResult> results;
+};
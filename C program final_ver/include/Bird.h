@@ -54,6 +54,9 @@ public:
     // 增加连击：当小鸟通过管道时调用
     void addCombo();
 
+    // 恢复到倒带缓冲里保存的状态（小鸟复活，旋转角度按速度重新计算）
+    void restore(float savedY, float savedVelocity, float savedComboTime, int savedComboCount, int savedMultiplier);
+
     // 获取和设置属性的方法（访问器和修改器）
     float getX() const { return x; }                 // 获取X坐标
     float getY() const { return y; }                 // 获取Y坐标
@@ -61,6 +64,8 @@ public:
     bool isDead() const { return !alive; }           // 检查是否死亡
     int getScoreMultiplier() const { return scoreMultiplier; } // 获取分数倍数
     int getComboCount() const { return comboCount; } // 获取连击次数
+    float getVelocity() const { return velocity; }   // 获取垂直速度
+    float getComboTime() const { return comboTime; } // 获取连击剩余时间
 
     // 设置重力：调整小鸟下落的速度
     void setGravity(float g) { gravity = g; }
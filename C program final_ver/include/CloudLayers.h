@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <graphics.h>
+#include <cstdint>
+
+// 云朵的视差滚动：云朵分在 CLOUD_LAYER_COUNT 层里，远的层云小、淡、移动慢。
+// 启动时先按几种大小预先画好带 alpha 的云朵图（四个圆的并集，边缘抗锯齿），
+// 再把每层的全部云朵按各自的透明度合成到一张"层条"上：宽度为一屏再加一个周期，
+// 图案每 CLOUD_LAYER_PERIOD 像素重复一次。每帧每层只做一次带 alpha 的贴图（RenderList::blendImage），
+// 绘制开销与云朵数量无关。所有层共用一个滚动量，各层按自己的速度换算出截取位置。
+// 像素为预乘 alpha 的 ARGB，alpha 放在 IMAGE 缓冲区的最高字节（EasyX 的 putimage 不使用这个字节）。
+#define CLOUD_LAYER_COUNT 3
+#define CLOUD_SPRITE_SIZES 4
+#define CLOUD_LAYER_PERIOD 1200         // 每层图案的重复周期（像素，比一屏宽，减少重复感）
+#define CLOUD_BAND_HEIGHT 260           // 云朵所在的带状区域高度（云朵中心在 0~200 之间）
+#define CLOUD_COUNT 8                   // 一屏内的平均云朵数
+
+class CloudLayers {
+public:
+    CloudLayers();
+
+    // 重新放置云朵并合成各层；count 为一屏内的平均云朵数，seed 相同时结果相同
+    void build(int count, uint32_t seed);
+
+    // 推进滚动量（不再逐朵移动，也不调用 rand()）
+    void update(float deltaTime);
+
+    // 由远到近每层一次贴图
+    void draw() const;
+
+    int getCloudCount() const { return cloudCount; }
+
+private:
+    void buildSprites();
+    // 把云朵图按 opacity（0~1）合成到层条的 (x, y)，超出层条的部分裁掉
+    void composite(IMAGE& layer, const IMAGE& sprite, int x, int y, float opacity);
+
+    IMAGE sprites[CLOUD_SPRITE_SIZES];
+    int spriteRadius[CLOUD_SPRITE_SIZES];   // 云朵主圆的半径（原来的 size）
+    IMAGE layers[CLOUD_LAYER_COUNT];
+    float scroll;                           // 以"每帧1像素"为单位的滚动量
+    int cloudCount;
+};
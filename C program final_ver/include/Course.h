@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <windows.h>
+#include <cstdint>
+
+// 比赛赛道文件：固定的管道序列，所有选手面对完全相同的管道
+// 格式：文件头 + 每根管道8字节的记录，按生成帧号递增排列
+#pragma pack(push, 1)
+struct CourseHeader {
+    char magic[4];          // "FBCS"
+    uint32_t version;
+    uint64_t pipeCount;
+    uint32_t seed;          // 生成时使用的种子（仅作记录）
+    uint32_t reserved;
+};
+
+struct CoursePipe {
+    uint32_t spawnTick;     // 开局后第几帧生成（60帧/秒）
+    uint16_t gapY;          // 间隙中心的Y坐标
+    uint8_t flags;          // COURSE_PIPE_COIN 等
+    uint8_t colorType;      // 0~3：绿、蓝、紫、红
+};
+#pragma pack(pop)
+
+#define COURSE_VERSION 1
+#define COURSE_PIPE_COIN 0x01
+
+// 赛道读取器：把整个文件映射进内存，按下标直接访问，不做拷贝
+class CourseFile {
+public:
+    CourseFile();
+    ~CourseFile();
+
+    CourseFile(const CourseFile&) = delete;
+    void operator=(const CourseFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+    uint64_t getPipeCount() const { return header ? header->pipeCount : 0; }
+    const CoursePipe& getPipe(uint64_t index) const { return pipes[index]; }
+
+    // 生成赛道文件：规则与随机生成的管道一致（间隙位置、30%硬币、4种颜色，
+    // 生成间隔按“每5根管道升一级”计算），使用独立的随机数发生器，同一种子结果完全相同
+    static bool generate(const char* path, uint64_t pipeCount, uint32_t seed);
+
+private:
+    HANDLE file;
+    HANDLE mapping;
+    const char* base;
+    const CourseHeader* header;
+    const CoursePipe* pipes;
+};
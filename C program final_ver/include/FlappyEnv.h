@@ -0,0 +1,72 @@
+﻿/*
+ * FlappyEnv.h - 强化学习训练用的 C 接口（FlappyEnv.dll）
+ *
+ * 一个 FlappyEnv 句柄包含 num_envs 个相互独立的游戏环境，规则与游戏完全一致（见 Simulation.h）。
+ * 每次调用处理整批环境，跨 DLL 边界的开销被整批分摊；
+ * 观测、奖励、结束标志都直接写进调用方提供的数组，不做任何拷贝或分配。
+ *
+ * Python 示例（ctypes + numpy）：
+ *   obs = np.zeros((n, FLAPPY_ENV_OBS_SIZE), np.float32)
+ *   env = lib.env_create(seed, difficulty, n)
+ *   lib.env_reset(env, obs.ctypes.data)
+ *   lib.env_step(env, actions.ctypes.data, obs.ctypes.data, rewards.ctypes.data, dones.ctypes.data)
+ */
+#pragma once
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifdef FLAPPY_ENV_EXPORTS
+#define FLAPPY_ENV_API __declspec(dllexport)
+#else
+#define FLAPPY_ENV_API __declspec(dllimport)
+#endif
+#else
+#define FLAPPY_ENV_API __attribute__((visibility("default")))
+#endif
+
+/* 每个环境的观测：
+ *   [0] 小鸟 Y        [1] 小鸟垂直速度
+ *   [2] 下一根管道 X   [3] 下一根管道间隙中心 Y
+ *   [4] 再下一根管道 X [5] 再下一根管道间隙中心 Y
+ *   [6] 等级           [7] 游戏速度
+ * 前方没有管道时，X 填屏幕宽度，间隙 Y 填可玩区域中心 */
+#define FLAPPY_ENV_OBS_SIZE 8
+
+/* 奖励：每存活一帧 +0.01，分数每增加1分 +1（通过管道、硬币），死亡 -1 */
+#define FLAPPY_ENV_REWARD_ALIVE 0.01f
+#define FLAPPY_ENV_REWARD_DEATH -1.0f
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FlappyEnv FlappyEnv;
+
+/* 创建 num_envs 个环境；difficulty 0:简单 1:普通 2:困难。失败返回 NULL */
+FLAPPY_ENV_API FlappyEnv* env_create(uint32_t seed, int difficulty, int num_envs);
+FLAPPY_ENV_API void env_destroy(FlappyEnv* env);
+
+FLAPPY_ENV_API int env_num_envs(const FlappyEnv* env);
+FLAPPY_ENV_API int env_obs_size(void);
+
+/* 重置全部环境，obs 为 num_envs * FLAPPY_ENV_OBS_SIZE 个 float */
+FLAPPY_ENV_API void env_reset(FlappyEnv* env, float* obs);
+
+/* 所有环境各推进一帧。
+ *   actions: num_envs 个字节，非0表示跳跃
+ *   obs:     输出，num_envs * FLAPPY_ENV_OBS_SIZE 个 float
+ *   rewards: 输出，num_envs 个 float
+ *   dones:   输出，num_envs 个字节；为1时该环境本帧结束并已自动重置，obs 是新一局的初始观测，
+ *            结束那一局的分数和帧数用 env_get_last_episode_score / env_get_last_episode_length 读取 */
+FLAPPY_ENV_API void env_step(FlappyEnv* env, const uint8_t* actions, float* obs, float* rewards, uint8_t* dones);
+
+/* 第 index 个环境当前一局的分数（用于统计）；dones 为1之后这里已经是新一局的 0 */
+FLAPPY_ENV_API int env_get_score(const FlappyEnv* env, int index);
+
+/* 第 index 个环境最近结束的一局的分数和长度（帧数）；还没有结束过的局时返回 0 */
+FLAPPY_ENV_API int env_get_last_episode_score(const FlappyEnv* env, int index);
+FLAPPY_ENV_API int env_get_last_episode_length(const FlappyEnv* env, int index);
+
+#ifdef __cplusplus
+}
+#endif
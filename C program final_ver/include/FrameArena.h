@@ -0,0 +1,79 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 每帧的线性分配器：主循环每帧开头 reset() 一次，
+// 帧内的临时数据（格式化文字、多边形顶点……）只需移动一下指针，整帧一起释放
+// 内存块在第一次不够用时分配，之后一直复用，稳定运行时不再访问堆
+// 只在游戏主线程使用
+class FrameArena {
+public:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    static FrameArena& getInstance() {
+        static FrameArena instance;
+        return instance;
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    void operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // 格式化到帧内存里，返回的字符串在本帧结束前有效
+    const wchar_t* format(const wchar_t* fmt, ...);
+    // 多字节字符串转宽字符（玩家名称等）
+    const wchar_t* widen(const char* text);
+
+    // 释放本帧的全部分配（O(1)，内存块保留）
+    void reset();
+
+    size_t getUsedBytes() const { return usedBeforeCurrent + offset; }   // 本帧已用
+    size_t getHighWaterBytes() const { return highWater; }             // 历史最高单帧用量
+    size_t getCapacityBytes() const { return capacity; }
+
+private:
+    FrameArena();
+    ~FrameArena();
+
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;              // 当前使用的块
+    size_t offset;               // 当前块内的偏移
+    size_t usedBeforeCurrent;    // 之前各块已用的字节数
+    size_t capacity;
+    size_t highWater;
+};
+
+// 从帧内存分配的 STL 分配器；deallocate 什么都不做，内存在帧末统一回收
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t count) { return FrameArena::getInstance().allocArray<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+// 帧内临时容器：必须在当前帧内用完，不能跨帧保存
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
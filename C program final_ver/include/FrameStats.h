@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+// 一帧的计时样本（毫秒），时间戳为游戏启动后的秒数
+struct FrameSample {
+    double timeSec;
+    float frameMs;     // 两次循环开始之间的间隔（包含休眠）
+    float updateMs;    // 输入 + 固定步长更新
+    float renderMs;    // render()，包含 FlushBatchDraw
+};
+
+// 一组样本的统计结果
+struct FrameTimeSummary {
+    float p50;
+    float p95;
+    float p99;
+    float max;
+    float avg;
+};
+
+// 帧时间记录器：环形保存最近的样本，按最近 windowSeconds 秒计算分位数
+// 不依赖 EasyX，绘制由 Game::drawFPS 完成
+class FrameStats {
+public:
+    static const int CAPACITY = 4096;   // 60FPS 下约一分钟的原始样本
+
+    explicit FrameStats(double windowSeconds);
+
+    // 每帧调用一次；统计结果每隔半秒重新计算，避免每帧排序
+    void addSample(double timeSec, float frameMs, float updateMs, float renderMs);
+
+    const FrameTimeSummary& getFrameSummary() const { return frameSummary; }
+    const FrameTimeSummary& getUpdateSummary() const { return updateSummary; }
+    const FrameTimeSummary& getRenderSummary() const { return renderSummary; }
+    float getAverageFps() const { return frameSummary.avg > 0 ? 1000.0f / frameSummary.avg : 0.0f; }
+    double getWindowSeconds() const { return windowSeconds; }
+
+    // 最近的样本：ago = 0 是最新一帧
+    int getSampleCount() const { return count < CAPACITY ? (int)count : CAPACITY; }
+    const FrameSample& getRecent(int ago) const { return samples[(count - 1 - ago) % CAPACITY]; }
+
+    // 把环形缓冲区里的全部原始样本写成 CSV
+    bool dumpCsv(const std::string& path) const;
+
+private:
+    void refresh();
+    FrameTimeSummary summarize(float FrameSample::* field, int windowCount);
+
+    double windowSeconds;
+    double lastRefreshSec;
+
+    FrameSample samples[CAPACITY];
+    uint64_t count;
+    float scratch[CAPACITY];   // 排序用的临时数组，预先分配
+
+    FrameTimeSummary frameSummary;
+    FrameTimeSummary updateSummary;
+    FrameTimeSummary renderSummary;
+};
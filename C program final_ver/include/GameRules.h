@@ -0,0 +1,43 @@
+﻿// GameRules.h - 与图形库无关的游戏规则常量
+// constants.h 包含本文件；模拟核心、强化学习接口等不依赖 EasyX 的代码直接包含本文件
+#pragma once
+
+#ifndef GAME_RULES_H
+#define GAME_RULES_H
+
+// 屏幕尺寸
+#define SCREEN_WIDTH 800
+#define SCREEN_HEIGHT 600
+#define GROUND_HEIGHT 60
+
+// 固定步长更新频率
+#define FPS 60.0
+
+#include <cstdint>
+
+// xorshift32：所有不使用 CRT rand() 的随机数（管道、赛道、云朵、测试数据）都用这一个，状态不能为0
+inline uint32_t nextRandom(uint32_t& rng) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// 一根随机管道：间隙中心 150 ~ 439，30% 带硬币，4种颜色
+struct PipeRoll {
+    int gapY;
+    bool hasCoin;
+    int colorType;              // 0~3：绿、蓝、紫、红
+};
+
+// 游戏（Pipe）、模拟（Simulation，回放校验也用它）和赛道生成器都从这里取管道参数，
+// 抽取顺序（间隙 -> 硬币 -> 颜色）只在这里定义，回放才能逐位复现游戏里的管道
+inline PipeRoll rollPipe(uint32_t& rng) {
+    PipeRoll roll;
+    roll.gapY = 150 + (int)(nextRandom(rng) % (SCREEN_HEIGHT - GROUND_HEIGHT - 250));
+    roll.hasCoin = (nextRandom(rng) % 100) < 30;
+    roll.colorType = (int)(nextRandom(rng) % 4);
+    return roll;
+}
+
+#endif // GAME_RULES_H
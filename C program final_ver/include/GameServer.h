@@ -0,0 +1,95 @@
+﻿#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "NetSocket.h"
+#include "ServerProtocol.h"
+#include "Simulation.h"
+
+// 权威联机服务器：许多相互独立的对战房间，每个玩家一局 Simulation（规则与 Game::updateGameplay 一致），
+// 同一房间的玩家使用同一个种子，面对同样的管道。
+// 每个工作线程有自己的 UDP 端口和自己的房间表，房间固定在一个线程上，处理时不需要加锁。
+// 线程在"等待数据报"和"到时间就推进一帧"之间循环；一帧之内收到的输入先记下，到帧时一起应用。
+// 同时转发观战流：机台按编号固定在一个线程上，收到的消息原样发给订阅这台机台的所有观众。
+class GameServer {
+public:
+    GameServer(uint16_t basePort, int workerCount);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    void operator=(const GameServer&) = delete;
+
+    bool start();
+    void stop();
+
+    // 运行 seconds 秒（0 表示一直运行），每隔几秒在控制台打印统计
+    void run(double seconds);
+
+    int getWorkerCount() const { return (int)workers.size(); }
+    void getStats(StatsReplyPacket& out);
+
+private:
+    struct Session {
+        uint32_t clientId;
+        NetAddress address;
+        SimState state;
+        uint8_t pendingJump;        // 本帧收到的输入（多个输入合并为一次跳跃）
+        uint64_t echoStamp;         // 最近一次已应用输入的 stamp
+        uint64_t pendingStamp;
+        double lastSeen;
+    };
+
+    struct Room {
+        uint32_t id;
+        uint32_t seed;
+        uint32_t round;
+        int playerCount;
+        Session players[ROOM_MAX_PLAYERS];
+    };
+
+    struct Viewer {
+        uint64_t key;               // 地址 + viewerId
+        double lastSeen;
+    };
+
+    // 一台机台的观众；地址单独连续存放，转发时整个数组交给 sendToMany
+    struct Channel {
+        std::vector<NetAddress> addresses;
+        std::vector<Viewer> viewers;
+        std::unordered_map<uint64_t, size_t> viewerIndex;
+        double lastPublish = 0;
+    };
+
+    struct Worker {
+        int index;
+        UdpSocket socket;
+        std::thread thread;
+        std::unordered_map<uint32_t, Room> rooms;
+        int sessionCount;
+        std::unordered_map<uint32_t, Channel> channels;     // 机台编号 → 观众
+        int viewerCount;
+
+        // 统计：每秒把最近一秒的数据整理成 published，供其他线程读取
+        std::vector<float> tickMicros;
+        double busySeconds;
+        double windowStart;
+        uint64_t packetsIn;
+        uint64_t packetsOut;
+        std::mutex statsMutex;
+        WorkerStatsRecord published;
+    };
+
+    void workerLoop(Worker& worker);
+    void handlePacket(Worker& worker, const NetAddress& from, const char* data, int size, double now);
+    void tickRooms(Worker& worker, double now);
+    void startRound(Room& room);
+    void handleSpectate(Worker& worker, const NetAddress& from, const char* data, int size, double now);
+    void expireViewers(Worker& worker, double now);
+    void publishStats(Worker& worker, double now);
+
+    uint16_t basePort;
+    std::vector<Worker*> workers;
+    std::atomic<bool> running;
+};
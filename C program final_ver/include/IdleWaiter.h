@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <Windows.h>
+#include <cstdint>
+
+// 静态界面（主菜单、排行榜、设置、帮助、制作人员）的省电等待：
+// 主循环不再每16毫秒醒来一次，而是阻塞到有键盘输入或下一次动画帧。
+// 输入用 Raw Input 注册到本线程的一个仅消息窗口（RIDEV_INPUTSINK，窗口不在前台也能收到，
+// 与 GetAsyncKeyState 的行为一致），MsgWaitForMultipleObjects 在有新输入或超时时返回。
+// 同时统计每秒唤醒次数和进程的 CPU 占用，供 FPS 面板显示。
+class IdleWaiter {
+public:
+    IdleWaiter();
+    ~IdleWaiter();
+
+    IdleWaiter(const IdleWaiter&) = delete;
+    void operator=(const IdleWaiter&) = delete;
+
+    // 创建消息窗口并注册键盘的 Raw Input；失败时返回 false，调用方退回到 Sleep
+    bool init();
+
+    // 阻塞最多 timeoutMs 毫秒，有新的键盘输入时提前返回 true
+    bool wait(DWORD timeoutMs);
+
+    // 主循环的其他等待（Sleep）也计入唤醒次数
+    void countWakeup() { wakeups++; }
+
+    // 每秒重新计算一次唤醒频率和 CPU 占用（每帧调用，未满一秒时直接返回）
+    void updateStats();
+
+    // CPU 占用：100% = 占满一个核心
+    double getCpuPercent() const { return cpuPercent; }
+    double getWakeupsPerSecond() const { return wakeupsPerSecond; }
+
+private:
+    HWND window;
+    uint64_t wakeups;
+    uint64_t lastWakeups;
+    ULONGLONG lastStatsMs;
+    uint64_t lastCpuTime;       // 进程的内核 + 用户时间（100纳秒）
+    double cpuPercent;
+    double wakeupsPerSecond;
+};
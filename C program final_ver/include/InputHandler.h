@@ -1,6 +1,5 @@
 ﻿#pragma once
 #include <Windows.h>
-#include <map>
 
 class InputHandler {
 public:
@@ -20,11 +19,11 @@ public:
     bool isKeyDown(int vKey) const;
 
 private:
-    InputHandler() = default;
+    InputHandler();
 
-    // 存储当前帧和上一帧的按键状态
-    std::map<int, bool> currentKeys;
-    std::map<int, bool> previousKeys;
+    // 存储当前帧和上一帧的按键状态（按虚拟键码直接索引，每帧不分配内存）
+    bool currentKeys[256];
+    bool previousKeys[256];
 
     // 需要监听的按键列表
     const int keysToMonitor[2] = { VK_SPACE, VK_ESCAPE };
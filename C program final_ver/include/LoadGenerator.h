@@ -0,0 +1,17 @@
+﻿#pragma once
+#include <cstdint>
+
+#define SPECTATE_VIEWERS_PER_SOCKET 64
+
+// 联机服务器的压力测试客户端：在本机（或另一台机器）模拟大量玩家，
+// 每个玩家每帧发一个输入，统计"发出输入 → 收到应用了该输入的状态"的延迟分位数，
+// 最后向服务器查询各工作线程的帧耗时和忙碌比例，估算每个核心能承载的会话数。
+class LoadGenerator {
+public:
+    static bool run(const char* host, uint16_t port, int sessions, double seconds, int threads);
+
+    // 观战转发测试：cabinets 台模拟机台（Simulation + 简单的自动驾驶）每帧发送观战流，
+    // viewers 个观众平均订阅各机台（每个套接字模拟 SPECTATE_VIEWERS_PER_SOCKET 个观众），
+    // 统计每帧的字节数、送达率、转发延迟，并校验观众解码出的画面与机台一致（不一致时返回 false）
+    static bool runSpectators(const char* host, uint16_t port, int viewers, double seconds, int cabinets);
+};
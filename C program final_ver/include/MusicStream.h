@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioMixer.h"
+
+// 流式音乐音源：后台线程先把整个文件读进内存，再边解码边写入环形缓冲区，
+// 混音线程只从环形缓冲区拷贝数据，不会碰磁盘或解码器
+class MusicStream : public MixStreamSource {
+public:
+    static const size_t DEFAULT_BUFFER_FRAMES = AudioMixer::SAMPLE_RATE;  // 默认预读1秒
+    static const size_t DECODE_FRAMES = 4096;   // 解码线程每次解码的源帧数
+
+    MusicStream();
+    ~MusicStream();
+
+    MusicStream(const MusicStream&) = delete;
+    void operator=(const MusicStream&) = delete;
+
+    // 开始预读：只启动解码线程就立即返回，读文件和打开解码器都在后台完成
+    // bufferFrames 为环形缓冲区容量（输出帧），用于调节抗卡顿能力
+    bool open(const std::string& filepath, bool loop, size_t bufferFrames = DEFAULT_BUFFER_FRAMES);
+    void close();
+
+    // 混音线程调用：拷贝已解码数据，数据不够时记为一次欠载
+    size_t read(float* out, size_t frames) override;
+
+    // --- 统计信息 ---
+    uint64_t getUnderrunCount() const { return underrunCount.load(std::memory_order_relaxed); }
+    uint64_t getUnderrunFrames() const { return underrunFrames.load(std::memory_order_relaxed); }
+    size_t getBufferedFrames() const;
+    size_t getBufferCapacity() const { return capacity; }
+    bool isFinished() const { return finished.load(std::memory_order_acquire); }
+    bool hasError() const { return failed.load(std::memory_order_acquire); }
+
+private:
+    void decodeThreadMain();
+    size_t writeRing(const float* data, size_t frames);
+    size_t convertBlock(const int16_t* samples, size_t frames);
+
+    std::string path;
+    bool looping;
+
+    // 环形缓冲区：解码线程写 writePos，混音线程写 readPos，都是单调递增的帧计数
+    std::vector<float> ring;
+    size_t capacity;
+    std::atomic<uint64_t> writePos;
+    std::atomic<uint64_t> readPos;
+    std::atomic<unsigned int> spaceSignal;   // 混音线程每取走一次数据加一，解码线程在此等待空间
+
+    // 解码线程私有数据
+    std::vector<char> fileData;         // 预读进内存的整个文件
+    sf::InputSoundFile decoder;
+    unsigned sourceChannels;
+    double resampleStep;                // 源采样率 / 输出采样率
+    double resamplePos;
+    float lastFrame[AudioMixer::CHANNELS];
+    std::vector<int16_t> decodeBuffer;
+    std::vector<float> convertBuffer;
+
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+    std::atomic<bool> failed;
+    std::atomic<uint64_t> underrunCount;
+    std::atomic<uint64_t> underrunFrames;
+    std::thread decodeThread;
+};
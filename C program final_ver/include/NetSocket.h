@@ -0,0 +1,55 @@
+﻿#pragma once
+#include <cstdint>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NetHandle;
+#else
+#include <netinet/in.h>
+typedef int NetHandle;
+#endif
+
+// IPv4 地址 + 端口
+struct NetAddress {
+    sockaddr_in addr;
+
+    bool operator==(const NetAddress& other) const {
+        return addr.sin_addr.s_addr == other.addr.sin_addr.s_addr && addr.sin_port == other.addr.sin_port;
+    }
+
+    // host 为数字地址或主机名
+    static bool resolve(const char* host, uint16_t port, NetAddress& out);
+};
+
+// 非阻塞 UDP 套接字（Winsock / BSD sockets 的薄封装）
+class UdpSocket {
+public:
+    UdpSocket();
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    void operator=(const UdpSocket&) = delete;
+
+    // 进程启动/退出时各调用一次（Windows 需要 WSAStartup）
+    static bool startup();
+    static void cleanup();
+
+    // 绑定到本机端口，port 为 0 时由系统分配
+    bool open(uint16_t port);
+    void close();
+    bool isOpen() const;
+    uint16_t getLocalPort() const;
+
+    bool sendTo(const NetAddress& to, const void* data, int size);
+    // 同一个数据报发给 count 个地址（观战转发）；Linux 上用 sendmmsg 一次系统调用发一批，
+    // 所有消息指向同一块数据，不做拷贝。返回成功发出的个数
+    int sendToMany(const NetAddress* to, int count, const void* data, int size);
+    // 读取一个数据报；没有数据时返回 -1
+    int receiveFrom(NetAddress& from, void* buffer, int capacity);
+    // 等待可读，最多 timeoutMs 毫秒；有数据返回 true
+    bool wait(int timeoutMs);
+
+private:
+    NetHandle handle;
+};
@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <graphics.h>
+#include <cstdint>
+#include <vector>
+
+class Particle;
+
+// 粒子的批量绘制：先剔除屏幕外的粒子，再按（类型、线宽、褪色后的颜色）排序分桶，
+// 每个桶只设置一次颜色和线型，而不是每个粒子都调用 setfillcolor/setlinecolor。
+// 褪色程度量化为 PARTICLE_FADE_LEVELS 级，同一次爆发的粒子大多落进同一个桶。
+// 星星使用预先算好的顶点表（每种大小10个顶点偏移），绘制时只做加法，不再计算 sin/cos。
+#define PARTICLE_FADE_LEVELS 32
+#define PARTICLE_MAX_SIZE 6         // Particle 的大小为 2~6
+
+class ParticleRenderer {
+public:
+    ParticleRenderer();
+
+    // 绘制全部粒子（顺序按桶，不再按生成顺序），返回剔除后实际绘制的数量
+    int draw(const std::vector<Particle>& particles);
+
+    // 最近一次绘制用到的桶数（= 颜色/线型的切换次数）
+    int getBucketCount() const { return buckets; }
+
+private:
+    std::vector<uint64_t> keys;                     // (桶 << 32) | 粒子下标，预留 MAX_PARTICLES
+    POINT starOffsets[PARTICLE_MAX_SIZE + 1][10];   // 各种大小的星星顶点相对中心的偏移
+    int buckets;
+};
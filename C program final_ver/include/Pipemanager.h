@@ -7,6 +7,8 @@
 #include <graphics.h>
 #include <vector>
 #include "constants.h"
+#include "Course.h"
+#include "RewindBuffer.h"
 
 // 前向声明（避免循环包含）
 class Bird;
@@ -27,8 +29,21 @@ private:
     bool coinCollected;         // 硬币是否已被收集
 
 public:
-    // 构造函数：在指定位置创建管道
-    Pipe(float startX, int pipeID);
+    // 构造函数：在指定位置创建随机管道。随机数来自 PipeManager 的 xorshift32 状态 rng，
+    // 规则和取数顺序与 Simulation::spawnPipe 相同，同一个种子生成同样的管道（回放校验依赖这一点）
+    Pipe(float startX, int pipeID, uint32_t& rng);
+
+    // 构造函数：按赛道文件里的记录创建管道（不调用随机数）
+    Pipe(float startX, int pipeID, const CoursePipe& spec);
+
+    // 构造函数：按倒带缓冲里保存的状态恢复管道
+    explicit Pipe(const RewindPipe& saved);
+
+    // 保存到倒带缓冲
+    void save(RewindPipe& out) const;
+
+    // 颜色编号（0~3）对应的管道颜色
+    static COLORREF colorFromType(int colorType);
 
     // 更新方法：根据速度移动管道
     void update(float speed);
@@ -69,6 +84,12 @@ class PipeManager {
 private:
     std::vector<Pipe> pipes;    // 存储所有管道的向量
 
+    // 比赛赛道：设置后 addPipe 按顺序读取赛道记录，不再随机生成
+    const CourseFile* course;
+    uint64_t courseCursor;      // 下一根要生成的管道在赛道中的下标
+
+    uint32_t rng;               // 随机管道的 xorshift32 状态，每局由 setSeed 设置
+
 public:
     // 构造函数
     PipeManager();
@@ -96,11 +117,33 @@ public:
     // 添加新管道
     void addPipe(float startX, int pipeID);
 
-    // 清空所有管道
-    void clearPipes() { pipes.clear(); }
+    // 清空所有管道（赛道从头开始）
+    void clearPipes() { pipes.clear(); courseCursor = 0; }
+
+    // 倒带：用保存的管道替换当前的全部管道，赛道读取位置和随机数状态一并恢复，
+    // 之后生成的管道与原来那一局相同
+    void restorePipes(const RewindPipe* saved, int count, uint64_t cursor, uint32_t rngState);
+    uint64_t getCourseCursor() const { return courseCursor; }
+    uint32_t getRngState() const { return rng; }
+
+    // 设置随机管道的种子（与 Simulation::reset 的种子含义相同）
+    void setSeed(uint32_t seed) { rng = seed ? seed : 0x9E3779B9u; }
+
+    // 设置比赛赛道（nullptr 表示恢复随机管道）
+    void setCourse(const CourseFile* courseFile) { course = courseFile; courseCursor = 0; }
+    bool hasCourse() const { return course != nullptr; }
+    // 赛道里下一根管道的生成帧号；赛道用完时返回 UINT32_MAX
+    uint32_t getNextCourseSpawnTick() const {
+        return courseCursor < course->getPipeCount() ? course->getPipe(courseCursor).spawnTick : UINT32_MAX;
+    }
 
     // 获取管道数量
     size_t getPipeCount() const { return pipes.size(); }
+    // 按下标获取管道（按生成顺序，X坐标递增）
+    const Pipe& getPipe(size_t index) const { return pipes[index]; }
+
+    // 获取小鸟前方（尚未完全飞过）的第一根管道，没有时返回 nullptr
+    const Pipe* getNextPipe(float birdX) const;
 };
 
 #endif // PIPEMANAGER_H
\ No newline at end of file
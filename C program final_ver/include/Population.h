@@ -0,0 +1,91 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+
+// 种群模式（神经进化训练用）：N 只小鸟共享同一个管道场。
+// 所有小鸟的 X 坐标相同，经过同一根管道的时刻也相同，所以管道、等级、速度、
+// 连击倍数都只需要算一次（放在 world 里，规则由 Simulation 提供）；
+// 每只小鸟只有自己的 Y、速度和硬币。
+// 小鸟按"结构数组"存放（Y、速度、编号各一个数组），积分和碰撞用 SSE2 一次处理4只，
+// 死亡的小鸟每帧被压缩出去，后面的帧只处理活着的。
+// 和单独用 Simulation::step 跑每只小鸟的结果完全一致。
+
+class Population {
+public:
+    Population();
+    ~Population();
+
+    Population(const Population&) = delete;
+    void operator=(const Population&) = delete;
+
+    // 开始新的一代：birdCount 只小鸟，共享由 seed 生成的管道场
+    void reset(int birdCount, uint32_t seed, int difficulty);
+
+    // 工作线程数（含调用线程），1 表示单线程；小鸟少时自动只用一个线程
+    void setThreadCount(int threads);
+    int getThreadCount() const { return (int)workers.size() + 1; }
+
+    // 推进一帧。jumps 按存活槽位排列（第 i 个对应 getBirdId(i)），非0表示跳跃。
+    // 返回本帧之后还活着的小鸟数
+    int step(const uint8_t* jumps);
+
+    // 存活的小鸟（槽位 0 ~ getAliveCount()-1，每帧压缩后顺序会变化）
+    int getAliveCount() const { return aliveCount; }
+    int getBirdCount() const { return birdCount; }
+    int getBirdId(int slot) const { return ids[slot]; }
+    float getBirdY(int slot) const { return birdY[slot]; }
+    float getBirdVelocity(int slot) const { return birdVelocity[slot]; }
+
+    // 共享的管道场和本局进度（world.birdX 是所有小鸟共同的X坐标）
+    const SimState& getWorld() const { return world; }
+
+    // 按小鸟编号查询结果：死亡帧号（活着时为0）和得分（通过管道得分 + 硬币得分）
+    uint32_t getDeathTick(int id) const { return deathTick[id]; }
+    int getScore(int id) const;
+    int getCoins(int id) const { return coins[id]; }
+
+    // 种群模式的吞吐量测试：birdCount 只小鸟跑 ticks 帧，打印每秒处理的"小鸟·帧"
+    static bool benchmark(int birdCount, int ticks, int threads);
+
+private:
+    // 一段存活槽位的积分、碰撞和硬币检测（SIMD 内核）
+    void updateBirds(int begin, int end, const uint8_t* jumps);
+    void compact();
+
+    void workerLoop(int index);
+    void runParallel(const uint8_t* jumps);
+    void stopWorkers();
+
+    SimState world;
+    int birdCount;
+    int aliveCount;
+
+    // 存活小鸟（按槽位）
+    std::vector<float> birdY;
+    std::vector<float> birdVelocity;
+    std::vector<int32_t> ids;
+    std::vector<int32_t> lastCoinPipe;      // 最近收集硬币的管道编号，防止同一枚硬币重复收集
+    std::vector<uint8_t> dead;              // 本帧死亡标记
+
+    // 每只小鸟的结果（按编号）
+    std::vector<uint32_t> deathTick;
+    std::vector<int32_t> deathScore;        // 死亡时 world.score（通过管道的得分）
+    std::vector<int32_t> coins;
+
+    // 本帧与小鸟X范围重叠的管道，由 step() 准备好供内核使用
+    SimColumn column;
+
+    // 多线程：每帧把存活槽位平均分给各线程，各线程只写自己那一段
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;
+    int pendingWorkers;
+    bool stopping;
+    const uint8_t* currentJumps;
+};
@@ -0,0 +1,107 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 是否编译进性能分析代码（发布给玩家的版本也保留，关闭时每个区段只多一次原子读）
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 1
+#endif
+
+// 一条计时记录：name 必须是字符串常量（只保存指针）
+struct ProfileEvent {
+    const char* name;
+    int64_t startNs;
+    int64_t endNs;
+};
+
+// 每个线程自己的环形缓冲区，只有所属线程写入，导出时由主线程读取
+struct ProfileThreadBuffer {
+    static const uint32_t CAPACITY = 1 << 16;
+
+    uint32_t threadId;
+    std::string threadName;
+    std::atomic<uint64_t> writeIndex;
+    ProfileEvent events[CAPACITY];
+};
+
+// 分段计时器：按 F9 采集接下来的 N 帧，导出成 Chrome trace / Perfetto 可以打开的 JSON
+class Profiler {
+public:
+    static Profiler& getInstance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    Profiler(const Profiler&) = delete;
+    void operator=(const Profiler&) = delete;
+
+    // 关闭时热路径只检查这个标志
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 记录一段计时（由 ProfileScope 调用）
+    void record(const char* name, int64_t startNs, int64_t endNs);
+
+    // 给当前线程起名，显示在 trace 查看器的线程列表里；name 必须是字符串常量。
+    // 只记下名字，不分配缓冲区，线程第一次记录时才注册
+    void setThreadName(const char* name);
+
+    // 开始采集接下来的 frames 帧；正在采集时忽略
+    void beginCapture(int frames);
+    // 主循环每帧末尾调用一次：记录帧区段，采集满了就写出文件（写出成功返回 true）
+    bool endFrame();
+
+    bool isCapturing() const { return framesRemaining > 0; }
+    const std::string& getLastTracePath() const { return lastTracePath; }
+
+private:
+    Profiler();
+
+    ProfileThreadBuffer* getThreadBuffer();
+    bool writeTrace(const std::string& path);
+
+    static std::atomic<bool> enabled;
+
+    std::mutex registryMutex;   // 只在线程第一次记录时加锁
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers;
+    std::atomic<uint32_t> nextThreadId;
+
+    int framesRemaining;
+    int64_t captureStartNs;
+    int64_t frameStartNs;
+    std::string lastTracePath;
+};
+
+// 作用域计时：构造时记开始时间，析构时写入当前线程的缓冲区
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* zoneName)
+        : name(zoneName), startNs(Profiler::isEnabled() ? Profiler::nowNs() : 0) {
+    }
+    ~ProfileScope() {
+        if (startNs != 0 && Profiler::isEnabled()) {
+            Profiler::getInstance().record(name, startNs, Profiler::nowNs());
+        }
+    }
+
+private:
+    const char* name;
+    int64_t startNs;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ENABLE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,166 @@
+﻿#pragma once
+#include <graphics.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 每帧的绘制命令列表。绘制分两步：
+// 1. 录制：各对象的 draw() 调用 RenderList 的方法（与 EasyX 同名的 camelCase 版本），
+//    颜色、线型、字体只记在"当前状态"里，每个图元连同它用到的那部分状态记成一条命令；
+// 2. 执行：按录制顺序扫描，命令可以提前到之前某个状态相同的批次里，
+//    条件是它和中间的批次没有重叠（按包围盒判断），所以互相遮挡的图形前后顺序不变。
+//    每个批次只切换一次状态，只设置实际变化的项。
+// 命令、状态、文字和顶点都是平坦的数组，可以逐字节比较：与上一帧完全相同的帧不必重画（见 isSameAsPrevious），
+// serialize() 输出与平台无关的字节流，两次渲染的结果可以直接对比（--render-dump）。
+// 只在游戏主线程使用。
+
+#define RENDER_LIST_VERSION 2
+#define RENDER_REORDER_WINDOW 64        // 命令最多向前合并到第几个批次，限制最坏情况的扫描量
+#define RENDER_ANY_COLOR 0xFFFFFFFFu    // 状态里"不关心"的颜色（COLORREF 最高字节为0，不会与真实颜色冲突）
+#define RENDER_ANY -1                   // 状态里"不关心"的其他项
+
+enum RenderOp : uint8_t {
+    RENDER_CLEAR = 1,           // cleardevice，全屏，之前的命令都不能移到它后面
+    RENDER_SOLID_CIRCLE,        // a, b = 圆心，c = 半径
+    RENDER_CIRCLE,
+    RENDER_SOLID_RECTANGLE,     // a, b, c, d = 左上右下
+    RENDER_FILL_RECTANGLE,
+    RENDER_RECTANGLE,
+    RENDER_LINE,                // a, b -> c, d
+    RENDER_SOLID_POLYGON,       // c = 顶点数组的偏移，d = 顶点数
+    RENDER_TEXT,                // a, b = 左上角，c = 文字的偏移，d = 字符数
+    RENDER_IMAGE,               // a, b = 左上角，c = 图片编号，d = 源区域左上角（x | y << 16），宽高为包围盒的宽高
+    RENDER_BLEND_IMAGE          // 同上，按图片缓冲区最高字节的预乘 alpha 混合
+};
+
+// 一条命令用到的绘制状态；与这条命令无关的项为 RENDER_ANY / RENDER_ANY_COLOR
+struct RenderState {
+    uint32_t fillColor;
+    uint32_t lineColor;
+    uint32_t textColor;
+    int16_t lineStyle;
+    int16_t lineWidth;
+    int16_t fontHeight;
+    int16_t fontWidth;
+    int16_t fontFace;           // 字体名称表的下标
+    int16_t bkMode;
+
+    bool operator==(const RenderState& other) const;
+    bool operator!=(const RenderState& other) const { return !(*this == other); }
+};
+
+struct RenderCommand {
+    uint8_t op;                 // RenderOp
+    uint8_t reserved;
+    uint16_t state;             // 本帧状态表的下标
+    int16_t left, top, right, bottom;   // 包围盒（含线宽），判断能否调换顺序
+    int32_t a, b, c, d;
+};
+
+class RenderList {
+public:
+    static RenderList& getInstance() {
+        static RenderList instance;
+        return instance;
+    }
+
+    RenderList(const RenderList&) = delete;
+    void operator=(const RenderList&) = delete;
+
+    // 开始录制新的一帧（上一帧保留下来，用于比较）
+    void begin();
+
+    // --- 状态：只修改录制中的当前状态 ---
+    void setFillColor(COLORREF color) { current.fillColor = color; }
+    void setLineColor(COLORREF color) { current.lineColor = color; }
+    void setLineStyle(int style, int width = 1) { current.lineStyle = (int16_t)style; current.lineWidth = (int16_t)width; }
+    void setTextStyle(int height, int width, const wchar_t* face);     // 字体名称在第一次使用时登记
+    void setTextColor(COLORREF color) { current.textColor = color; }
+    void setBkMode(int mode) { current.bkMode = (int16_t)mode; }
+
+    // --- 图元 ---
+    void clear();
+    void solidCircle(int x, int y, int radius);
+    void circle(int x, int y, int radius);
+    void solidRectangle(int left, int top, int right, int bottom);
+    void fillRectangle(int left, int top, int right, int bottom);
+    void rectangle(int left, int top, int right, int bottom);
+    void line(int x1, int y1, int x2, int y2);
+    void solidPolygon(const POINT* points, int count);     // 顶点复制进列表
+    void outText(int x, int y, const wchar_t* text);        // 文字复制进列表
+    void putImage(int x, int y, const IMAGE* image);        // 只记录指针，图片在执行前不能改变
+    void putImage(int x, int y, int width, int height, const IMAGE* image, int srcX, int srcY);    // 图片的一部分
+    void blendImage(int x, int y, int width, int height, const IMAGE* image, int srcX, int srcY);  // 预乘 alpha 的 ARGB 图片
+
+    // 用当前录制的字体测量文字（结果有缓存，命中时不切换设备上的字体）
+    int textWidth(const wchar_t* text);
+    int textHeight(const wchar_t* text);
+
+    // 本帧的命令、状态、文字、顶点、图片与上一帧完全相同（屏幕上已经是这个画面）
+    bool isSameAsPrevious() const;
+
+    // 合并批次后执行本帧的命令
+    void execute();
+
+    // 本帧的与平台无关的字节流：文件头 + 字体名称 + 状态表 + 命令 + 顶点 + 文字（UTF-16）
+    void serialize(std::vector<uint8_t>& out) const;
+
+    // 统计（最近一次 execute）
+    size_t getCommandCount() const { return commands.size(); }
+    int getBatchCount() const { return batchCount; }
+    int getStateChanges() const { return stateChanges; }
+    int getUnsortedStateChanges() const { return unsortedStateChanges; }   // 按录制顺序执行时的切换次数
+    uint64_t getSkippedFrames() const { return skippedFrames; }
+    void countSkippedFrame() { skippedFrames++; }
+
+private:
+    RenderList();
+
+    struct TextMetrics {
+        uint64_t key;           // 字体 + 文字的哈希，0 表示空
+        int width, height;
+    };
+
+    void add(RenderOp op, uint32_t stateMask, int left, int top, int right, int bottom,
+        int32_t a, int32_t b, int32_t c, int32_t d);
+    uint16_t internState(uint32_t stateMask);
+    int internImage(const IMAGE* image);
+    const TextMetrics& measure(const wchar_t* text);
+    // 把设备上的状态改成 state 里关心的那些项，返回切换次数；apply 为 false 时只计数
+    int applyState(const RenderState& state, RenderState& device, bool apply);
+
+    // 本帧
+    RenderState current;
+    std::vector<RenderState> states;
+    std::vector<RenderCommand> commands;
+    std::vector<POINT> points;
+    std::vector<wchar_t> text;
+    std::vector<const IMAGE*> images;
+
+    // 上一帧
+    std::vector<RenderState> previousStates;
+    std::vector<RenderCommand> previousCommands;
+    std::vector<POINT> previousPoints;
+    std::vector<wchar_t> previousText;
+    std::vector<const IMAGE*> previousImages;
+
+    // 执行时的批次：每个批次是一串命令的链表
+    struct Batch {
+        uint16_t state;
+        int16_t left, top, right, bottom;
+        int32_t head, tail;
+    };
+    std::vector<Batch> batches;
+    std::vector<int32_t> nextInBatch;
+
+    std::vector<int32_t> stateLookup;       // 状态表的哈希索引（开放寻址），每帧清空
+
+    std::vector<std::wstring> faces;        // 字体名称，不随帧清空
+    std::vector<TextMetrics> metrics;       // 直接映射的测量缓存
+    RenderState device;                     // 设备上当前的状态（测量文字也会切换字体），每帧开始时视为未知
+
+    int batchCount;
+    int stateChanges;
+    int unsortedStateChanges;
+    uint64_t skippedFrames;
+};
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 排行榜成绩的回放：一局的种子、难度和每一帧是否跳跃。
+// 随机管道由种子决定（PipeManager 与 Simulation 使用同样的 xorshift32），
+// 服务器用 Simulation 重新模拟一遍就能得到这局真实的分数、等级和时间（见 ReplayVerifier.h）。
+//
+// 文件由一条条记录首尾相接组成：ReplayHeader + getJumpBytes(ticks) 字节的跳跃位。
+// 第 t 位（字节 t/8 的第 t%8 位）为 1 表示第 t 帧（从0开始）更新之前按了跳跃；最后一帧小鸟死亡。
+
+#define REPLAY_FILE "replays.dat"
+#define REPLAY_VERSION 1
+#define REPLAY_NAME_LENGTH 16
+#define REPLAY_MAX_TICKS (60u * 60 * 60 * 24)      // 一局最长24小时，更长的记录视为损坏
+
+#pragma pack(push, 1)
+struct ReplayHeader {
+    char magic[4];              // "FBRP"
+    uint16_t version;
+    uint8_t difficulty;         // 0:简单 1:普通 2:困难
+    uint8_t padding;
+    uint32_t seed;
+    uint32_t ticks;             // 模拟的帧数（包括死亡的那一帧）
+    int32_t score;              // 提交的成绩，与排行榜的一行相同
+    int32_t level;
+    int32_t playTime;
+    int64_t date;
+    char playerName[REPLAY_NAME_LENGTH];
+};
+#pragma pack(pop)
+
+// 游戏中录制一局。跳跃位的空间预先分配，录制时不分配内存
+class ReplayRecorder {
+public:
+    ReplayRecorder();
+
+    // 开始新的一局
+    void start(uint32_t seed, int difficulty);
+
+    // 第 tick 帧更新之前跳跃（同一帧按多次只记一次，效果相同）
+    void recordJump(uint32_t tick);
+
+    // 把这一局（共 ticks 帧）和提交的成绩追加到回放文件
+    bool append(const char* path, const char* playerName, int score, int level, int playTime,
+        int64_t date, uint32_t ticks) const;
+
+    uint32_t getSeed() const { return seed; }
+
+    // ticks 帧的跳跃位占用的字节数
+    static size_t getJumpBytes(uint32_t ticks) { return ((size_t)ticks + 7) / 8; }
+
+    // 填写一条记录的文件头（名字超长时截断）
+    static void fillHeader(ReplayHeader& header, uint32_t seed, int difficulty, uint32_t ticks,
+        const char* playerName, int score, int level, int playTime, int64_t date);
+
+private:
+    std::vector<uint8_t> jumps;
+    uint32_t seed;
+    int difficulty;
+};
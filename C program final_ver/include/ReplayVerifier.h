@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <cstdint>
+#include "Replay.h"
+
+// 排行榜防作弊：重新模拟提交的回放（种子 + 每帧的跳跃），模拟出的分数、等级或时间与提交的成绩不同就拒绝。
+// 回放文件整个读进内存，扫描一遍建立每条记录的偏移，再由所有核心按块领取记录并行模拟；
+// 每条回放只用栈上的 SimState，模拟时不分配内存、不加锁。
+
+enum ReplayVerdict : uint8_t {
+    REPLAY_ACCEPTED,
+    REPLAY_BAD_RECORD,          // 文件头不合法（难度、帧数）
+    REPLAY_DIED_EARLY,          // 在最后一帧之前就死了
+    REPLAY_STILL_ALIVE,         // 最后一帧之后还活着
+    REPLAY_WRONG_SCORE,
+    REPLAY_WRONG_LEVEL,
+    REPLAY_WRONG_TIME,
+    REPLAY_VERDICT_COUNT
+};
+
+// 重新模拟得到的结果
+struct ReplayOutcome {
+    int32_t score;
+    int32_t level;
+    int32_t playTime;
+    uint32_t ticks;             // 实际模拟的帧数
+};
+
+class ReplayVerifier {
+public:
+    // 重新模拟一条回放；jumps 为 ReplayRecorder::getJumpBytes(header.ticks) 字节的跳跃位
+    static ReplayVerdict verify(const ReplayHeader& header, const uint8_t* jumps, ReplayOutcome& outcome);
+
+    // 校验回放文件里的全部记录并打印各阶段的耗时。leaderboardPath 不为 nullptr 时，
+    // 把通过的成绩按 leaderboard.dat 的格式（名字 分数 等级 时间 日期，按排行榜顺序）写入。
+    // 文件损坏或写入失败时返回 false
+    static bool verifyFile(const char* replayPath, const char* leaderboardPath, int threads);
+
+    // 吞吐量测试：并行生成 count 条自动驾驶的回放（每10条篡改1条），全部校验，输出每分钟的校验条数
+    // 和每条回放的耗时分解；篡改的记录没有全部被拒绝、或正常的记录被拒绝时返回 false。
+    // savePath 不为 nullptr 时把生成的回放写入该文件（可以再用 --verify 校验）
+    static bool benchmark(int count, int threads, const char* savePath);
+
+    static const char* getVerdictName(ReplayVerdict verdict);
+};
@@ -0,0 +1,108 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "GameRules.h"
+
+// 练习模式的倒带缓冲：保存最近 REWIND_SECONDS 秒每一帧的游戏状态，可以跳到其中任意一帧继续玩。
+// 每 REWIND_KEYFRAME_INTERVAL 帧存一个完整的关键帧，其余每帧只存相对上一帧的变化
+// （小鸟的Y/速度、分数等的增量、移出的管道数、新生成的管道、通过/吃掉硬币的标记），
+// 管道的X坐标不保存，按上一帧的速度重新计算（与游戏中的运算完全相同，结果逐位一致）；
+// 随机管道的随机数状态也不保存，每生成一根随机管道就按 rollPipe 推进一次。
+// 所有数据都在固定大小的环形缓冲里，录制和跳转都不分配内存。
+// 跳转 = 找到不晚于目标帧的关键帧 + 最多 REWIND_KEYFRAME_INTERVAL - 1 个增量。
+
+#define REWIND_SECONDS 10
+#define REWIND_TICKS ((int)(REWIND_SECONDS * FPS))
+#define REWIND_KEYFRAME_INTERVAL 30
+#define REWIND_DELTA_SLOTS (REWIND_TICKS + REWIND_KEYFRAME_INTERVAL)
+#define REWIND_KEYFRAME_SLOTS (REWIND_DELTA_SLOTS / REWIND_KEYFRAME_INTERVAL + 4)   // 多出的给强制关键帧
+#define REWIND_MAX_PIPES 16     // 与 MAX_PIPES 一致
+
+struct RewindPipe {
+    float x;
+    float gapY;
+    int32_t id;
+    uint32_t color;             // COLORREF
+    uint8_t coin;               // 有未收集的硬币
+    uint8_t passed;
+    uint8_t padding[2];
+};
+
+// 一帧的完整状态（关键帧，也是跳转的结果）
+struct RewindFrame {
+    uint64_t courseCursor;      // 比赛赛道的读取位置
+    uint32_t tick;              // Game::gameTicks
+    uint32_t pipeRng;           // PipeManager 的随机管道状态；增量里不存，由生成的随机管道数推算
+    float birdY, birdVelocity, comboTime;
+    int32_t comboCount, scoreMultiplier;
+    int32_t score, coins, level, pipesPassed, nextPipeID;
+    float gameSpeed, pipeTimer, gameTime;
+    int32_t pipeCount;
+    RewindPipe pipes[REWIND_MAX_PIPES];
+};
+
+// 相对上一帧的变化
+struct RewindDelta {
+    float birdY, birdVelocity, comboTime;
+    float gameSpeed, pipeTimer, gameTime;
+    int16_t comboCount, scoreMultiplier;
+    int16_t scoreDelta, coinsDelta;
+    int8_t levelDelta, pipesPassedDelta;
+    uint8_t idsUsed;            // nextPipeID 的增量
+    uint8_t coursePipes;        // courseCursor 的增量
+    uint8_t retired;            // 从队首移出的管道数
+    uint8_t spawned;            // 0 或 1，新管道在 spawn 里
+    uint16_t passedMask;        // 本帧被标记为通过的管道（移出之后的下标）
+    uint16_t coinMask;          // 本帧被吃掉硬币的管道
+    uint8_t padding[2];
+    RewindPipe spawn;
+};
+
+class RewindBuffer {
+public:
+    RewindBuffer();
+
+    // 清空（开始新的一局时）
+    void clear();
+
+    // 记录一帧；帧号必须比上一帧大1，否则从这一帧重新开始记录。
+    // 变化无法用增量表示时（同一帧生成多根管道、数值超出范围等）自动存为关键帧
+    void record(const RewindFrame& frame);
+
+    // 还原第 tick 帧；不在缓冲范围内时返回 false
+    bool seek(uint32_t tick, RewindFrame& out) const;
+
+    // 从第 tick 帧继续游戏：丢弃之后的记录，之后的 record 接着这一帧
+    bool resumeAt(uint32_t tick, RewindFrame& out);
+
+    bool isEmpty() const { return !hasFrames; }
+    uint32_t getOldestTick() const;
+    uint32_t getNewestTick() const { return last.tick; }
+
+    // 缓冲占用的内存（固定大小）和统计
+    static size_t getMemoryBytes() { return sizeof(RewindBuffer); }
+    uint64_t getKeyframeCount() const { return keyframesWritten; }
+    uint64_t getForcedKeyframeCount() const { return forcedKeyframes; }
+
+    // last → frame 的增量；无法表示时返回 false。观战流（SpectatorStream.h）也用它编码
+    static bool encodeDelta(const RewindFrame& last, const RewindFrame& frame, RewindDelta& delta);
+    static void applyDelta(RewindFrame& frame, const RewindDelta& delta);
+    // 生成 spawned 根管道之后的随机数状态
+    static uint32_t advancePipeRng(uint32_t rng, int spawned, bool fromCourse);
+
+private:
+    void writeKeyframe(const RewindFrame& frame);
+    // 不晚于 tick 的最近一个可用关键帧，没有时返回 -1
+    int findKeyframe(uint32_t tick) const;
+    uint32_t getWindowStart() const;
+
+    RewindFrame keyframes[REWIND_KEYFRAME_SLOTS];
+    bool keyframeValid[REWIND_KEYFRAME_SLOTS];
+    int nextKeyframe;                               // 下一个写入的关键帧槽位
+    RewindDelta deltas[REWIND_DELTA_SLOTS];         // deltas[t % 槽数]：第 t-1 帧到第 t 帧的变化
+    RewindFrame last;                               // 最近记录的一帧（编码增量用）
+    uint32_t highestTick;                           // 写入过增量的最大帧号（倒带后不减小）
+    bool hasFrames;
+    uint64_t keyframesWritten;
+    uint64_t forcedKeyframes;
+};
@@ -0,0 +1,97 @@
+﻿#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "Simulation.h"
+#include "ServerProtocol.h"
+
+// 回滚联机（GGPO 式）的点对点比赛：两名玩家各自一只小鸟，同一个种子、同样的管道。
+// 对方的输入经过网络才到，本地不等待：先把对方的输入预测为"和最近一次收到的一样"继续模拟，
+// 真实输入到达后如果与预测不同，就恢复到那一帧的存档，用正确的输入重新模拟到当前帧。
+// 整个游戏状态是纯数据（RollbackState），每帧存档/读档都只是一次结构体拷贝。
+// 预测超过 ROLLBACK_MAX_FRAMES 帧时暂停推进，等待对方的输入。
+
+#define ROLLBACK_MAX_FRAMES 8           // 最多预测（回滚）的帧数
+#define ROLLBACK_INPUT_HISTORY 128      // 输入记录的环形缓冲帧数
+#define ROLLBACK_SAVE_SLOTS (ROLLBACK_MAX_FRAMES + 2)
+#define ROLLBACK_PLAYERS 2
+
+// 一帧的完整游戏状态
+struct RollbackState {
+    SimState players[ROLLBACK_PLAYERS];
+    uint32_t frame;             // 下一个要模拟的帧号
+    uint32_t round;             // 两只小鸟都死亡后开始下一回合
+    uint32_t seed;
+    int32_t difficulty;
+};
+static_assert(std::is_trivially_copyable<RollbackState>::value, "RollbackState must be copyable with memcpy");
+
+struct RollbackStats {
+    uint64_t frames;                // 推进的帧数
+    uint64_t rollbacks;             // 因预测错误而回滚的次数
+    uint64_t resimulatedFrames;     // 回滚时重新模拟的帧数
+    int maxRollback;                // 最深的一次回滚
+};
+
+class RollbackSession {
+public:
+    RollbackSession();
+
+    // 开始比赛；两端的 seed、difficulty 必须相同，localPlayer 一端为0、另一端为1
+    void reset(uint32_t seed, int difficulty, int localPlayer);
+
+    // 预测的帧数未满时可以推进；否则应当暂停这一帧（画面不动），继续收发网络包
+    bool canAdvance() const;
+    // 用本地输入推进一帧；之前收到的输入与预测不同时，先回滚重算
+    void advance(bool localJump);
+
+    // 收到对方某一帧的输入
+    void addRemoteInput(uint32_t frame, bool jump);
+
+    // 网络：每帧发一个包给对方（包含对方还没确认的本地输入），收到对方的包时交给 receivePacket
+    void buildPacket(PeerInputPacket& packet) const;
+    void receivePacket(const PeerInputPacket& packet);
+
+    // 当前（可能含预测的）状态，用于显示
+    const RollbackState& getState() const { return current; }
+    uint32_t getFrame() const { return current.frame; }
+    // 对方输入已经连续收到的帧数：这之前的帧不会再回滚
+    uint32_t getConfirmedFrame() const { return remoteFrames; }
+    const RollbackStats& getStats() const { return stats; }
+
+    // 同步校验：帧号小于 getSyncFrame() 的已确认状态的校验和（只保留最近 ROLLBACK_INPUT_HISTORY 帧）。
+    // 两端同一帧的校验和不同说明模拟不一致
+    uint32_t getSyncFrame() const { return syncFrame; }
+    bool getChecksum(uint32_t frame, uint64_t& out) const;
+
+    static uint64_t checksum(const RollbackState& state);
+
+    // 本机回环测试：两个会话通过 UDP 互发输入，发送时注入延迟、抖动和丢包，
+    // 按 60 FPS 实时运行 seconds 秒，统计回滚深度和每帧耗时，并比对两端的校验和
+    static bool runLoopbackTest(int latencyMs, int jitterMs, int lossPercent, double seconds);
+
+private:
+    // 模拟 state.frame 这一帧，并记录对方输入未到时使用的预测值
+    void simulateFrame(RollbackState& state);
+    void resolveRollback();
+    void updateChecksums();
+
+    uint8_t predictRemote() const;
+    bool isRemoteKnown(uint32_t frame) const;
+
+    RollbackState current;
+    RollbackState saved[ROLLBACK_SAVE_SLOTS];   // saved[f % 槽数] 是第 f 帧开始时的状态
+    int localPlayer;
+
+    uint8_t localInputs[ROLLBACK_INPUT_HISTORY];
+    uint8_t remoteInputs[ROLLBACK_INPUT_HISTORY];
+    uint32_t remoteKnown[ROLLBACK_INPUT_HISTORY];    // 已收到的帧号 + 1，0 表示未收到
+    uint8_t predicted[ROLLBACK_INPUT_HISTORY];       // 模拟该帧时对方输入的预测值
+    uint32_t remoteFrames;          // 对方输入连续收到的帧数
+    uint32_t peerAck;               // 对方已连续收到的本地输入帧数
+    uint32_t rollbackFrame;         // 需要从这一帧开始重算；没有时为 UINT32_MAX
+
+    uint64_t checksums[ROLLBACK_INPUT_HISTORY];
+    uint32_t syncFrame;
+
+    RollbackStats stats;
+};
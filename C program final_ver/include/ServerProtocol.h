@@ -0,0 +1,138 @@
+﻿#pragma once
+#include <cstdint>
+
+// 联机对战服务器与客户端之间的 UDP 协议（所有字段按小端、1字节对齐）
+//
+// 客户端先向基础端口发 HELLO，得知工作线程数；房间固定在工作线程 roomId % workerCount 上，
+// 之后的 JOIN / INPUT / LEAVE 都发到该线程的端口（基础端口 + 线程编号）。
+// 服务器每帧把收到的输入一起应用，再给房间里每个玩家发一个包含全房间状态的 STATE。
+//
+// 观战：机台（FlappyBird --broadcast）每帧把观战流消息 SPECTATE_STREAM 发到机台编号对应的工作线程，
+// 观众（FlappyBird --spectate）向同一线程发 SPECTATE_JOIN 订阅并每秒重发作为保活；
+// 服务器把机台的消息原样转发给所有订阅的观众（消息内容见 SpectatorStream.h）。
+
+#define SERVER_DEFAULT_PORT 27960
+#define SERVER_PROTOCOL_VERSION 1
+#define SERVER_MAX_WORKERS 32
+#define ROOM_MAX_PLAYERS 2                  // 一对一对战
+#define SERVER_SESSION_TIMEOUT_SECONDS 5.0  // 这么久没有收到包就移除会话
+#define SERVER_MAX_PACKET 1472           // 以太网 MTU 内最大的 UDP 数据
+#define SPECTATE_TIMEOUT_SECONDS 5.0        // 观众这么久没有发 SPECTATE_JOIN 就停止转发
+
+enum PacketType : uint8_t {
+    PACKET_HELLO = 1,
+    PACKET_HELLO_REPLY,
+    PACKET_JOIN,
+    PACKET_INPUT,
+    PACKET_LEAVE,
+    PACKET_STATE,
+    PACKET_STATS,
+    PACKET_STATS_REPLY,
+    PACKET_PEER_INPUT,                      // 点对点比赛（回滚联机，见 Rollback.h）
+    PACKET_SPECTATE_JOIN,
+    PACKET_SPECTATE_STREAM
+};
+
+#pragma pack(push, 1)
+struct PacketHeader {
+    uint8_t type;
+    uint8_t version;
+    uint16_t reserved;
+};
+
+struct HelloReplyPacket {
+    PacketHeader header;
+    uint16_t basePort;
+    uint16_t workerCount;
+};
+
+// JOIN 和 LEAVE
+struct JoinPacket {
+    PacketHeader header;
+    uint32_t clientId;
+    uint32_t roomId;
+};
+
+// 客户端每帧一个；stamp 是客户端的发送时间，服务器在 STATE 里原样带回，用来测延迟
+struct InputPacket {
+    PacketHeader header;
+    uint32_t clientId;
+    uint32_t roomId;
+    uint8_t jump;
+    uint8_t padding[3];
+    uint64_t stamp;
+};
+
+struct StatePlayer {
+    uint32_t clientId;
+    float y;
+    float velocity;
+    int32_t score;
+    uint8_t alive;
+    uint8_t padding[3];
+};
+
+struct StatePacket {
+    PacketHeader header;
+    uint32_t roomId;
+    uint32_t clientId;          // 接收者
+    uint32_t seed;              // 本回合的种子，客户端可以用 Simulation 自己生成同样的管道
+    uint32_t round;
+    uint32_t tick;              // 本回合的帧号
+    uint64_t echoStamp;         // 接收者最近一次已应用的输入的 stamp
+    uint8_t playerCount;
+    uint8_t padding[3];
+    StatePlayer players[ROOM_MAX_PLAYERS];
+};
+
+// 一个工作线程最近一秒的统计
+struct WorkerStatsRecord {
+    uint32_t rooms;
+    uint32_t sessions;
+    float tickP50Us;            // 处理一帧（所有房间）的耗时分位数
+    float tickP99Us;
+    float tickMaxUs;
+    float busy;                 // 非等待时间所占比例（0~1）
+    uint64_t packetsIn;
+    uint64_t packetsOut;
+    uint16_t cabinets;          // 正在转发的机台数
+    uint16_t viewers;           // 订阅的观众数（超过 65535 时记为 65535）
+};
+
+struct StatsReplyPacket {
+    PacketHeader header;
+    uint16_t workerCount;
+    uint16_t padding;
+    WorkerStatsRecord workers[SERVER_MAX_WORKERS];
+};
+static_assert(sizeof(StatsReplyPacket) <= SERVER_MAX_PACKET, "统计回复必须放进一个数据报");
+
+// 点对点比赛：每帧发一个，带上对方还没确认的最近 count 帧输入（丢包时靠后面的包补上）。
+// 第 i 位是 firstFrame + i 帧的输入；ackFrame 是已经连续收到的对方输入的下一帧
+struct PeerInputPacket {
+    PacketHeader header;
+    uint32_t firstFrame;
+    uint32_t ackFrame;
+    uint8_t count;              // 1 ~ 64
+    uint8_t padding[3];
+    uint64_t jumps;
+};
+
+// 观众订阅机台；viewerId 区分同一地址上的多个观众（压力测试用一个套接字模拟很多观众）
+struct SpectateJoinPacket {
+    PacketHeader header;
+    uint32_t cabinetId;
+    uint16_t viewerId;
+    uint16_t padding;
+};
+
+// 观战流消息头，后面紧跟快照或增量的数据
+struct SpectateStreamHeader {
+    PacketHeader header;
+    uint32_t cabinetId;
+    uint32_t tick;              // 机台本局的帧号
+    uint8_t kind;               // SPECTATE_KEYFRAME / SPECTATE_DELTA
+    uint8_t events;             // 本帧的粒子事件（SpectateEvent）
+    uint16_t fields;            // 增量里出现的字段（SpectateField）
+};
+#pragma pack(pop)
@@ -0,0 +1,108 @@
+﻿#pragma once
+#include <cstdint>
+#include "GameRules.h"
+
+// 无图形、确定性的游戏规则核心：逐帧复刻 Game::updateGameplay 的规则
+// （重力、跳跃、管道移动与生成、碰撞、硬币、连击倍数、每5根管道升级），
+// 状态是纯数据（POD），可以直接 memcpy 保存/恢复。
+// 随机数使用状态里自带的 xorshift32，同样的种子和操作序列在任何机器上结果都相同。
+// 强化学习接口、自动驾驶、回放校验等都基于它，不依赖 EasyX/SFML/Windows。
+
+#define SIM_MAX_PIPES 16
+#define SIM_PIPE_WIDTH 70       // 与 Pipe 一致
+#define SIM_PIPE_GAP 160
+#define SIM_BIRD_RADIUS 15      // 与 Bird 一致
+#define SIM_BIRD_MARGIN 3       // 碰撞框比小鸟小一圈
+#define SIM_COIN_RADIUS 12
+
+struct SimPipe {
+    float x;
+    float gapY;
+    int32_t id;
+    uint8_t hasCoin;
+    uint8_t coinCollected;
+    uint8_t passed;
+    uint8_t colorType;          // 0~3：绿、蓝、紫、红
+};
+
+struct SimState {
+    uint32_t rng;               // xorshift32 状态
+    uint32_t tick;              // 本局已经模拟的帧数
+
+    // 小鸟
+    float birdX, birdY;
+    float birdVelocity;
+    float gravity;
+    float jumpForce;
+    float comboTime;
+    int32_t comboCount;
+    int32_t scoreMultiplier;
+    uint8_t alive;
+    uint8_t difficulty;
+    uint8_t reserved[2];
+
+    // 本局数据
+    int32_t score;
+    int32_t coins;
+    int32_t level;
+    int32_t pipesPassed;
+    int32_t nextPipeID;
+    float gameSpeed;
+    float pipeTimer;
+    float gameTime;
+
+    // 管道（按生成顺序排列，X坐标递增）
+    int32_t pipeCount;
+    SimPipe pipes[SIM_MAX_PIPES];
+};
+
+// 与小鸟所在列（X范围）重叠的管道，碰撞边界已经按游戏的方式取整。
+// 所有小鸟X相同时，每帧算一次就能给任意多只小鸟做碰撞检测（种群模式、求解器）
+struct SimColumnPipe {
+    int gapTop, gapBottom;          // 上管道底边、下管道顶边
+    int coinTop, coinBottom;        // 硬币的上下边
+    int32_t coinPipe;               // 硬币所在管道的编号；硬币不在这一列或已被收集时为 -1
+};
+
+struct SimColumn {
+    int count;
+    SimColumnPipe pipes[SIM_MAX_PIPES];
+};
+
+// step() 的返回值：本帧发生的事件（可以同时有多个）
+enum SimEvent {
+    SIM_EVENT_PASSED = 1,       // 通过了管道
+    SIM_EVENT_COIN = 2,         // 收集了硬币
+    SIM_EVENT_DIED = 4,         // 撞到管道或地面
+    SIM_EVENT_LEVEL_UP = 8,     // 等级提升
+    SIM_EVENT_SPAWN = 16        // 生成了新管道
+};
+
+class Simulation {
+public:
+    // 开始新的一局；difficulty 与设置界面一致（0:简单 1:普通 2:困难）
+    static void reset(SimState& state, uint32_t seed, int difficulty);
+
+    // 推进一帧（1/FPS 秒）；jump 为 true 时先跳跃再更新，与游戏中“先处理输入后更新”一致
+    static uint32_t step(SimState& state, bool jump);
+
+    // 小鸟前方第 skip 根管道（0 = 下一根），没有时返回 nullptr
+    static const SimPipe* getNextPipe(const SimState& state, int skip);
+
+    // --- 以下是 step() 的组成部分，供共享管道场的种群模式（Population）复用 ---
+    // 连击计时递减（属于 Bird::update）
+    static void updateCombo(SimState& state);
+    // 移动管道并移除出界的管道
+    static void movePipes(SimState& state);
+    // 通过管道计分、连击、升级，然后按计时器生成管道；返回事件
+    static uint32_t updatePassAndSpawn(SimState& state);
+    // 收集 movePipes() 之后与小鸟列重叠的管道
+    static void buildColumn(const SimState& world, SimColumn& column);
+    // 在共享管道场中推进一只小鸟（Y、速度、最近收集硬币的管道编号），
+    // 返回 SIM_EVENT_DIED 或 SIM_EVENT_COIN（硬币不从管道场中移除，由 lastCoinPipe 防止重复收集）
+    static uint32_t stepBird(const SimState& world, const SimColumn& column,
+        float& y, float& velocity, int32_t& lastCoinPipe, bool jump);
+
+private:
+    static void spawnPipe(SimState& state);
+};
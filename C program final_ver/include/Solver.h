@@ -0,0 +1,97 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+
+// 完美操作求解器（离线工具）：对给定种子，穷举每一帧"跳/不跳"，求能达到的最高分，
+// 用来校准难度参数（applyDifficulty）和找出很难通过的赛道。
+//
+// 管道场与小鸟的操作无关，所有存活路线在同一帧通过同一根管道，所以按帧逐层展开：
+// 每层只保存互不相同的小鸟状态（Y、速度、是否已吃到当前管道的硬币），
+// 状态离散化后打包成一个键，放进多线程共享的无锁置换表去重；
+// 相同键的路线只保留一条，硬币数取最大值。
+// 离散化会把非常接近的状态视为同一个，每个格子只保留一条精确路线继续展开，被合并掉的路线可能本来能走得更远。
+// 所以结果是单向的：找到的路线和分数一定能够实际达到（通过 = 确实能通过，最高分是下界），
+// 没找到路线只说明在这个精度下没有找到，不能证明赛道不可能通过。
+// （按精确的浮点状态去重才能得到确定的结论，但跳跃历史不同的路线几乎从不重合，状态数会失控。）
+// 多线程时哪条路线先进表不固定，展开的状态数（极少数情况下分数）在两次运行之间可能略有不同。
+
+#define SOLVER_Y_STEPS_PER_PIXEL 1      // Y 的离散精度（1 像素，与碰撞检测的取整一致）
+#define SOLVER_VELOCITY_STEPS 8         // 速度的离散精度（1/8 像素/帧）
+#define SOLVER_TABLE_BITS 18            // 置换表的初始大小 2^18 项（2 MB），放得进缓存；不够时自动扩大
+
+struct SolverResult {
+    bool completed;             // 是否找到了通过全部目标管道的路线（false 不代表不可能通过）
+    int maxScore;               // 找到的最高分（实际能达到，是理论最高分的下界）
+    int pipesPassed;            // 找到的路线最多通过的管道数（同样是下界）
+    uint32_t ticks;             // 最后一条存活路线坚持的帧数
+    uint64_t states;            // 展开的状态数
+    size_t peakWidth;           // 单帧最多的不同状态数
+    double seconds;
+};
+
+class Solver {
+public:
+    explicit Solver(int threads = 1, int tableBits = SOLVER_TABLE_BITS);
+    ~Solver();
+
+    Solver(const Solver&) = delete;
+    void operator=(const Solver&) = delete;
+
+    // 求解种子 seed 的前 targetPipes 根管道
+    SolverResult solve(uint32_t seed, int difficulty, int targetPipes);
+
+    // 命令行工具：求解并打印结果；difficulty 为 -1 时依次求解三种难度
+    static bool run(uint32_t seed, int targetPipes, int difficulty, int threads);
+
+private:
+    // 一层中的一条路线：精确的状态 + 它在置换表中的位置（硬币数从表里读最大值）
+    struct Node {
+        float y;
+        float velocity;
+        int32_t lastCoinPipe;
+        uint32_t slot;          // NO_SLOT 表示没进表（探测太长），硬币数用 coins
+        int32_t coins;
+    };
+
+    // 每个线程的输出，层结束后合并
+    struct WorkerOutput {
+        std::vector<Node> next;
+        int bestDeathScore;
+        uint64_t expanded;
+    };
+
+    void expandRange(WorkerOutput& out);
+    void insert(WorkerOutput& out, const Node& node, bool coinFlag);
+    int readCoins(const Node& node) const;
+    void growTable(size_t minEntries);
+
+    void workerLoop(int index);
+    void runLayer();
+    void stopWorkers();
+
+    // 置换表：每项一个64位字 = 键（帧号、Y、速度、硬币标记）<< 16 | 硬币数
+    // 帧号比当前层早两层以上的项视为空位，可以直接覆盖，不需要每层清空
+    std::vector<std::atomic<uint64_t>> table;
+    uint64_t tableMask;
+
+    // 当前层
+    SimState world;
+    SimColumn column;
+    int32_t nextPipeId;             // 当前层的"下一根管道"，硬币标记相对于它
+    std::vector<Node> frontier;
+    std::atomic<size_t> cursor;     // 各线程从这里领取下一批路线
+
+    std::vector<WorkerOutput> outputs;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;
+    int pendingWorkers;
+    bool stopping;
+};
@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include "SpectatorStream.h"
+
+// 游戏端收发观战流。头文件里只有前置声明：winsock2.h 必须在 windows.h 之前包含，
+// 而游戏的源文件都通过 graphics.h 先包含了 windows.h，所以套接字只在 SpectatorLink.cpp 里使用。
+class UdpSocket;
+struct NetAddress;
+
+// 机台：每帧把画面编码后发给观战服务器（FlappyServer），服务器再转发给所有观众
+class SpectatorBroadcaster {
+public:
+    SpectatorBroadcaster();
+    ~SpectatorBroadcaster();
+
+    SpectatorBroadcaster(const SpectatorBroadcaster&) = delete;
+    void operator=(const SpectatorBroadcaster&) = delete;
+
+    // 向服务器询问工作线程数，之后发到机台编号对应的线程；服务器没有回复时返回 false
+    bool open(const char* host, uint16_t port, uint32_t cabinetId);
+    void publish(const SpectatorFrame& frame, uint8_t events, bool playing);
+
+    uint32_t getCabinetId() const { return cabinetId; }
+    const SpectatorEncoder& getEncoder() const { return encoder; }
+
+private:
+    UdpSocket* socket;
+    NetAddress* server;
+    SpectatorEncoder encoder;
+    uint32_t cabinetId;
+};
+
+// 观众：订阅一台机台，按顺序应用收到的消息
+class SpectatorViewer {
+public:
+    SpectatorViewer();
+    ~SpectatorViewer();
+
+    SpectatorViewer(const SpectatorViewer&) = delete;
+    void operator=(const SpectatorViewer&) = delete;
+
+    bool open(const char* host, uint16_t port, uint32_t cabinetId);
+
+    // 读完已到达的消息，每秒重发一次订阅；画面更新时返回 true，events 为这些消息带的粒子事件
+    bool poll(uint8_t& events);
+
+    uint32_t getCabinetId() const { return cabinetId; }
+    const SpectatorDecoder& getDecoder() const { return decoder; }
+    uint64_t getMessagesReceived() const { return messages; }
+    uint64_t getBytesReceived() const { return bytes; }
+
+private:
+    UdpSocket* socket;
+    NetAddress* server;
+    SpectatorDecoder decoder;
+    uint32_t cabinetId;
+    uint64_t nextJoinMillis;
+    uint64_t messages;
+    uint64_t bytes;
+};
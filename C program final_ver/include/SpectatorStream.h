@@ -0,0 +1,111 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "RewindBuffer.h"
+#include "ServerProtocol.h"
+
+// 观战流：把一台机台的画面（小鸟、管道、HUD）编码成一串 UDP 消息，观众端用游戏自己的绘制代码显示。
+// 先发一个完整的快照，之后每帧只发相对上一帧的增量：增量复用倒带缓冲的 RewindDelta
+// （管道X按速度推算，只传移出/新生成的管道和通过、吃掉硬币的标记），
+// 再按字段省略没有变化或可以推算的部分，平常一帧只有消息头 + 小鸟的Y和速度（24字节）。
+// 粒子是装饰效果，只传触发事件和随机种子，由观众端自己生成。
+// 丢了一条增量后，后面的增量都用不上，观众停在最后一帧，等下一个快照（每 SPECTATE_KEYFRAME_TICKS 帧一个）。
+
+#define SPECTATE_KEYFRAME_TICKS 60      // 每秒一个快照：新来的和丢过包的观众最多等1秒
+#define SPECTATE_NAME_LENGTH 16
+
+enum SpectateKind : uint8_t {
+    SPECTATE_KEYFRAME = 1,
+    SPECTATE_DELTA
+};
+
+// 粒子事件（观众端在小鸟位置生成对应的粒子）
+enum SpectateEvent : uint8_t {
+    SPECTATE_EVENT_JUMP = 1,
+    SPECTATE_EVENT_COIN = 2,
+    SPECTATE_EVENT_HIT = 4
+};
+
+// 增量里出现的字段，按位的顺序依次排在消息头之后
+enum SpectateField : uint16_t {
+    SPECTATE_FIELD_BIRD = 1 << 0,       // float birdY, birdVelocity
+    SPECTATE_FIELD_COMBO = 1 << 1,      // int16 comboCount, scoreMultiplier; float comboTime（连击计时按规则递减时省略）
+    SPECTATE_FIELD_SCORE = 1 << 2,      // int16 scoreDelta, coinsDelta
+    SPECTATE_FIELD_LEVEL = 1 << 3,      // int8 levelDelta, pipesPassedDelta; float gameSpeed
+    SPECTATE_FIELD_PIPES = 1 << 4,      // uint8 retired, idsUsed, coursePipes
+    SPECTATE_FIELD_MASKS = 1 << 5,      // uint16 passedMask, coinMask
+    SPECTATE_FIELD_SPAWN = 1 << 6,      // RewindPipe
+    SPECTATE_FIELD_TIMER = 1 << 7,      // float pipeTimer（每帧加 1/FPS 时省略）
+    SPECTATE_FIELD_TIME = 1 << 8,       // float gameTime（每帧加 1/FPS 时省略）
+    SPECTATE_FIELD_HIGH_SCORE = 1 << 9  // int32 highScore
+};
+
+// 观众看到的一帧。快照直接发送这个结构的前一部分（到 game.pipes[pipeCount] 为止）
+struct SpectatorFrame {
+    uint8_t gameState;          // GameState
+    uint8_t padding[3];
+    int32_t highScore;
+    uint32_t particleSeed;      // 每局换一次，同一机台的所有观众生成同样的粒子
+    char playerName[SPECTATE_NAME_LENGTH];
+    uint32_t reserved;
+    RewindFrame game;
+};
+static_assert(std::is_trivially_copyable<SpectatorFrame>::value, "SpectatorFrame 按字节发送");
+
+// 机台端：把每帧的画面编码成消息
+class SpectatorEncoder {
+public:
+    SpectatorEncoder();
+
+    void reset();
+
+    // 编码这一帧，返回消息长度；0 表示这一帧不需要发送。out 至少 SERVER_MAX_PACKET 字节。
+    // playing 为 false 时（菜单、暂停、结束画面）只在画面变化、有事件或每 SPECTATE_KEYFRAME_TICKS 次调用时发快照
+    int encode(uint32_t cabinetId, const SpectatorFrame& frame, uint8_t events, bool playing, uint8_t* out);
+
+    uint64_t getKeyframeCount() const { return keyframes; }
+    uint64_t getDeltaCount() const { return deltas; }
+    uint64_t getBytesEncoded() const { return bytes; }
+
+    // 快照的长度（消息头 + 用到的管道）
+    static int getKeyframeSize(const SpectatorFrame& frame);
+
+private:
+    int writeKeyframe(uint32_t cabinetId, const SpectatorFrame& frame, uint8_t events, uint8_t* out);
+    int writeDelta(uint32_t cabinetId, const SpectatorFrame& frame, uint8_t events, uint8_t* out);
+
+    SpectatorFrame last;
+    bool hasLast;
+    int sinceKeyframe;          // 上一个快照之后的调用次数
+    uint64_t keyframes;
+    uint64_t deltas;
+    uint64_t bytes;
+};
+
+// 观众端：按顺序应用收到的消息
+class SpectatorDecoder {
+public:
+    SpectatorDecoder();
+
+    void reset();
+
+    // 应用一条消息，画面更新时返回 true。
+    // 重复的增量被忽略；缺了一帧时停在当前画面，直到下一个快照
+    bool apply(const void* data, int size);
+
+    bool hasFrame() const { return hasAny; }
+    bool isSynced() const { return synced; }
+    const SpectatorFrame& getFrame() const { return frame; }
+    uint8_t getEvents() const { return events; }        // 最近应用的消息带的粒子事件
+    uint64_t getGapCount() const { return gaps; }
+
+private:
+    bool applyDelta(const SpectateStreamHeader& header, const uint8_t* body, int size);
+
+    SpectatorFrame frame;
+    bool hasAny;
+    bool synced;
+    uint8_t events;
+    uint64_t gaps;
+};
@@ -6,11 +6,7 @@
 #define CONSTANTS_H
 
 #include <graphics.h>
-
-// 屏幕尺寸
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
-#define GROUND_HEIGHT 60
+#include "GameRules.h"   // 屏幕尺寸、帧率（不依赖图形库，模拟核心也使用）
 
 // 游戏状态
 enum GameState {
@@ -21,7 +17,8 @@ enum GameState {
     STATE_LEADERBOARD,
     STATE_SETTINGS,
     STATE_HELP,
-    STATE_CREDITS
+    STATE_CREDITS,
+    STATE_REWIND        // 练习模式倒带（BACKSPACE）
 };
 
 // 颜色常量
@@ -45,6 +42,24 @@ enum GameState {
 #define COLOR_TEXT_PURPLE RGB(160, 32, 240)    // 紫色文字
 
 // 游戏常量
-#define FPS 60.0
+#define PROFILER_CAPTURE_FRAMES 300    // F9 性能分析一次采集的帧数（约5秒）
+#define FRAME_STATS_WINDOW_SECONDS 5.0 // 帧时间分位数的统计窗口（秒）
+#define FRAME_GRAPH_SAMPLES 120        // 帧时间曲线显示的帧数
+#define ATTRACT_IDLE_SECONDS 20.0f     // 主菜单无操作多久后进入自动演示
+#define ATTRACT_RESTART_SECONDS 3.0f   // 自动演示中小鸟死亡后多久重新开始
+#define ATTRACT_MAX_ROUNDS 3           // 一次自动演示最多玩几局，之后回到主菜单待机，有按键之前不再演示
+#define REWIND_SCRUB_TICKS 2           // 倒带时按住方向键每帧移动的帧数（2倍速）
+#define GROUND_TILE_PERIOD 200         // 地面图案的重复周期（像素，草叶间距20、土块间距40的公倍数）
+#define GROUND_GRASS_HEIGHT 20         // 草叶伸出地面的最大高度
+#define GROUND_PARALLAX 1.0f           // 地面滚动速度相对管道速度的倍数
+#define IDLE_ANIMATION_FPS 10          // 静态界面没有输入时的重画频率（云朵等背景动画）
+
+// 排行榜
+#define LEADERBOARD_FILE "leaderboard.dat"
+#define LEADERBOARD_SIZE 10            // 保留的记录条数
+
+// 预先分配的容量：稳定运行时不再扩容（超出时新粒子直接丢弃）
+#define MAX_PARTICLES 1024
+#define MAX_PIPES 16
 
 #endif // CONSTANTS_H
\ No newline at end of file
@@ -15,6 +15,19 @@
 #include "bird.h"
 #include "pipemanager.h"
 #include "constants.h"
+#include "FrameStats.h"
+#include "Simulation.h"
+
+class Autopilot;
+class RewindBuffer;
+struct RewindFrame;
+class SpectatorBroadcaster;
+class SpectatorViewer;
+struct SpectatorFrame;
+class ReplayRecorder;
+class ParticleRenderer;
+class IdleWaiter;
+class CloudLayers;
 
 // 分数记录结构体
 struct ScoreEntry {
@@ -51,6 +64,7 @@ private:
 public:
     Particle(float px, float py, COLORREF col, int t);
     void update(float deltaTime);
+    // 逐个绘制（游戏中用 ParticleRenderer 批量绘制，这里保留作为基准测试的对照）
     void draw() const;
     void drawStar(int cx, int cy, int radius) const;
 
@@ -58,20 +72,13 @@ public:
     bool shouldRemove() const { return life <= 0; }
     float getLife() const { return life; }
     float getMaxLife() const { return maxLife; }
-};
-
-// 云朵类
-class Cloud {
-private:
-    float x, y;         // 位置
-    float speed;        // 移动速度
-    int size;          // 大小
-    int alpha;         // 透明度
-
-public:
-    Cloud();
-    void update(float deltaTime);
-    void draw() const;
+    float getX() const { return x; }
+    float getY() const { return y; }
+    float getVX() const { return vx; }
+    float getVY() const { return vy; }
+    COLORREF getColor() const { return color; }
+    int getSize() const { return size; }
+    int getType() const { return type; }
 };
 
 // 游戏主类
@@ -94,6 +101,10 @@ private:
     float gameTime;
     int pipesPassed;
     int nextPipeID;
+    int gameTicks;          // 本局经过的固定步长帧数（比赛赛道按它生成管道）
+
+    // 比赛赛道（未加载时使用随机管道）
+    CourseFile course;
 
     // UI数据
     std::string playerName;
@@ -111,6 +122,45 @@ private:
     //暂停屏幕背景
 	IMAGE pauseBackground;
 
+    // 地面条：一屏宽再加一个图案周期，第一次绘制时生成；每帧从 groundOffset 处截取一屏宽
+    IMAGE groundTile;
+    float groundOffset;
+
+    // 资源加载耗时（毫秒）
+    double assetLoadMillis;
+
+    // 帧时间统计（F8 导出 CSV）
+    FrameStats* frameStats;
+    // 堆分配计数：最近一帧里单次 update 的最大分配次数，以及 render 的分配次数
+    uint64_t tickAllocations;
+    uint64_t frameAllocations;
+    // 静态界面的省电等待：只在有按键或动画帧时重画
+    IdleWaiter* idleWaiter;
+
+    // 自动驾驶：F7 切换；主菜单无操作一段时间后进入自动演示（任意键退出）
+    Autopilot* autopilot;
+    bool autopilotEnabled;
+    bool attractMode;
+    float idleTime;         // 主菜单无操作的时间；自动演示中为死亡后经过的时间
+    int attractRounds;      // 上次按键以来演示过的局数，满 ATTRACT_MAX_ROUNDS 后不再自动开始
+
+    // 练习模式倒带：游戏中或死亡后按 BACKSPACE 进入，方向键拖动，空格从选中的帧继续
+    RewindBuffer* rewind;
+    uint32_t rewindTick;            // 倒带界面当前显示的帧
+    GameState rewindReturnState;    // 取消倒带时回到的界面
+    double rewindSeekMicros;        // 最近一次跳转的耗时（微秒）
+    bool practiceRun;               // 本局用过倒带：之后的成绩不进排行榜
+    bool autopilotRun;              // 本局开过自动驾驶（F7）：成绩同样不进排行榜和回放文件
+
+    // 观战：--broadcast 时每帧把画面发给观战服务器；--spectate 时显示另一台机台的画面
+    SpectatorBroadcaster* broadcaster;
+    SpectatorViewer* spectator;
+    uint8_t spectatorEvents;        // 本帧的粒子事件（SpectateEvent），发送后清零
+    uint32_t particleSeed;          // 每局换一次，同一机台的观众用它生成同样的粒子
+
+    // 排行榜成绩的回放：每局的管道种子和每帧的跳跃，成绩进排行榜时追加到 replays.dat（FlappyServer --verify 校验）
+    ReplayRecorder* replay;
+
     // 游戏设置
     float birdGravity;
     float birdJumpForce;
@@ -124,11 +174,14 @@ private:
 
     // 游戏元素
     std::vector<Particle> particles;
-    std::vector<Cloud> clouds;
+    ParticleRenderer* particleRenderer;     // 粒子的剔除、分桶批量绘制
+    CloudLayers* cloudLayers;               // 云朵的视差滚动层
     std::vector<ScoreEntry> leaderboard;
 
     // 私有方法
     void updateInput();
+    bool keyStateChanged() const;
+    bool isStaticScreen() const;
     void handleInput();
     void handleMenuInput();
     void handleGameInput();
@@ -138,12 +191,24 @@ private:
     void handleSettingsInput();
     void handleHelpInput();
     void handleCreditsInput();
+    void handleRewindInput();
+    void jumpBird();
+    void startAttractMode();
+    void stopAttractMode();
+    void startRewind();
+    void seekRewind(uint32_t tick);
+    void captureRewindFrame(RewindFrame& frame) const;
+    void restoreRewindFrame(const RewindFrame& frame);
+    void captureSpectatorFrame(SpectatorFrame& frame) const;
+    void publishSpectatorFrame();
+    void applySpectatorFrame(uint8_t events);
     void adjustSetting(int direction);
     void applyDifficulty();
     void updateGameplay(float deltaTime);
     void updateParticles(float deltaTime);
     void drawSkyBackground();
     void drawGround();
+    void buildGroundTile();
     void drawGameUI();
     void drawHitboxes();
     void drawFPS();
@@ -155,15 +220,31 @@ private:
     void drawSettings();
     void drawHelp();
     void drawCredits();
+    void drawRewindOverlay();
+    void drawSpectatorOverlay();
     void drawProgressBar(int x, int y, int width, int height, int type);
+    void loadAssets();
+    void loadAssetFiles();
+    bool loadAssetBundle(const char* path);
 
 public:
     Game();
     ~Game();
 
     void init();
-    void loadLeaderboard();
-    void saveLeaderboard();
+    static bool packAssets(const char* path);
+    void benchmarkStartup(int runs);
+    bool runBenchmarks(const char* jsonPath);
+    bool checkSteadyStateAllocations(int ticks);
+    bool dumpRenderCommands(const char* path);
+    bool loadCourse(const char* path);
+    bool startBroadcast(const char* host, int port, uint32_t cabinetId);
+    bool runSpectator(const char* host, int port, uint32_t cabinetId);
+    void captureSimState(SimState& state) const;
+    double getAssetLoadMillis() const { return assetLoadMillis; }
+    void loadLeaderboard(const char* path = LEADERBOARD_FILE);
+    void saveLeaderboard(const char* path = LEADERBOARD_FILE, size_t maxEntries = LEADERBOARD_SIZE);
+    void insertLeaderboardEntry(const ScoreEntry& entry);
     void addToLeaderboard();
     void createParticles(float x, float y, int count, COLORREF color, int type);
     void shakeScreen(float intensity);
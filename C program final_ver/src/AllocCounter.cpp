@@ -0,0 +1,102 @@
+﻿#include "../include/AllocCounter.h"
+#include <cstdlib>
+#include <new>
+
+// 计数器是普通的 thread_local 整数，不需要构造，在 operator new 里使用是安全的
+static thread_local uint64_t threadAllocations = 0;
+static thread_local uint64_t threadBytes = 0;
+
+uint64_t AllocCounter::getThreadAllocations() {
+    return threadAllocations;
+}
+
+uint64_t AllocCounter::getThreadBytes() {
+    return threadBytes;
+}
+
+#if ENABLE_ALLOC_COUNTER
+
+namespace {
+    void* countedAlloc(size_t size) {
+        threadAllocations++;
+        threadBytes += size;
+        return malloc(size ? size : 1);
+    }
+
+    void* countedAlignedAlloc(size_t size, std::align_val_t align) {
+        threadAllocations++;
+        threadBytes += size;
+#ifdef _MSC_VER
+        return _aligned_malloc(size ? size : 1, (size_t)align);
+#else
+        size_t alignment = (size_t)align;
+        return aligned_alloc(alignment, ((size ? size : 1) + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void alignedFree(void* p) {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+}
+
+// --- 普通分配 ---
+void* operator new(size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+
+// --- 超对齐分配（alignas 大于默认对齐的类型）---
+void* operator new(size_t size, std::align_val_t align) {
+    void* p = countedAlignedAlloc(size, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    void* p = countedAlignedAlloc(size, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+
+#endif
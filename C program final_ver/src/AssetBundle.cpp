@@ -0,0 +1,147 @@
+﻿#include "../include/AssetBundle.h"
+#include <cstring>
+#include <fstream>
+
+// ============================================================
+// AssetBundleWriter 类方法的实现
+// ============================================================
+
+void AssetBundleWriter::addImage(const std::string& name, const DWORD* pixels, int width, int height) {
+    addEntry(name, ASSET_IMAGE, (uint32_t)width, (uint32_t)height,
+        pixels, (size_t)width * height * sizeof(DWORD));
+}
+
+void AssetBundleWriter::addPCM(const std::string& name, const int16_t* samples, size_t sampleCount,
+    unsigned channels, unsigned sampleRate) {
+    addEntry(name, ASSET_PCM, channels, sampleRate, samples, sampleCount * sizeof(int16_t));
+}
+
+void AssetBundleWriter::addEntry(const std::string& name, uint32_t type, uint32_t param0, uint32_t param1,
+    const void* data, size_t size) {
+    AssetEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    strncpy_s(entry.name, sizeof(entry.name), name.c_str(), _TRUNCATE);
+    entry.type = type;
+    entry.param0 = param0;
+    entry.param1 = param1;
+    entry.offset = blob.size();   // 先记相对偏移，写文件时再加上数据区起点
+    entry.size = size;
+
+    blob.insert(blob.end(), (const char*)data, (const char*)data + size);
+    // 每段数据按16字节对齐，方便映射后直接做 SIMD 读取
+    while (blob.size() % 16 != 0) {
+        blob.push_back(0);
+    }
+    entries.push_back(entry);
+}
+
+bool AssetBundleWriter::write(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    AssetBundleHeader header;
+    memcpy(header.magic, "FBPK", 4);
+    header.version = ASSET_BUNDLE_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.reserved = 0;
+
+    // 数据区紧跟在条目表之后，同样按16字节对齐
+    uint64_t dataStart = sizeof(AssetBundleHeader) + entries.size() * sizeof(AssetEntry);
+    uint64_t padding = (16 - dataStart % 16) % 16;
+    dataStart += padding;
+
+    file.write((const char*)&header, sizeof(header));
+    for (AssetEntry entry : entries) {
+        entry.offset += dataStart;
+        file.write((const char*)&entry, sizeof(entry));
+    }
+    for (uint64_t i = 0; i < padding; i++) {
+        file.put(0);
+    }
+    file.write(blob.data(), blob.size());
+
+    return file.good();
+}
+
+// ============================================================
+// AssetBundle 类方法的实现
+// ============================================================
+
+AssetBundle::AssetBundle()
+    : file(INVALID_HANDLE_VALUE), mapping(NULL), base(nullptr), fileSize(0),
+      header(nullptr), entries(nullptr) {
+}
+
+AssetBundle::~AssetBundle() {
+    close();
+}
+
+bool AssetBundle::open(const char* path) {
+    close();
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(AssetBundleHeader)) {
+        close();
+        return false;
+    }
+    fileSize = (uint64_t)size.QuadPart;
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    base = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        close();
+        return false;
+    }
+
+    // 校验文件头和条目表，防止损坏的资源包导致越界读取
+    header = (const AssetBundleHeader*)base;
+    if (memcmp(header->magic, "FBPK", 4) != 0 || header->version != ASSET_BUNDLE_VERSION ||
+        sizeof(AssetBundleHeader) + (uint64_t)header->entryCount * sizeof(AssetEntry) > fileSize) {
+        close();
+        return false;
+    }
+    entries = (const AssetEntry*)(base + sizeof(AssetBundleHeader));
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        // 分开比较，偏移或大小很大时 offset + size 会回绕成小数而通过检查
+        const AssetEntry& entry = entries[i];
+        bool valid = entry.offset <= fileSize && entry.size <= fileSize - entry.offset;
+        // 图片条目的数据必须正好是 宽 x 高 个 32 位像素，之后直接拷进同样大小的 IMAGE 缓冲区
+        if (entry.type == ASSET_IMAGE) {
+            valid = valid && entry.size == (uint64_t)entry.param0 * entry.param1 * sizeof(DWORD);
+        }
+        if (!valid) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetBundle::close() {
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+    base = nullptr;
+    fileSize = 0;
+    header = nullptr;
+    entries = nullptr;
+}
+
+const AssetEntry* AssetBundle::find(const char* name) const {
+    for (int i = 0; i < getEntryCount(); i++) {
+        if (strncmp(entries[i].name, name, sizeof(entries[i].name)) == 0) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
@@ -1,82 +1,133 @@
 ﻿// 因为 .cpp 在 src 文件夹，.h 在 include 文件夹
 // 所以需要 ../ 先跳出 src，再进入 include
-#include "../include/AudioManager.h" 
-#include <algorithm>
+#include "../include/AudioManager.h"
 #include <iostream>
 #include "../include/constants.h"
+#include "../include/Profiler.h"
 #include <SFML/Audio.hpp>
 
+// ============================================================
+// MixerStream 类方法的实现
+// ============================================================
+
+MixerStream::MixerStream(AudioMixer& m) : mixer(m) {
+    initialize(AudioMixer::CHANNELS, AudioMixer::SAMPLE_RATE,
+        { sf::SoundChannel::FrontLeft, sf::SoundChannel::FrontRight });
+}
+
+bool MixerStream::onGetData(Chunk& data) {
+    // 第一次回调时给音频线程起名，性能分析文件里和主线程分开显示
+    static thread_local bool threadNamed = false;
+    if (!threadNamed) {
+        Profiler::getInstance().setThreadName("Audio");
+        threadNamed = true;
+    }
+
+    PROFILE_SCOPE("AudioMixer::render");
+    mixer.render(chunk, CHUNK_FRAMES);
+    data.samples = chunk;
+    data.sampleCount = CHUNK_FRAMES * AudioMixer::CHANNELS;
+    return true;  // 混音器是无限长的流
+}
+
+void MixerStream::onSeek(sf::Time) {
+    // 实时混音输出不支持跳转
+}
+
+// ============================================================
+// AudioManager 类方法的实现
+// ============================================================
+
 AudioManager::AudioManager()
-    : masterVolume(100.0f), soundsVolume(100.0f), musicVolume(100.0f) {
+    : outputStream(mixer), currentMusicStream(0),
+      musicBufferFrames(MusicStream::DEFAULT_BUFFER_FRAMES), musicPlaying(false),
+      masterVolume(100.0f), soundsVolume(100.0f), musicVolume(100.0f) {
+    outputStream.play();
 }
 
 AudioManager::~AudioManager() {
     cleanup();
 }
 
-bool AudioManager::loadSoundEffect(const std::string& name, const std::string& filepath) {
+// 用 SFML 解码文件，再把 PCM 交给混音器保存；解码器缓冲区用完即释放
+bool AudioManager::loadSoundEffect(SoundId id, const std::string& filepath) {
+    if (id < 0 || id >= SOUND_COUNT) return false;
     sf::SoundBuffer buffer;
-    if (buffer.loadFromFile(filepath)) {
-        soundBuffers[name] = buffer;
-        return true;
-    }
-    return false;
+    if (!buffer.loadFromFile(filepath)) return false;
+    return mixer.loadClip(id, buffer.getSamples(), (size_t)buffer.getSampleCount(),
+        buffer.getChannelCount(), buffer.getSampleRate());
 }
 
-void AudioManager::playSound(const std::string& name, float volume, float pitch) {
-    cleanFinishedSounds();
-    auto it = soundBuffers.find(name);
-    if (it != soundBuffers.end()) {
-        // 直接在 emplace_back 的括号里传入 Buffer
-        // 直接调用 sf::Sound(const SoundBuffer&) 构造函数
-        activeSounds.emplace_back(it->second);
+bool AudioManager::loadSoundEffect(SoundId id, const int16_t* samples, size_t sampleCount,
+    unsigned channels, unsigned sampleRate) {
+    if (id < 0 || id >= SOUND_COUNT) return false;
+    return mixer.loadClip(id, samples, sampleCount, channels, sampleRate);
+}
 
-        sf::Sound& sound = activeSounds.back();
+void AudioManager::playSound(SoundId id, float volume) {
+    mixer.play(id, MIX_BUS_SFX, volume / 100.0f);
+}
 
-        // 注意：把原来的 sound.setBuffer(...) 那一行删掉，因为上面已经设置过了
+void AudioManager::startLoop(SoundId id, float volume) {
+    mixer.stopBus(MIX_BUS_UI);
+    mixer.play(id, MIX_BUS_UI, volume / 100.0f, true);
+}
 
-        float finalVolume = (masterVolume / 100.0f) * (soundsVolume / 100.0f) * volume;
-        sound.setVolume(finalVolume);
-        sound.setPitch(pitch);
-        sound.play();
-    }
+void AudioManager::stopLoop() {
+    mixer.stopBus(MIX_BUS_UI);
 }
 
+// 切换背景音乐：只启动新流的后台预读并发一条命令，不在调用线程上读盘或解码
 bool AudioManager::playMusic(const std::string& filepath, bool loop) {
-    if (backgroundMusic.openFromFile(filepath)) {
-        backgroundMusic.setLooping(loop);
-        backgroundMusic.setVolume(masterVolume * (musicVolume / 100.0f));
-        backgroundMusic.play();
-        return true;
-    }
-    return false;
+    int next = 1 - currentMusicStream;
+    MusicStream& stream = musicStreams[next];
+
+    // 混音线程还在读这个流（上一次切歌的命令还没生效，通常不超过一个音频块）时不能重新打开它
+    if (mixer.getActiveMusicStream() == &stream) return false;
+
+    if (!stream.open(filepath, loop, musicBufferFrames)) return false;
+
+    mixer.resumeBus(MIX_BUS_MUSIC);
+    mixer.setMusicStream(&stream);
+    currentMusicStream = next;
+    musicPlaying = true;
+    return true;
 }
 
-void AudioManager::stopMusic() { backgroundMusic.stop(); }
-void AudioManager::pauseMusic() { backgroundMusic.pause(); }
-void AudioManager::resumeMusic() { backgroundMusic.play(); }
+void AudioManager::stopMusic() { mixer.stopBus(MIX_BUS_MUSIC); musicPlaying = false; }
+// 暂停只是让混音器不再拉取数据，预读好的缓冲区原样保留，恢复时立即出声
+void AudioManager::pauseMusic() { mixer.pauseBus(MIX_BUS_MUSIC); musicPlaying = false; }
+void AudioManager::resumeMusic() { mixer.resumeBus(MIX_BUS_MUSIC); musicPlaying = true; }
 
-void AudioManager::setMasterVolume(float volume) { masterVolume = volume; }
-void AudioManager::setSoundsVolume(float volume) { soundsVolume = volume; }
-void AudioManager::setMusicVolume(float volume) { musicVolume = volume; }
+void AudioManager::setMasterVolume(float volume) {
+    masterVolume = volume;
+    mixer.setMasterVolume(volume / 100.0f);
+}
+
+void AudioManager::setSoundsVolume(float volume) {
+    soundsVolume = volume;
+    mixer.setBusVolume(MIX_BUS_SFX, volume / 100.0f);
+}
+
+void AudioManager::setMusicVolume(float volume) {
+    musicVolume = volume;
+    mixer.setBusVolume(MIX_BUS_MUSIC, volume / 100.0f);
+}
+
+void AudioManager::setMaxVoices(int count) { mixer.setVoiceLimit(count); }
 
 float AudioManager::getMasterVolume() const { return masterVolume; }
 float AudioManager::getSoundsVolume() const { return soundsVolume; }
 float AudioManager::getMusicVolume() const { return musicVolume; }
 
 bool AudioManager::isMusicPlaying() const {
-    return backgroundMusic.getStatus() == ::sf::SoundSource::Status::Playing;
-}
-
-void AudioManager::cleanFinishedSounds() {
-    activeSounds.erase(std::remove_if(activeSounds.begin(), activeSounds.end(),
-        [](const sf::Sound& s) { 
-            return s.getStatus() == ::sf::SoundSource::Status::Stopped;
-        }), activeSounds.end());
+    return musicPlaying;
 }
 
 void AudioManager::cleanup() {
-    backgroundMusic.stop();
-    activeSounds.clear();
-    soundBuffers.clear();
+    // 停止声卡流（会等待 SFML 的流线程退出），之后混音器不再被访问
+    outputStream.stop();
+    musicPlaying = false;
+    musicStreams[0].close();
+    musicStreams[1].close();
 }
\ No newline at end of file
@@ -0,0 +1,347 @@
+﻿#include "../include/AudioMixer.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MIXER_USE_SSE2 1
+#endif
+
+// ============================================================
+// SIMD 混音内核
+// ============================================================
+
+// 累加：dst[i] += src[i] * gain，每次处理4个采样
+void mixAccumulate(float* dst, const float* src, float gain, size_t count) {
+    size_t i = 0;
+#ifdef MIXER_USE_SSE2
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_loadu_ps(dst + i);
+        __m128 s = _mm_loadu_ps(src + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(s, g)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+// 输出：乘以总音量后转成 int16，超出范围的采样饱和截断
+void mixToInt16(int16_t* out, const float* src, float gain, size_t count) {
+    size_t i = 0;
+#ifdef MIXER_USE_SSE2
+    __m128 g = _mm_set1_ps(gain * 32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), g));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+        // packs 自带有符号饱和，正好完成 clamp 到 [-32768, 32767]
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; i++) {
+        float v = src[i] * gain * 32767.0f;
+        if (v > 32767.0f) v = 32767.0f;
+        if (v < -32768.0f) v = -32768.0f;
+        out[i] = (int16_t)(v >= 0 ? v + 0.5f : v - 0.5f);
+    }
+}
+
+// ============================================================
+// AudioMixer 类方法的实现
+// ============================================================
+
+AudioMixer::AudioMixer()
+    : nextStartOrder(0), musicStream(nullptr), activeStream(nullptr), masterVolume(1.0f), voiceLimit(MAX_VOICES),
+      activeVoiceCount(0), renderedFrames(0), renderNanos(0) {
+    for (int i = 0; i < MAX_CLIPS; i++) {
+        clipLoaded[i] = false;
+    }
+    for (int i = 0; i < MAX_VOICES; i++) {
+        voices[i].active = false;
+        voices[i].loop = false;
+        voices[i].clip = 0;
+        voices[i].bus = MIX_BUS_SFX;
+        voices[i].gain = 0.0f;
+        voices[i].position = 0;
+        voices[i].startOrder = 0;
+    }
+    for (int i = 0; i < MIX_BUS_COUNT; i++) {
+        busPaused[i] = false;
+        busVolume[i].store(1.0f);
+    }
+    memset(mixBuffer, 0, sizeof(mixBuffer));
+    memset(streamBuffer, 0, sizeof(streamBuffer));
+}
+
+// 加载音频片段：声道统一成立体声，采样率不同时做线性插值重采样
+// 只在启动阶段调用，所以这里的分配和转换不影响播放路径
+bool AudioMixer::loadClip(int clipId, const int16_t* samples, size_t sampleCount,
+    unsigned channels, unsigned sampleRate) {
+    if (clipId < 0 || clipId >= MAX_CLIPS) return false;
+    if (!samples || channels == 0 || sampleRate == 0) return false;
+
+    size_t srcFrames = sampleCount / channels;
+    if (srcFrames == 0) return false;
+
+    double step = (double)sampleRate / SAMPLE_RATE;
+    size_t dstFrames = (size_t)(srcFrames / step);
+    if (dstFrames == 0) dstFrames = 1;
+
+    std::vector<float>& clip = clips[clipId];
+    clip.resize(dstFrames * CHANNELS);
+
+    for (size_t f = 0; f < dstFrames; f++) {
+        double srcPos = f * step;
+        size_t i0 = (size_t)srcPos;
+        size_t i1 = (i0 + 1 < srcFrames) ? i0 + 1 : i0;
+        float t = (float)(srcPos - i0);
+
+        for (int c = 0; c < CHANNELS; c++) {
+            // 单声道复制到两个声道；多于两个声道只取前两个
+            unsigned sc = (channels == 1) ? 0 : (unsigned)c;
+            float a = samples[i0 * channels + sc] / 32768.0f;
+            float b = samples[i1 * channels + sc] / 32768.0f;
+            clip[f * CHANNELS + c] = a + (b - a) * t;
+        }
+    }
+
+    clipLoaded[clipId] = true;
+    return true;
+}
+
+bool AudioMixer::isClipLoaded(int clipId) const {
+    return clipId >= 0 && clipId < MAX_CLIPS && clipLoaded[clipId];
+}
+
+bool AudioMixer::play(int clipId, MixBus bus, float gain, bool loop) {
+    if (!isClipLoaded(clipId)) return false;
+
+    MixCommand cmd;
+    cmd.type = MIX_CMD_PLAY;
+    cmd.clip = clipId;
+    cmd.bus = bus;
+    cmd.gain = gain;
+    cmd.loop = loop;
+    cmd.stream = nullptr;
+    return commandQueue.push(cmd);
+}
+
+void AudioMixer::stopBus(MixBus bus) {
+    MixCommand cmd = { MIX_CMD_STOP_BUS, 0, bus, 0.0f, false, nullptr };
+    commandQueue.push(cmd);
+}
+
+void AudioMixer::pauseBus(MixBus bus) {
+    MixCommand cmd = { MIX_CMD_PAUSE_BUS, 0, bus, 0.0f, false, nullptr };
+    commandQueue.push(cmd);
+}
+
+void AudioMixer::resumeBus(MixBus bus) {
+    MixCommand cmd = { MIX_CMD_RESUME_BUS, 0, bus, 0.0f, false, nullptr };
+    commandQueue.push(cmd);
+}
+
+void AudioMixer::setMusicStream(MixStreamSource* stream) {
+    MixCommand cmd = { MIX_CMD_SET_STREAM, 0, MIX_BUS_MUSIC, 0.0f, false, stream };
+    commandQueue.push(cmd);
+}
+
+void AudioMixer::setBusVolume(MixBus bus, float volume) {
+    busVolume[bus].store(volume, std::memory_order_relaxed);
+}
+
+void AudioMixer::setMasterVolume(float volume) {
+    masterVolume.store(volume, std::memory_order_relaxed);
+}
+
+float AudioMixer::getBusVolume(MixBus bus) const {
+    return busVolume[bus].load(std::memory_order_relaxed);
+}
+
+float AudioMixer::getMasterVolume() const {
+    return masterVolume.load(std::memory_order_relaxed);
+}
+
+void AudioMixer::setVoiceLimit(int limit) {
+    if (limit < 1) limit = 1;
+    if (limit > MAX_VOICES) limit = MAX_VOICES;
+    voiceLimit.store(limit, std::memory_order_relaxed);
+}
+
+int AudioMixer::getVoiceLimit() const {
+    return voiceLimit.load(std::memory_order_relaxed);
+}
+
+double AudioMixer::getMicrosPerSecondOfAudio() const {
+    uint64_t frames = renderedFrames.load(std::memory_order_relaxed);
+    if (frames == 0) return 0.0;
+    double seconds = (double)frames / SAMPLE_RATE;
+    return renderNanos.load(std::memory_order_relaxed) / 1000.0 / seconds;
+}
+
+// 分配声部：上限范围内有空闲声部就用空闲的；全部在发声时，
+// 抢占开始得最早的非循环声部。循环声部（音乐）不会被抢占
+int AudioMixer::allocateVoice(int limit) {
+    int oldest = -1;
+    for (int v = 0; v < limit; v++) {
+        if (!voices[v].active) return v;
+        if (!voices[v].loop && (oldest < 0 || voices[v].startOrder < voices[oldest].startOrder)) {
+            oldest = v;
+        }
+    }
+    return oldest;  // 全部是循环声部时为 -1，放弃这次播放
+}
+
+void AudioMixer::startVoice(const MixCommand& cmd) {
+    int limit = voiceLimit.load(std::memory_order_relaxed);
+    int v = allocateVoice(limit);
+    if (v < 0) return;
+
+    Voice& voice = voices[v];
+    voice.active = true;
+    voice.loop = cmd.loop;
+    voice.clip = cmd.clip;
+    voice.bus = cmd.bus;
+    voice.gain = cmd.gain;
+    voice.position = 0;
+    voice.startOrder = nextStartOrder++;
+}
+
+void AudioMixer::drainCommands() {
+    MixCommand cmd;
+    while (commandQueue.pop(cmd)) {
+        switch (cmd.type) {
+        case MIX_CMD_PLAY:
+            startVoice(cmd);
+            break;
+        case MIX_CMD_STOP_BUS:
+            for (auto& voice : voices) {
+                if (voice.bus == cmd.bus) voice.active = false;
+            }
+            if (cmd.bus == MIX_BUS_MUSIC) musicStream = nullptr;
+            busPaused[cmd.bus] = false;
+            break;
+        case MIX_CMD_SET_STREAM:
+            musicStream = cmd.stream;
+            break;
+        case MIX_CMD_PAUSE_BUS:
+            busPaused[cmd.bus] = true;
+            break;
+        case MIX_CMD_RESUME_BUS:
+            busPaused[cmd.bus] = false;
+            break;
+        }
+    }
+    activeStream.store(musicStream, std::memory_order_release);
+}
+
+// 混音主流程：处理命令 -> 按块累加所有声部和音乐流 -> 乘总音量转 int16
+void AudioMixer::render(int16_t* out, size_t frames) {
+    auto start = std::chrono::steady_clock::now();
+
+    drainCommands();
+
+    float busGain[MIX_BUS_COUNT];
+    for (int b = 0; b < MIX_BUS_COUNT; b++) {
+        busGain[b] = busPaused[b] ? 0.0f : busVolume[b].load(std::memory_order_relaxed);
+    }
+    float master = masterVolume.load(std::memory_order_relaxed);
+
+    size_t done = 0;
+    while (done < frames) {
+        size_t block = frames - done;
+        if (block > MAX_BLOCK_FRAMES) block = MAX_BLOCK_FRAMES;
+
+        memset(mixBuffer, 0, block * CHANNELS * sizeof(float));
+
+        for (auto& voice : voices) {
+            if (!voice.active || busPaused[voice.bus]) continue;
+
+            const std::vector<float>& clip = clips[voice.clip];
+            size_t clipFrames = clip.size() / CHANNELS;
+            float gain = voice.gain * busGain[voice.bus];
+
+            size_t written = 0;
+            while (written < block && voice.active) {
+                size_t n = clipFrames - voice.position;
+                if (n > block - written) n = block - written;
+
+                mixAccumulate(mixBuffer + written * CHANNELS,
+                    clip.data() + voice.position * CHANNELS, gain, n * CHANNELS);
+
+                written += n;
+                voice.position += n;
+                if (voice.position >= clipFrames) {
+                    if (voice.loop) voice.position = 0;
+                    else voice.active = false;
+                }
+            }
+        }
+
+        // 音乐流：暂停时不拉取数据，预读好的缓冲保持不动，恢复时立即有声
+        if (musicStream && !busPaused[MIX_BUS_MUSIC]) {
+            size_t n = musicStream->read(streamBuffer, block);
+            mixAccumulate(mixBuffer, streamBuffer, busGain[MIX_BUS_MUSIC], n * CHANNELS);
+        }
+
+        mixToInt16(out + done * CHANNELS, mixBuffer, master, block * CHANNELS);
+        done += block;
+    }
+
+    int active = 0;
+    for (const auto& voice : voices) {
+        if (voice.active) active++;
+    }
+    activeVoiceCount.store(active, std::memory_order_relaxed);
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    renderNanos.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+        std::memory_order_relaxed);
+    renderedFrames.fetch_add(frames, std::memory_order_relaxed);
+}
+
+// 写 WAV 文件头中的小端整数
+static void writeLE(std::ofstream& file, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        file.put((char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+bool AudioMixer::renderToWav(const char* path, float seconds,
+    const std::function<void(uint64_t frame)>& beforeBlock) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint32_t totalFrames = (uint32_t)(seconds * SAMPLE_RATE);
+    uint32_t dataBytes = totalFrames * CHANNELS * sizeof(int16_t);
+
+    // RIFF/WAVE 文件头（PCM，16位，立体声）
+    file.write("RIFF", 4);
+    writeLE(file, 36 + dataBytes, 4);
+    file.write("WAVE", 4);
+    file.write("fmt ", 4);
+    writeLE(file, 16, 4);                                   // fmt 块大小
+    writeLE(file, 1, 2);                                    // PCM
+    writeLE(file, CHANNELS, 2);
+    writeLE(file, SAMPLE_RATE, 4);
+    writeLE(file, SAMPLE_RATE * CHANNELS * sizeof(int16_t), 4);  // 字节率
+    writeLE(file, CHANNELS * sizeof(int16_t), 2);           // 块对齐
+    writeLE(file, 16, 2);                                   // 位深
+    file.write("data", 4);
+    writeLE(file, dataBytes, 4);
+
+    int16_t block[MAX_BLOCK_FRAMES * CHANNELS];
+    uint32_t remaining = totalFrames;
+    while (remaining > 0) {
+        uint32_t n = remaining < (uint32_t)MAX_BLOCK_FRAMES ? remaining : (uint32_t)MAX_BLOCK_FRAMES;
+        if (beforeBlock) beforeBlock(totalFrames - remaining);
+        render(block, n);
+        // WAV 采样是小端序，x86/x64 下可以直接写出
+        file.write((const char*)block, n * CHANNELS * sizeof(int16_t));
+        remaining -= n;
+    }
+
+    return file.good();
+}
@@ -0,0 +1,146 @@
+﻿#include "../include/Autopilot.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+Autopilot::Autopilot()
+    : budgetMicros(AUTOPILOT_BUDGET_MICROS), windowNodes(0), windowSearchNs(0), windowDecisions(0),
+      windowSearches(0), nodesPerSecond(0), averageSearchMicros(0), budgetOverruns(0) {
+    reset();
+}
+
+void Autopilot::reset() {
+    memset(plan, 0, sizeof(plan));
+    planLength = 0;
+    planSurvival = 0;
+    ticksSinceSearch = AUTOPILOT_REPLAN_TICKS;
+}
+
+bool Autopilot::decide(const SimState& state) {
+    int64_t start = nowNs();
+    int64_t deadline = start + (int64_t)budgetMicros * 1000;
+
+    // 上一帧的计划向前平移一帧，接着用
+    if (planLength > 0) {
+        memmove(plan, plan + 1, planLength - 1);
+        planLength--;
+    }
+    ticksSinceSearch++;
+
+    // 旧计划在整个视野内都能存活，并且刚规划过不久，就不必搜索
+    planSurvival = evaluatePlan(state, plan, planLength);
+    if (planSurvival < AUTOPILOT_HORIZON_TICKS || ticksSinceSearch >= AUTOPILOT_REPLAN_TICKS) {
+        int newLength = search(state, deadline);
+        int newSurvival = evaluatePlan(state, searchPlan, newLength);
+        // 新计划至少和旧计划一样好才替换（超时的搜索可能不如旧计划）
+        if (newSurvival >= planSurvival) {
+            memcpy(plan, searchPlan, newLength);
+            planLength = newLength;
+            planSurvival = newSurvival;
+        }
+        ticksSinceSearch = 0;
+        windowSearches++;
+    }
+
+    windowSearchNs += nowNs() - start;
+    if (++windowDecisions >= (int)FPS) {
+        nodesPerSecond = windowSearchNs > 0 ? windowNodes * 1e9 / windowSearchNs : 0;
+        averageSearchMicros = windowSearchNs / 1000.0 / windowDecisions;
+        windowNodes = 0;
+        windowSearchNs = 0;
+        windowDecisions = 0;
+        windowSearches = 0;
+    }
+
+    return planLength > 0 && plan[0] != 0;
+}
+
+int Autopilot::evaluatePlan(const SimState& state, const uint8_t* actions, int length) {
+    SimState s = state;
+    int t = 0;
+    for (; t < AUTOPILOT_HORIZON_TICKS; t++) {
+        Simulation::step(s, t < length && actions[t]);
+        if (!s.alive) break;
+    }
+    windowNodes += t + 1;
+    return t;
+}
+
+// 局面评分：越接近下一根管道的间隙中心越好，吃到硬币加分
+float Autopilot::heuristic(const SimState& s) const {
+    const SimPipe* next = Simulation::getNextPipe(s, 0);
+    float target = next ? next->gapY : (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f;
+    return -fabsf(s.birdY - target) + s.coins * 3.0f;
+}
+
+int Autopilot::search(const SimState& root, int64_t deadlineNs) {
+    beam[0] = root;
+    int beamCount = 1;
+    int completedDepth = 0;   // 已经完整搜索的层数
+
+    for (int d = 0; d < DEPTH; d++) {
+        // 展开：每个局面分别尝试"跳"和"不跳"
+        int count = 0;
+        for (int b = 0; b < beamCount; b++) {
+            for (int a = 0; a < 2; a++) {
+                SimState& s = candidates[count];
+                s = beam[b];
+                Simulation::step(s, a != 0);
+                for (int k = 1; k < AUTOPILOT_TICKS_PER_STEP && s.alive; k++) {
+                    Simulation::step(s, false);
+                }
+                windowNodes += AUTOPILOT_TICKS_PER_STEP;
+                if (!s.alive) continue;
+
+                candidateScore[count] = heuristic(s);
+                candidateOrigin[count] = b * 2 + a;
+                count++;
+            }
+        }
+        if (count == 0) break;   // 所有分支都死了，用上一层的结果
+
+        // 按评分排序，跳过和已选局面几乎相同的（保持束的多样性）
+        int* order = candidateOrder;
+        for (int i = 0; i < count; i++) order[i] = i;
+        std::sort(order, order + count, [this](int x, int y) { return candidateScore[x] > candidateScore[y]; });
+
+        int selected = 0;
+        for (int i = 0; i < count && selected < AUTOPILOT_BEAM_WIDTH; i++) {
+            const SimState& s = candidates[order[i]];
+            bool duplicate = false;
+            for (int j = 0; j < selected && !duplicate; j++) {
+                duplicate = (int)beam[j].birdY == (int)s.birdY &&
+                    (int)(beam[j].birdVelocity * 2) == (int)(s.birdVelocity * 2);
+            }
+            if (duplicate) continue;
+            int origin = candidateOrigin[order[i]];
+            parent[d][selected] = (uint8_t)(origin / 2);
+            action[d][selected] = (uint8_t)(origin % 2);
+            beam[selected++] = s;
+        }
+        beamCount = selected;
+        completedDepth = d + 1;
+
+        if (nowNs() >= deadlineNs) {
+            if (d + 1 < DEPTH) budgetOverruns++;
+            break;
+        }
+    }
+
+    // 从最后一层最好的局面（排序后第0个）沿父节点回溯出动作序列
+    memset(searchPlan, 0, sizeof(searchPlan));
+    int slot = 0;
+    for (int d = completedDepth - 1; d >= 0; d--) {
+        searchPlan[d * AUTOPILOT_TICKS_PER_STEP] = action[d][slot];
+        slot = parent[d][slot];
+    }
+    return completedDepth * AUTOPILOT_TICKS_PER_STEP;
+}
@@ -0,0 +1,111 @@
+﻿#include "../include/Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const int MIN_SAMPLES = 5;
+    const int MAX_SAMPLES = 200;
+    const int64_t TARGET_SAMPLE_NS = 10000000;   // 每个样本约10毫秒，远大于计时器精度
+    const int64_t WARMUP_NS = 100000000;         // 预热0.1秒
+
+    // 双侧95% t 分布临界值，自由度1~30；更大时用1.96
+    double studentT95(int degrees) {
+        static const double table[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        if (degrees < 1) return 0;
+        if (degrees <= 30) return table[degrees - 1];
+        return 1.96;
+    }
+}
+
+BenchmarkSuite::BenchmarkSuite(double secondsPerBenchmark)
+    : secondsPerBenchmark(secondsPerBenchmark) {
+}
+
+int64_t BenchmarkSuite::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void BenchmarkSuite::run(const std::string& name, long long param, const std::function<void()>& body,
+    const std::function<void()>& setup, long long itersPerSample) {
+    // 计时一个样本（setup 不计入）
+    auto timeSample = [&](long long iters) {
+        if (setup) setup();
+        int64_t start = nowNs();
+        for (long long i = 0; i < iters; i++) {
+            body();
+        }
+        return nowNs() - start;
+    };
+
+    // 预热，同时估计单次调用耗时，用来决定每个样本调用多少次
+    long long iters = setup ? itersPerSample : 1;
+    int64_t warmupStart = nowNs();
+    int64_t elapsed = 0;
+    do {
+        elapsed = timeSample(iters);
+        if (!setup && elapsed < TARGET_SAMPLE_NS) {
+            iters = elapsed > 0 ? std::max(iters * 2, iters * TARGET_SAMPLE_NS / elapsed) : iters * 2;
+        }
+    } while (nowNs() - warmupStart < WARMUP_NS && (setup || elapsed < TARGET_SAMPLE_NS));
+
+    // 在时间预算内采样
+    std::vector<double> perCall;
+    int64_t budgetEnd = nowNs() + (int64_t)(secondsPerBenchmark * 1e9);
+    while ((int)perCall.size() < MIN_SAMPLES ||
+        ((int)perCall.size() < MAX_SAMPLES && nowNs() < budgetEnd)) {
+        perCall.push_back((double)timeSample(iters) / iters);
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.param = param;
+    result.samples = (int)perCall.size();
+    result.iterations = iters;
+
+    double sum = 0;
+    for (double v : perCall) sum += v;
+    result.meanNs = sum / perCall.size();
+
+    double squares = 0;
+    for (double v : perCall) squares += (v - result.meanNs) * (v - result.meanNs);
+    result.stddevNs = std::sqrt(squares / (perCall.size() - 1));
+    result.ci95Ns = studentT95((int)perCall.size() - 1) * result.stddevNs / std::sqrt((double)perCall.size());
+
+    std::sort(perCall.begin(), perCall.end());
+    result.minNs = perCall.front();
+    result.medianNs = perCall[perCall.size() / 2];
+
+    std::cout << name;
+    if (param) std::cout << " [" << param << "]";
+    std::cout << ": " << result.meanNs << " ns +/- " << result.ci95Ns
+        << " (median " << result.medianNs << ", " << result.samples << " samples x "
+        << result.iterations << ")" << std::endl;
+
+    results.push_back(result);
+}
+
+bool BenchmarkSuite::writeJson(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "{\n  \"unit\": \"ns_per_call\",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        file << "    {\"name\": \"" << r.name << "\", \"param\": " << r.param
+            << ", \"samples\": " << r.samples << ", \"iterations\": " << r.iterations
+            << ", \"mean\": " << r.meanNs << ", \"stddev\": " << r.stddevNs
+            << ", \"ci95\": " << r.ci95Ns << ", \"min\": " << r.minNs
+            << ", \"median\": " << r.medianNs << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+    return file.good();
+}
@@ -1,4 +1,6 @@
 #include "../include/bird.h"
+#include "../include/FrameArena.h"
+#include "../include/RenderList.h"
 #include <cmath>
 #include <string>
 
@@ -63,6 +65,23 @@ void Bird::update(float deltaTime) {
     }
 }
 
+// 恢复倒带缓冲里保存的状态
+void Bird::restore(float savedY, float savedVelocity, float savedComboTime, int savedComboCount, int savedMultiplier) {
+    y = savedY;
+    velocity = savedVelocity;
+    comboTime = savedComboTime;
+    comboCount = savedComboCount;
+    scoreMultiplier = savedMultiplier;
+    alive = true;
+    color = COLOR_BIRD_BODY;          // 撤销 kill() 的灰色
+    wingAngle = 0;                    // 翅膀从新的扇动周期开始
+
+    // 与 update 中的计算一致
+    rotation = velocity * 3;
+    if (rotation > 30) rotation = 30;
+    if (rotation < -30) rotation = -30;
+}
+
 // 跳跃方法：给小鸟一个向上的速度
 void Bird::jump() {
     if (alive) {                  // 只有存活的小鸟才能跳跃
@@ -73,68 +92,69 @@ void Bird::jump() {
 
 // 绘制方法：绘制小鸟的所有部分
 void Bird::draw() const {
+    RenderList& canvas = RenderList::getInstance();
     if (!alive) return;  // 如果小鸟死亡，不进行绘制
 
-    setlinestyle(PS_SOLID, 2);  // 设置线条样式为实线，宽度2像素
+    canvas.setLineStyle(PS_SOLID, 2);  // 设置线条样式为实线，宽度2像素
 
     // 绘制小鸟身体（主圆形）
-    setfillcolor(color);  // 设置填充颜色为小鸟身体颜色
+    canvas.setFillColor(color);  // 设置填充颜色为小鸟身体颜色
     // 设置边框颜色为身体颜色的80%（稍暗）
-    setlinecolor(RGB(GetRValue(color) * 0.8,
+    canvas.setLineColor(RGB(GetRValue(color) * 0.8,
         GetGValue(color) * 0.8,
         GetBValue(color) * 0.8));
-    solidcircle((int)x, (int)y, radius);  // 绘制实心圆作为身体
+    canvas.solidCircle((int)x, (int)y, radius);  // 绘制实心圆作为身体
 
     // 绘制小鸟翅膀（动态扇动效果）
     float wingOffset = sin(wingAngle * 4) * 5;  // 使用正弦函数计算翅膀偏移
-    setfillcolor(COLOR_BIRD_WING);              // 设置翅膀颜色
+    canvas.setFillColor(COLOR_BIRD_WING);              // 设置翅膀颜色
     // 绘制翅膀圆形（位置在身体左下方，随wingOffset动态移动）
-    solidcircle((int)(x - radius * 0.7),
+    canvas.solidCircle((int)(x - radius * 0.7),
         (int)(y + wingOffset),
         (int)(radius * 0.8));
 
     // 绘制小鸟眼睛（白色眼白和黑色瞳孔）
-    setfillcolor(COLOR_BIRD_EYE);  // 白色眼白
-    solidcircle((int)(x + radius * 0.5),  // 眼睛在身体右上方
+    canvas.setFillColor(COLOR_BIRD_EYE);  // 白色眼白
+    canvas.solidCircle((int)(x + radius * 0.5),  // 眼睛在身体右上方
         (int)(y - radius * 0.3),
         (int)(radius * 0.4));
 
-    setfillcolor(RGB(0, 0, 0));  // 黑色瞳孔
-    solidcircle((int)(x + radius * 0.7),  // 瞳孔在眼白右上方
+    canvas.setFillColor(RGB(0, 0, 0));  // 黑色瞳孔
+    canvas.solidCircle((int)(x + radius * 0.7),  // 瞳孔在眼白右上方
         (int)(y - radius * 0.3),
         (int)(radius * 0.2));
 
     // 绘制眼睛高光（小白色圆形，增加立体感）
-    setfillcolor(COLOR_BIRD_EYE);  // 白色高光
-    solidcircle((int)(x + radius * 0.65),
+    canvas.setFillColor(COLOR_BIRD_EYE);  // 白色高光
+    canvas.solidCircle((int)(x + radius * 0.65),
         (int)(y - radius * 0.35),
         (int)(radius * 0.08));
 
     // 绘制小鸟喙（橙色三角形）
-    setfillcolor(COLOR_BIRD_BEAK);  // 喙的颜色
+    canvas.setFillColor(COLOR_BIRD_BEAK);  // 喙的颜色
     // 定义喙的三个顶点坐标（三角形）
-    POINT beak[3] = {
+    FrameVector<POINT> beak = {
         {(int)(x + radius), (int)y},          // 顶点1：身体右侧中间
         {(int)(x + radius + 20), (int)(y - 7)}, // 顶点2：向右上延伸
         {(int)(x + radius + 20), (int)(y + 7)}  // 顶点3：向右下延伸
     };
-    solidpolygon(beak, 3);  // 绘制实心三角形
+    canvas.solidPolygon(beak.data(), 3);  // 绘制实心三角形
 
     // 绘制小鸟脸颊（粉色圆形，增加可爱感）
-    setfillcolor(RGB(255, 182, 193));  // 浅粉色
-    setlinecolor(RGB(255, 182, 193));  // 边框同样颜色
-    solidcircle((int)(x + radius * 0.2),  // 脸颊在身体右下方
+    canvas.setFillColor(RGB(255, 182, 193));  // 浅粉色
+    canvas.setLineColor(RGB(255, 182, 193));  // 边框同样颜色
+    canvas.solidCircle((int)(x + radius * 0.2),  // 脸颊在身体右下方
         (int)(y + radius * 0.4),
         (int)(radius * 0.3));
 
     // 绘制小鸟尾巴（三角形）
-    POINT tail[4] = {
+    FrameVector<POINT> tail = {
         {(int)(x - radius), (int)y},          // 起点：身体左侧中间
         {(int)(x - radius - 15), (int)(y - 8)}, // 向左上延伸
         {(int)(x - radius - 15), (int)(y + 8)}, // 向左下延伸
         {(int)(x - radius), (int)y}           // 回到起点（形成闭合）
     };
-    solidpolygon(tail, 4);  // 绘制实心四边形（三角形加一个点）
+    canvas.solidPolygon(tail.data(), 4);  // 绘制实心四边形（三角形加一个点）
 
     // 如果有连击效果，绘制连击显示
     if (comboTime > 0) {
@@ -144,21 +164,21 @@ void Bird::draw() const {
 
 // 绘制连击效果：在小鸟上方显示连击信息
 void Bird::drawComboEffect() const {
-    wchar_t wcomboText[20];  // 宽字符数组（Windows图形库需要宽字符）
-    // 将多字节字符串转换为宽字符字符串
-    swprintf_s(wcomboText, 20, L"COMBO x%d", comboCount);
+    RenderList& canvas = RenderList::getInstance();
+    // 格式化到帧内存（Windows图形库需要宽字符）
+    const wchar_t* wcomboText = FrameArena::getInstance().format(L"COMBO x%d", comboCount);
 
     // 获取文本的宽度和高度（用于居中显示）
-    int textWidth = textwidth(wcomboText);
-    int textHeight = textheight(wcomboText);
+    int textWidth = canvas.textWidth(wcomboText);
+    int textHeight = canvas.textHeight(wcomboText);
 
     // 设置连击文本的样式
-    settextstyle(16, 0, _T("Arial"));  // 16号Arial字体
-    settextcolor(RGB(255, 215, 0));    // 金色文字
-    setbkmode(TRANSPARENT);            // 透明背景
+    canvas.setTextStyle(16, 0, _T("Arial"));  // 16号Arial字体
+    canvas.setTextColor(RGB(255, 215, 0));    // 金色文字
+    canvas.setBkMode(TRANSPARENT);            // 透明背景
 
     // 在小鸟上方显示连击文本（居中）
-    outtextxy((int)x - textWidth / 2,          // X坐标：小鸟X坐标减去一半文字宽度
+    canvas.outText((int)x - textWidth / 2,          // X坐标：小鸟X坐标减去一半文字宽度
         (int)y - radius - textHeight - 5, // Y坐标：小鸟上方（减去半径和文字高度）
         wcomboText);                      // 要显示的文本
 }
@@ -0,0 +1,137 @@
+﻿#include "../include/CloudLayers.h"
+#include "../include/GameRules.h"
+#include "../include/RenderList.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // 每层的样式：由远到近
+    struct LayerStyle {
+        float speed;            // 每帧移动的像素
+        int minSprite, maxSprite;
+        float opacity;          // 乘在每朵云自己的透明度上
+        int maxY;               // 云朵中心的最大高度
+    };
+
+    const LayerStyle LAYER_STYLES[CLOUD_LAYER_COUNT] = {
+        { 0.2f, 0, 1, 0.55f, 140 },
+        { 0.4f, 1, 2, 0.75f, 170 },
+        { 0.7f, 2, 3, 1.00f, 200 }
+    };
+
+    // 各层速度都是 0.1 的整数倍，滚动量每 CLOUD_LAYER_PERIOD * 10 回绕一次，所有层的截取位置不变
+    const float SCROLL_WRAP = CLOUD_LAYER_PERIOD * 10.0f;
+}
+
+CloudLayers::CloudLayers() : scroll(0), cloudCount(0) {
+    const int radii[CLOUD_SPRITE_SIZES] = { 22, 32, 44, 58 };   // 原来的云朵大小为 20~59
+    for (int i = 0; i < CLOUD_SPRITE_SIZES; i++) {
+        spriteRadius[i] = radii[i];
+    }
+    buildSprites();
+}
+
+// 云朵的形状与原来的 Cloud::draw 相同：主圆 + 右上、右、左下三个圆。
+// 覆盖率按像素中心到圆边的距离计算（半像素宽的抗锯齿），下半部分略微变灰，显得有厚度
+void CloudLayers::buildSprites() {
+    for (int i = 0; i < CLOUD_SPRITE_SIZES; i++) {
+        const float r = (float)spriteRadius[i];
+        const float circles[4][3] = {
+            { 0, 0, r },
+            { r * 0.6f, -r * 0.3f, r * 0.7f },
+            { r * 1.2f, 0, r * 0.5f },
+            { -r * 0.4f, r * 0.3f, r * 0.6f }
+        };
+
+        // 云朵中心在图中的 (r + 1, r + 1)；左右范围 -r ~ 1.7r，上下范围 -r ~ r
+        const int origin = spriteRadius[i] + 1;
+        const int width = (int)ceilf(r * 2.7f) + 3;
+        const int height = spriteRadius[i] * 2 + 3;
+        sprites[i].Resize(width, height);
+        DWORD* pixels = GetImageBuffer(&sprites[i]);
+
+        for (int py = 0; py < height; py++) {
+            float dy = py + 0.5f - origin;
+            int shade = 255 - (int)(std::max(0.0f, dy) / r * 30);
+            for (int px = 0; px < width; px++) {
+                float dx = px + 0.5f - origin;
+                float coverage = 0;
+                for (const auto& c : circles) {
+                    float distance = sqrtf((dx - c[0]) * (dx - c[0]) + (dy - c[1]) * (dy - c[1]));
+                    coverage = std::max(coverage, std::min(1.0f, std::max(0.0f, c[2] - distance + 0.5f)));
+                }
+                DWORD alpha = (DWORD)(coverage * 255 + 0.5f);
+                DWORD value = (DWORD)(shade * coverage + 0.5f);
+                pixels[py * width + px] = (alpha << 24) | (value << 16) | (value << 8) | value;
+            }
+        }
+    }
+}
+
+void CloudLayers::build(int count, uint32_t seed) {
+    uint32_t rng = seed ? seed : 0x9E3779B9u;
+    const int layerWidth = SCREEN_WIDTH + CLOUD_LAYER_PERIOD;
+    // 一个周期比一屏宽，云朵数按比例增加，保持屏幕上的密度
+    const int perLayer = (count * CLOUD_LAYER_PERIOD / SCREEN_WIDTH + CLOUD_LAYER_COUNT - 1) / CLOUD_LAYER_COUNT;
+
+    cloudCount = 0;
+    for (int l = 0; l < CLOUD_LAYER_COUNT; l++) {
+        const LayerStyle& style = LAYER_STYLES[l];
+        IMAGE& layer = layers[l];
+        layer.Resize(layerWidth, CLOUD_BAND_HEIGHT);
+        memset(GetImageBuffer(&layer), 0, sizeof(DWORD) * layerWidth * CLOUD_BAND_HEIGHT);
+
+        for (int i = 0; i < perLayer; i++) {
+            int sprite = style.minSprite + (int)(nextRandom(rng) % (style.maxSprite - style.minSprite + 1));
+            int x = (int)(nextRandom(rng) % CLOUD_LAYER_PERIOD);
+            int y = (int)(nextRandom(rng) % style.maxY);
+            int alpha = 150 + (int)(nextRandom(rng) % 100);     // 原来的 alpha 范围，现在真正参与混合
+            float opacity = alpha / 255.0f * style.opacity;
+
+            // 每朵云在相隔一个周期的位置各画一次，层条上任意一屏宽的截取都是无缝的
+            int origin = spriteRadius[sprite] + 1;
+            for (int k = -1; k <= 2; k++) {
+                composite(layer, sprites[sprite], x + k * CLOUD_LAYER_PERIOD - origin, y - origin, opacity);
+            }
+        }
+        cloudCount += perLayer;
+    }
+}
+
+// 预乘 alpha 的 over 合成：dst = src * opacity + dst * (1 - srcAlpha * opacity)
+void CloudLayers::composite(IMAGE& layer, const IMAGE& sprite, int x, int y, float opacity) {
+    DWORD* dst = GetImageBuffer(&layer);
+    const DWORD* src = GetImageBuffer(const_cast<IMAGE*>(&sprite));
+    const int layerW = layer.getwidth(), layerH = layer.getheight();
+    const int spriteW = sprite.getwidth(), spriteH = sprite.getheight();
+    const int scale = (int)(opacity * 256 + 0.5f);
+
+    for (int sy = std::max(0, -y); sy < spriteH && y + sy < layerH; sy++) {
+        for (int sx = std::max(0, -x); sx < spriteW && x + sx < layerW; sx++) {
+            DWORD s = src[sy * spriteW + sx];
+            if (!(s >> 24)) continue;
+
+            DWORD& d = dst[(y + sy) * layerW + x + sx];
+            DWORD result = 0;
+            DWORD inverse = 255 - (((s >> 24) * scale) >> 8);
+            for (int shift = 0; shift < 32; shift += 8) {
+                DWORD channel = ((((s >> shift) & 0xFF) * scale) >> 8) + (((d >> shift) & 0xFF) * inverse + 127) / 255;
+                result |= std::min<DWORD>(channel, 255) << shift;
+            }
+            d = result;
+        }
+    }
+}
+
+void CloudLayers::update(float deltaTime) {
+    scroll = fmodf(scroll + deltaTime * 60, SCROLL_WRAP);   // 乘以60换算成每帧的像素，与原来的云朵相同
+}
+
+void CloudLayers::draw() const {
+    RenderList& canvas = RenderList::getInstance();
+    for (int l = 0; l < CLOUD_LAYER_COUNT; l++) {
+        int offset = (int)fmodf(scroll * LAYER_STYLES[l].speed, (float)CLOUD_LAYER_PERIOD);
+        canvas.blendImage(0, 0, SCREEN_WIDTH, CLOUD_BAND_HEIGHT, &layers[l], offset, 0);
+    }
+}
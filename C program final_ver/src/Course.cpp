@@ -0,0 +1,117 @@
+﻿#include "../include/Course.h"
+#include "../include/GameRules.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CourseFile::CourseFile()
+    : file(INVALID_HANDLE_VALUE), mapping(NULL), base(nullptr), header(nullptr), pipes(nullptr) {
+}
+
+CourseFile::~CourseFile() {
+    close();
+}
+
+bool CourseFile::open(const char* path) {
+    close();
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, NULL);   // 游戏中按顺序读取，提示系统预读
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(CourseHeader)) {
+        close();
+        return false;
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    base = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        close();
+        return false;
+    }
+
+    // 校验文件头，记录数必须和文件大小对得上
+    const CourseHeader* h = (const CourseHeader*)base;
+    uint64_t dataSize = (uint64_t)size.QuadPart - sizeof(CourseHeader);
+    if (memcmp(h->magic, "FBCS", 4) != 0 || h->version != COURSE_VERSION ||
+        h->pipeCount > dataSize / sizeof(CoursePipe)) {
+        close();
+        return false;
+    }
+    header = h;
+    pipes = (const CoursePipe*)(base + sizeof(CourseHeader));
+    return true;
+}
+
+void CourseFile::close() {
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+    base = nullptr;
+    header = nullptr;
+    pipes = nullptr;
+}
+
+bool CourseFile::generate(const char* path, uint64_t pipeCount, uint32_t seed) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) return false;
+
+    CourseHeader h;
+    memcpy(h.magic, "FBCS", 4);
+    h.version = COURSE_VERSION;
+    h.pipeCount = pipeCount;
+    h.seed = seed;
+    h.reserved = 0;
+    out.write((const char*)&h, sizeof(h));
+
+    // xorshift32：不依赖 CRT 的 rand()，不同编译器生成的赛道也一致
+    uint32_t state = seed ? seed : 0x9E3779B9u;
+
+    // 分块写出，几百万根管道也只占用固定的内存
+    const size_t CHUNK = 64 * 1024;
+    std::vector<CoursePipe> chunk;
+    chunk.reserve(CHUNK);
+
+    uint64_t spawnTick = 0;
+    for (uint64_t i = 0; i < pipeCount; i++) {
+        // 生成间隔与 Game::updateGameplay 一致：3秒起，每级减0.1秒，最低1.5秒
+        int level = 1 + (int)(i / 5);
+        float interval = 3.0f - level * 0.1f;
+        if (interval < 1.5f) interval = 1.5f;
+        spawnTick += (uint64_t)(interval * FPS + 0.5);
+        if (spawnTick > UINT32_MAX) {
+            pipeCount = i;   // 帧号超出范围（约两年的游戏时间），截断赛道
+            break;
+        }
+
+        CoursePipe pipe;
+        pipe.spawnTick = (uint32_t)spawnTick;
+        const PipeRoll roll = rollPipe(state);      // 与随机管道的规则相同
+        pipe.gapY = (uint16_t)roll.gapY;
+        pipe.flags = roll.hasCoin ? COURSE_PIPE_COIN : 0;
+        pipe.colorType = (uint8_t)roll.colorType;
+        chunk.push_back(pipe);
+
+        if (chunk.size() == CHUNK) {
+            out.write((const char*)chunk.data(), chunk.size() * sizeof(CoursePipe));
+            chunk.clear();
+        }
+    }
+    out.write((const char*)chunk.data(), chunk.size() * sizeof(CoursePipe));
+
+    // 赛道被截断时回写实际的管道数
+    if (pipeCount != h.pipeCount) {
+        h.pipeCount = pipeCount;
+        out.seekp(0);
+        out.write((const char*)&h, sizeof(h));
+    }
+    return out.good();
+}
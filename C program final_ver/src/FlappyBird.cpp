@@ -6,11 +6,29 @@
 
 // 包含必要的头文件
 #include "../include/game.h"  // 游戏主类头文件
+#include "../include/AssetBundle.h"  // 资源包路径
+#include "../include/Course.h"       // 比赛赛道
+#include "../include/Population.h"   // 种群模式
+#include "../include/Solver.h"       // 完美操作求解器
+#include <thread>   // 求解器默认线程数
 #include <iostream> // 标准输入输出流（用于控制台输出）
 #include <cstdlib>  // 标准库函数（system函数）
+#include <cstring>  // 字符串比较（命令行参数）
 
 // main函数：程序入口点
-int main() {
+// 命令行参数：
+//   --pack            把 assets 目录下的原始资源打包成 assets/assets.pak 后退出
+//   --bench-startup   重复加载资源并输出启动耗时后退出
+//   --bench [文件]    运行微基准测试，结果写入 JSON（默认 benchmarks.json）后退出
+//   --check-alloc     自动游玩一分钟，检查稳定状态下每帧零堆分配（失败时返回1）
+//   --render-dump [文件]   把各界面一帧的绘制命令写入文件（默认 render.bin），用于对比两个版本的画面
+//   --gen-course 文件 管道数 [种子]   生成比赛赛道文件后退出
+//   --course 文件     使用比赛赛道（固定的管道序列）开始游戏
+//   --bench-population [小鸟数] [帧数] [线程数]   种群模式（共享管道场）吞吐量测试后退出
+//   --solve 种子 [管道数] [难度|all] [线程数]     求该种子最高分的下界，判断能否通过（没找到通过路线时返回1）
+//   --broadcast 主机 端口 机台编号   正常游戏，同时把画面实时发给观战服务器（FlappyServer）
+//   --spectate 主机 端口 机台编号    观看一台机台的实时画面（ESC 退出）
+int main(int argc, char* argv[]) {
     // 设置控制台代码页为UTF-8，支持中文字符显示
     system("chcp 65001 > nul");
     // 说明：这条命令只在Windows命令提示符中有效
@@ -32,11 +50,83 @@ int main() {
     std::cout << "  • Customizable Settings" << std::endl;
     std::cout << "  • Dynamic Sky & Cloud System" << std::endl;
     std::cout << "=============================================" << std::endl;
+
+    // 工具模式：打包资源
+    if (argc > 1 && strcmp(argv[1], "--pack") == 0) {
+        return Game::packAssets(ASSET_BUNDLE_PATH) ? 0 : 1;
+    }
+
+    // 工具模式：生成比赛赛道
+    if (argc > 3 && strcmp(argv[1], "--gen-course") == 0) {
+        unsigned long long pipes = strtoull(argv[3], nullptr, 10);
+        unsigned seed = argc > 4 ? (unsigned)strtoul(argv[4], nullptr, 10) : 1;
+        if (!CourseFile::generate(argv[2], pipes, seed)) {
+            std::cout << "Failed to write course " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << "Course written: " << argv[2] << " (" << pipes << " pipes, seed " << seed << ")" << std::endl;
+        return 0;
+    }
+
+    // 工具模式：种群模式吞吐量测试（不需要窗口和资源）
+    if (argc > 1 && strcmp(argv[1], "--bench-population") == 0) {
+        int birds = argc > 2 ? atoi(argv[2]) : 100000;
+        int ticks = argc > 3 ? atoi(argv[3]) : 3600;
+        int threads = argc > 4 ? atoi(argv[4]) : 1;
+        return Population::benchmark(birds, ticks, threads) ? 0 : 1;
+    }
+
+    // 工具模式：完美操作求解器（默认前100根管道、三种难度、全部CPU核心）
+    if (argc > 2 && strcmp(argv[1], "--solve") == 0) {
+        unsigned seed = (unsigned)strtoul(argv[2], nullptr, 10);
+        int pipes = argc > 3 ? atoi(argv[3]) : 100;
+        int difficulty = argc > 4 && strcmp(argv[4], "all") != 0 ? atoi(argv[4]) : -1;
+        int threads = argc > 5 ? atoi(argv[5]) : (int)std::thread::hardware_concurrency();
+        return Solver::run(seed, pipes, difficulty, threads > 0 ? threads : 1) ? 0 : 1;
+    }
+
     std::cout << "Starting game..." << std::endl;
 
     // 创建游戏对象
     // Game类是整个游戏的核心，包含所有游戏逻辑和状态
     Game game;
+    std::cout << "Assets loaded in " << game.getAssetLoadMillis() << " ms" << std::endl;
+
+    // 工具模式：启动耗时测试
+    if (argc > 1 && strcmp(argv[1], "--bench-startup") == 0) {
+        game.benchmarkStartup(20);
+        return 0;
+    }
+
+    // 工具模式：微基准测试
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return game.runBenchmarks(argc > 2 ? argv[2] : "benchmarks.json") ? 0 : 1;
+    }
+
+    // 工具模式：零分配检查
+    if (argc > 1 && strcmp(argv[1], "--check-alloc") == 0) {
+        return game.checkSteadyStateAllocations(60 * 60) ? 0 : 1;
+    }
+
+    // 工具模式：导出绘制命令
+    if (argc > 1 && strcmp(argv[1], "--render-dump") == 0) {
+        return game.dumpRenderCommands(argc > 2 ? argv[2] : "render.bin") ? 0 : 1;
+    }
+
+    // 比赛模式：加载赛道
+    if (argc > 2 && strcmp(argv[1], "--course") == 0) {
+        if (!game.loadCourse(argv[2])) return 1;
+    }
+
+    // 观战：机台把画面发给观战服务器
+    if (argc > 4 && strcmp(argv[1], "--broadcast") == 0) {
+        if (!game.startBroadcast(argv[2], atoi(argv[3]), (unsigned)strtoul(argv[4], nullptr, 10))) return 1;
+    }
+
+    // 观战：只显示另一台机台的画面，不进入游戏
+    if (argc > 4 && strcmp(argv[1], "--spectate") == 0) {
+        return game.runSpectator(argv[2], atoi(argv[3]), (unsigned)strtoul(argv[4], nullptr, 10)) ? 0 : 1;
+    }
 
     // 运行游戏主循环
     // run()方法将启动图形窗口并进入游戏循环
@@ -0,0 +1,130 @@
+﻿#define FLAPPY_ENV_EXPORTS
+#include "../include/FlappyEnv.h"
+#include "../include/Simulation.h"
+#include <new>
+
+struct FlappyEnv {
+    uint32_t seed;
+    int difficulty;
+    int numEnvs;
+    SimState* states;
+    uint32_t* episodes;     // 每个环境已经开始的局数，用来给新的一局派生种子
+    int32_t* lastScores;    // 每个环境最近结束的一局的分数（自动重置之前记下）
+    uint32_t* lastLengths;  // 以及它的帧数
+};
+
+namespace {
+    // 由（总种子、环境编号、局数）派生每一局的种子，各环境互不相关且可复现
+    uint32_t episodeSeed(uint32_t seed, int index, uint32_t episode) {
+        uint32_t h = seed ^ (0x9E3779B9u * (uint32_t)(index + 1)) ^ (0x85EBCA6Bu * (episode + 1));
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        h *= 0x846CA68Bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    void resetOne(FlappyEnv* env, int index) {
+        Simulation::reset(env->states[index], episodeSeed(env->seed, index, env->episodes[index]++),
+            env->difficulty);
+    }
+
+    void writeObservation(const SimState& s, float* out) {
+        const float playCenter = (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f;
+        const SimPipe* first = Simulation::getNextPipe(s, 0);
+        const SimPipe* second = Simulation::getNextPipe(s, 1);
+
+        out[0] = s.birdY;
+        out[1] = s.birdVelocity;
+        out[2] = first ? first->x : (float)SCREEN_WIDTH;
+        out[3] = first ? first->gapY : playCenter;
+        out[4] = second ? second->x : (float)SCREEN_WIDTH;
+        out[5] = second ? second->gapY : playCenter;
+        out[6] = (float)s.level;
+        out[7] = s.gameSpeed;
+    }
+}
+
+FlappyEnv* env_create(uint32_t seed, int difficulty, int num_envs) {
+    if (num_envs <= 0) return nullptr;
+
+    FlappyEnv* env = new (std::nothrow) FlappyEnv;
+    if (!env) return nullptr;
+    env->seed = seed;
+    env->difficulty = difficulty;
+    env->numEnvs = num_envs;
+    env->states = new (std::nothrow) SimState[num_envs];
+    env->episodes = new (std::nothrow) uint32_t[num_envs]();
+    env->lastScores = new (std::nothrow) int32_t[num_envs]();
+    env->lastLengths = new (std::nothrow) uint32_t[num_envs]();
+    if (!env->states || !env->episodes || !env->lastScores || !env->lastLengths) {
+        env_destroy(env);
+        return nullptr;
+    }
+    for (int i = 0; i < num_envs; i++) {
+        resetOne(env, i);
+    }
+    return env;
+}
+
+void env_destroy(FlappyEnv* env) {
+    if (!env) return;
+    delete[] env->states;
+    delete[] env->episodes;
+    delete[] env->lastScores;
+    delete[] env->lastLengths;
+    delete env;
+}
+
+int env_num_envs(const FlappyEnv* env) {
+    return env ? env->numEnvs : 0;
+}
+
+int env_obs_size(void) {
+    return FLAPPY_ENV_OBS_SIZE;
+}
+
+void env_reset(FlappyEnv* env, float* obs) {
+    for (int i = 0; i < env->numEnvs; i++) {
+        resetOne(env, i);
+        writeObservation(env->states[i], obs + i * FLAPPY_ENV_OBS_SIZE);
+    }
+}
+
+void env_step(FlappyEnv* env, const uint8_t* actions, float* obs, float* rewards, uint8_t* dones) {
+    for (int i = 0; i < env->numEnvs; i++) {
+        SimState& s = env->states[i];
+        int scoreBefore = s.score;
+
+        uint32_t events = Simulation::step(s, actions[i] != 0);
+
+        if (events & SIM_EVENT_DIED) {
+            rewards[i] = FLAPPY_ENV_REWARD_DEATH;
+            dones[i] = 1;
+            env->lastScores[i] = s.score;
+            env->lastLengths[i] = s.tick;
+            resetOne(env, i);   // 自动开始新的一局
+        }
+        else {
+            rewards[i] = FLAPPY_ENV_REWARD_ALIVE + (float)(s.score - scoreBefore);
+            dones[i] = 0;
+        }
+        writeObservation(s, obs + i * FLAPPY_ENV_OBS_SIZE);
+    }
+}
+
+int env_get_score(const FlappyEnv* env, int index) {
+    if (!env || index < 0 || index >= env->numEnvs) return 0;
+    return env->states[index].score;
+}
+
+int env_get_last_episode_score(const FlappyEnv* env, int index) {
+    if (!env || index < 0 || index >= env->numEnvs) return 0;
+    return env->lastScores[index];
+}
+
+int env_get_last_episode_length(const FlappyEnv* env, int index) {
+    if (!env || index < 0 || index >= env->numEnvs) return 0;
+    return (int)env->lastLengths[index];
+}
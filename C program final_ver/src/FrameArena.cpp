@@ -0,0 +1,71 @@
+﻿#include "../include/FrameArena.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+
+FrameArena::FrameArena()
+    : current(0), offset(0), usedBeforeCurrent(0), capacity(0), highWater(0) {
+    blocks.reserve(16);
+    blocks.push_back({ new char[BLOCK_SIZE], BLOCK_SIZE });
+    capacity = BLOCK_SIZE;
+}
+
+FrameArena::~FrameArena() {
+    for (Block& block : blocks) {
+        delete[] block.data;
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t align) {
+    while (true) {
+        Block& block = blocks[current];
+        uintptr_t base = (uintptr_t)block.data;
+        size_t aligned = ((base + offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        if (aligned + size <= block.size) {
+            offset = aligned + size;
+            if (getUsedBytes() > highWater) highWater = getUsedBytes();
+            return block.data + aligned;
+        }
+
+        // 当前块放不下：换到下一块，没有就新分配一块（以后的帧会继续复用它）
+        usedBeforeCurrent += offset;
+        offset = 0;
+        current++;
+        if (current == blocks.size()) {
+            size_t blockSize = size + align > BLOCK_SIZE ? size + align : BLOCK_SIZE;
+            blocks.push_back({ new char[blockSize], blockSize });
+            capacity += blockSize;
+        }
+    }
+}
+
+const wchar_t* FrameArena::format(const wchar_t* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int length = _vscwprintf(fmt, args);
+    va_end(args);
+    if (length < 0) return L"";
+
+    wchar_t* text = allocArray<wchar_t>(length + 1);
+    va_start(args, fmt);
+    vswprintf_s(text, length + 1, fmt, args);
+    va_end(args);
+    return text;
+}
+
+const wchar_t* FrameArena::widen(const char* text) {
+    size_t length = 0;
+    if (mbstowcs_s(&length, nullptr, 0, text, _TRUNCATE) != 0 || length == 0) return L"";
+
+    wchar_t* wide = allocArray<wchar_t>(length);
+    size_t converted = 0;
+    mbstowcs_s(&converted, wide, length, text, _TRUNCATE);
+    return wide;
+}
+
+void FrameArena::reset() {
+    current = 0;
+    offset = 0;
+    usedBeforeCurrent = 0;
+}
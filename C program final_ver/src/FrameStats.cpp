@@ -0,0 +1,73 @@
+﻿#include "../include/FrameStats.h"
+#include <algorithm>
+#include <fstream>
+
+FrameStats::FrameStats(double windowSeconds)
+    : windowSeconds(windowSeconds), lastRefreshSec(0), count(0),
+      frameSummary(), updateSummary(), renderSummary() {
+}
+
+void FrameStats::addSample(double timeSec, float frameMs, float updateMs, float renderMs) {
+    FrameSample& sample = samples[count % CAPACITY];
+    sample.timeSec = timeSec;
+    sample.frameMs = frameMs;
+    sample.updateMs = updateMs;
+    sample.renderMs = renderMs;
+    count++;
+
+    if (timeSec - lastRefreshSec >= 0.5) {
+        refresh();
+        lastRefreshSec = timeSec;
+    }
+}
+
+void FrameStats::refresh() {
+    // 从最新一帧往回数，找出落在统计窗口内的样本数
+    int available = getSampleCount();
+    double newest = getRecent(0).timeSec;
+    int windowCount = 0;
+    while (windowCount < available && newest - getRecent(windowCount).timeSec <= windowSeconds) {
+        windowCount++;
+    }
+
+    frameSummary = summarize(&FrameSample::frameMs, windowCount);
+    updateSummary = summarize(&FrameSample::updateMs, windowCount);
+    renderSummary = summarize(&FrameSample::renderMs, windowCount);
+}
+
+// 最近邻秩法计算分位数
+FrameTimeSummary FrameStats::summarize(float FrameSample::* field, int windowCount) {
+    FrameTimeSummary summary = {};
+    if (windowCount == 0) return summary;
+
+    double total = 0;
+    for (int i = 0; i < windowCount; i++) {
+        scratch[i] = getRecent(i).*field;
+        total += scratch[i];
+    }
+    std::sort(scratch, scratch + windowCount);
+
+    auto percentile = [&](float p) {
+        int index = (int)(p * windowCount + 0.5f) - 1;
+        return scratch[std::clamp(index, 0, windowCount - 1)];
+    };
+    summary.p50 = percentile(0.50f);
+    summary.p95 = percentile(0.95f);
+    summary.p99 = percentile(0.99f);
+    summary.max = scratch[windowCount - 1];
+    summary.avg = (float)(total / windowCount);
+    return summary;
+}
+
+bool FrameStats::dumpCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << "time_s,frame_ms,update_ms,render_ms\n";
+    for (int ago = getSampleCount() - 1; ago >= 0; ago--) {
+        const FrameSample& sample = getRecent(ago);
+        file << sample.timeSec << ',' << sample.frameMs << ','
+            << sample.updateMs << ',' << sample.renderMs << '\n';
+    }
+    return file.good();
+}
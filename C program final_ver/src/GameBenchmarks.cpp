@@ -0,0 +1,262 @@
+﻿// GameBenchmarks.cpp - 模拟与存档热路径的微基准测试（FlappyBird.exe --bench）
+#include "../include/game.h"
+#include "../include/Benchmark.h"
+#include "../include/CloudLayers.h"
+#include "../include/InputHandler.h"
+#include "../include/ParticleRenderer.h"
+#include "../include/RenderList.h"
+#include "../include/RewindBuffer.h"
+#include "../include/Simulation.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const float TICK = (float)(1.0 / FPS);
+    const char* BENCH_LEADERBOARD_FILE = "bench_leaderboard.dat";
+
+    // 以固定间隔排开 count 根管道；间隔足够大，测试期间不会有管道移出屏幕
+    void fillPipes(PipeManager& manager, int count) {
+        manager.clearPipes();
+        for (int i = 0; i < count; i++) {
+            manager.addPipe(SCREEN_WIDTH + i * 300.0f, i);
+        }
+    }
+
+    // 模拟状态转成倒带缓冲的一帧（与 Game::captureRewindFrame 保存的内容相同）
+    void simToRewindFrame(const SimState& s, RewindFrame& frame) {
+        memset(&frame, 0, sizeof(frame));
+        frame.tick = s.tick;
+        frame.pipeRng = s.rng;
+        frame.birdY = s.birdY;
+        frame.birdVelocity = s.birdVelocity;
+        frame.comboTime = s.comboTime;
+        frame.comboCount = s.comboCount;
+        frame.scoreMultiplier = s.scoreMultiplier;
+        frame.score = s.score;
+        frame.coins = s.coins;
+        frame.level = s.level;
+        frame.pipesPassed = s.pipesPassed;
+        frame.nextPipeID = s.nextPipeID;
+        frame.gameSpeed = s.gameSpeed;
+        frame.pipeTimer = s.pipeTimer;
+        frame.gameTime = s.gameTime;
+        frame.pipeCount = s.pipeCount;
+        for (int i = 0; i < s.pipeCount; i++) {
+            const SimPipe& pipe = s.pipes[i];
+            frame.pipes[i].x = pipe.x;
+            frame.pipes[i].gapY = pipe.gapY;
+            frame.pipes[i].id = pipe.id;
+            frame.pipes[i].color = Pipe::colorFromType(pipe.colorType);
+            frame.pipes[i].coin = pipe.hasCoin && !pipe.coinCollected;
+            frame.pipes[i].passed = pipe.passed;
+        }
+    }
+}
+
+// 运行全部微基准测试，结果写入 jsonPath
+// 随机数种子固定，前后两次运行的输入完全一致，结果可以直接对比
+bool Game::runBenchmarks(const char* jsonPath) {
+    BenchmarkSuite suite;
+    srand(12345);
+
+    // --- Bird::update：每30帧跳一次，覆盖上升、下落和落地三种状态 ---
+    {
+        Bird testBird;
+        int tick = 0;
+        suite.run("Bird::update", 0, [&]() {
+            if (++tick % 30 == 0) testBird.jump();
+            testBird.update(TICK);
+            benchmarkKeep(testBird.getY());
+        });
+    }
+
+    const int pipeCounts[] = { 3, 10, 100, 1000 };
+
+    // --- PipeManager::update：速度为0，管道集合保持不变，测的是移动和出界扫描本身 ---
+    for (int count : pipeCounts) {
+        PipeManager manager;
+        fillPipes(manager, count);
+        Bird testBird;
+        int testScore = 0, testLevel = 1;
+        float testSpeed = 0, testShakeTime = 0, testShakeIntensity = 0;
+        suite.run("PipeManager::update", count, [&]() {
+            manager.update(0.0f, &testBird, testScore, testLevel,
+                testSpeed, testShakeTime, testShakeIntensity, *this);
+        });
+    }
+
+    // --- 碰撞 / 硬币 / 通过检测：小鸟在所有管道左侧，测的是每帧最常见的“未命中”路径 ---
+    for (int count : pipeCounts) {
+        PipeManager manager;
+        fillPipes(manager, count);
+        Bird testBird;
+        RECT birdRect = testBird.getCollisionRect();
+        suite.run("PipeManager::checkCollision", count, [&]() {
+            benchmarkKeep(manager.checkCollision(birdRect));
+        });
+        suite.run("PipeManager::checkCoinCollision", count, [&]() {
+            benchmarkKeep(manager.checkCoinCollision(birdRect));
+        });
+        suite.run("PipeManager::checkPipePassed", count, [&]() {
+            benchmarkKeep(manager.checkPipePassed(testBird.getX()));
+        });
+    }
+
+    // --- Game::updateParticles：每个样本重新生成粒子，再模拟半秒（粒子寿命1~2秒，不会中途消失）---
+    const int particleCounts[] = { 10, 100, 1000, 10000, 100000 };
+    for (int count : particleCounts) {
+        suite.run("Game::updateParticles", count, [&]() {
+            updateParticles(TICK);
+        }, [&]() {
+            particles.clear();
+            particles.reserve(count);   // 游戏中容量上限为 MAX_PARTICLES，这里按测试规模放开
+            createParticles(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f, count, RGB(255, 255, 255), 0);
+        }, 30);
+    }
+    particles.clear();
+
+    // --- 粒子绘制：逐个绘制（Particle::draw）与剔除 + 分桶批量绘制（ParticleRenderer）对比 ---
+    // 四个发射点轮流生成（类型和颜色交错，和游戏中一样），其中一个在屏幕外，用来测剔除
+    {
+        initgraph(SCREEN_WIDTH, SCREEN_HEIGHT);
+        IMAGE canvas(SCREEN_WIDTH, SCREEN_HEIGHT);
+        SetWorkingImage(&canvas);   // 画在离屏图像上，不受窗口刷新影响
+        ParticleRenderer renderer;
+        const int drawCounts[] = { 1000, 10000 };
+        for (int count : drawCounts) {
+            particles.clear();
+            particles.reserve(count);
+            for (int i = 0; particles.size() < (size_t)count; i++) {
+                switch (i % 4) {
+                case 0: createParticles(SCREEN_WIDTH / 4.0f, SCREEN_HEIGHT / 2.0f, 10, RGB(255, 255, 0), 1); break;
+                case 1: createParticles(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 3.0f, 10, RGB(255, 215, 0), 0); break;
+                case 2: createParticles(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f, 10, RGB(255, 50, 50), 2); break;
+                default: createParticles(SCREEN_WIDTH + 100.0f, SCREEN_HEIGHT / 2.0f, 10, RGB(255, 255, 255), 0); break;
+                }
+            }
+            for (int t = 0; t < 30; t++) {
+                updateParticles(TICK);  // 散开半秒
+            }
+
+            suite.run("Particle::draw", count, [&]() {
+                for (const auto& particle : particles) {
+                    particle.draw();
+                }
+            });
+            int drawn = 0;
+            RenderList& list = RenderList::getInstance();
+            suite.run("ParticleRenderer::draw", count, [&]() {
+                list.begin();
+                drawn = renderer.draw(particles);
+                list.execute();
+            });
+            std::cout << "ParticleRenderer: " << count << " particles, " << drawn << " drawn in "
+                << renderer.getBucketCount() << " buckets" << std::endl;
+        }
+        SetWorkingImage(NULL);
+        closegraph();
+        particles.clear();
+    }
+
+    // --- 云朵绘制：一屏8朵与80朵。视差层合成好之后每层一次贴图，两者的耗时应相同 ---
+    {
+        initgraph(SCREEN_WIDTH, SCREEN_HEIGHT);
+        IMAGE canvas(SCREEN_WIDTH, SCREEN_HEIGHT);
+        SetWorkingImage(&canvas);
+        RenderList& list = RenderList::getInstance();
+        CloudLayers layers;
+        const int cloudCounts[] = { CLOUD_COUNT, CLOUD_COUNT * 10 };
+        for (int count : cloudCounts) {
+            layers.build(count, 12345);
+            suite.run("CloudLayers::draw", count, [&]() {
+                list.begin();
+                layers.update(TICK);
+                layers.draw();
+                list.execute();
+            });
+        }
+        SetWorkingImage(NULL);
+        closegraph();
+    }
+
+    // --- 排行榜读、写、插入：条目数从10到一千万（一千万只在64位下测试）---
+    std::vector<long long> entryCounts = { 10, 1000, 100000 };
+    if (sizeof(void*) >= 8) {
+        entryCounts.push_back(10000000);
+    }
+    std::vector<ScoreEntry> savedLeaderboard = leaderboard;
+    for (long long count : entryCounts) {
+        std::vector<ScoreEntry> table;
+        table.reserve((size_t)count);
+        for (long long i = 0; i < count; i++) {
+            table.push_back(ScoreEntry("Player" + std::to_string(i), rand() % 10000,
+                1 + rand() % 20, rand() % 600));
+        }
+        std::sort(table.begin(), table.end());
+
+        leaderboard = table;
+        saveLeaderboard(BENCH_LEADERBOARD_FILE, table.size());
+        suite.run("Game::loadLeaderboard", count, [&]() {
+            loadLeaderboard(BENCH_LEADERBOARD_FILE);
+        });
+
+        leaderboard = table;
+        suite.run("Game::saveLeaderboard", count, [&]() {
+            saveLeaderboard(BENCH_LEADERBOARD_FILE, table.size());
+        });
+
+        // 插入会截断排行榜，所以每个样本前恢复完整的表（恢复不计时）
+        ScoreEntry entry("Bench", 5000, 5, 120);
+        suite.run("Game::insertLeaderboardEntry", count, [&]() {
+            insertLeaderboardEntry(entry);
+        }, [&]() {
+            leaderboard = table;
+        }, 1);
+    }
+    leaderboard = savedLeaderboard;
+    std::remove(BENCH_LEADERBOARD_FILE);
+
+    // --- RewindBuffer::seek：录满缓冲后跳到关键帧前的最后一帧（要应用最多的增量，最坏情况）---
+    {
+        RewindBuffer* buffer = new RewindBuffer();   // 约50KB，不放在栈上
+        SimState sim;
+        Simulation::reset(sim, 12345, 1);
+        RewindFrame frame;
+        simToRewindFrame(sim, frame);
+        buffer->record(frame);
+        for (int t = 0; t < REWIND_DELTA_SLOTS; t++) {
+            // 低于下一根管道的间隙中心就跳（这个种子下不会死亡）
+            const SimPipe* next = Simulation::getNextPipe(sim, 0);
+            float target = next ? next->gapY + 20 : SCREEN_HEIGHT / 2.0f;
+            Simulation::step(sim, sim.birdY > target && sim.birdVelocity > 0);
+            simToRewindFrame(sim, frame);
+            buffer->record(frame);
+        }
+
+        uint32_t worstTick = buffer->getNewestTick();
+        while (worstTick % REWIND_KEYFRAME_INTERVAL != REWIND_KEYFRAME_INTERVAL - 1) worstTick--;
+        suite.run("RewindBuffer::seek", REWIND_KEYFRAME_INTERVAL - 1, [&]() {
+            buffer->seek(worstTick, frame);
+            benchmarkKeep(frame.birdY);
+        });
+        std::cout << "RewindBuffer: " << RewindBuffer::getMemoryBytes() << " bytes, "
+            << (buffer->getNewestTick() - buffer->getOldestTick()) / FPS << " s recorded" << std::endl;
+        delete buffer;
+    }
+
+    // --- InputHandler::update ---
+    {
+        InputHandler& input = InputHandler::getInstance();
+        suite.run("InputHandler::update", 0, [&]() {
+            input.update();
+        });
+    }
+
+    if (!suite.writeJson(jsonPath)) {
+        std::cout << "无法写入 " << jsonPath << std::endl;
+        return false;
+    }
+    std::cout << "基准测试结果已保存: " << jsonPath << std::endl;
+    return true;
+}
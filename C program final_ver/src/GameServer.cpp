@@ -0,0 +1,422 @@
+﻿#include "../include/GameServer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#define SERVER_RECEIVE_BATCH 1024
+
+namespace {
+    double nowSeconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 房间 + 回合 → 种子，同一房间每回合换一组管道
+    uint32_t roundSeed(uint32_t roomId, uint32_t round) {
+        uint32_t h = roomId * 0x9E3779B9u ^ (round + 1) * 0x85EBCA6Bu;
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        return h ? h : 1;
+    }
+
+    uint64_t viewerKey(const NetAddress& address, uint16_t viewerId) {
+        return (uint64_t)address.addr.sin_addr.s_addr << 32 | (uint64_t)address.addr.sin_port << 16 | viewerId;
+    }
+
+    float percentile(std::vector<float>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+}
+
+GameServer::GameServer(uint16_t port, int workerCount) : basePort(port), running(false) {
+    workerCount = std::clamp(workerCount, 1, SERVER_MAX_WORKERS);
+    for (int i = 0; i < workerCount; i++) {
+        Worker* worker = new Worker();
+        worker->index = i;
+        worker->sessionCount = 0;
+        worker->viewerCount = 0;
+        worker->busySeconds = 0;
+        worker->windowStart = 0;
+        worker->packetsIn = 0;
+        worker->packetsOut = 0;
+        memset(&worker->published, 0, sizeof(worker->published));
+        worker->tickMicros.reserve((size_t)FPS * 2);
+        workers.push_back(worker);
+    }
+}
+
+GameServer::~GameServer() {
+    stop();
+    for (Worker* worker : workers) {
+        delete worker;
+    }
+}
+
+bool GameServer::start() {
+    for (Worker* worker : workers) {
+        if (!worker->socket.open((uint16_t)(basePort + worker->index))) {
+            std::cout << "Cannot bind UDP port " << basePort + worker->index << std::endl;
+            return false;
+        }
+    }
+    running = true;
+    for (Worker* worker : workers) {
+        worker->thread = std::thread(&GameServer::workerLoop, this, std::ref(*worker));
+    }
+    return true;
+}
+
+void GameServer::stop() {
+    running = false;
+    for (Worker* worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+        worker->socket.close();
+    }
+}
+
+void GameServer::run(double seconds) {
+    double start = nowSeconds();
+    double nextReport = start + 5.0;
+    while (seconds <= 0 || nowSeconds() - start < seconds) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (nowSeconds() < nextReport) continue;
+        nextReport += 5.0;
+
+        StatsReplyPacket stats;
+        getStats(stats);
+        for (int i = 0; i < stats.workerCount; i++) {
+            const WorkerStatsRecord& w = stats.workers[i];
+            std::cout << "worker " << i << ": " << w.rooms << " rooms, " << w.sessions << " sessions, tick p50 "
+                << w.tickP50Us << " us, p99 " << w.tickP99Us << " us, busy " << w.busy * 100 << "%";
+            if (w.cabinets || w.viewers) {
+                std::cout << ", " << w.cabinets << " cabinets, " << w.viewers << " viewers";
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+void GameServer::getStats(StatsReplyPacket& out) {
+    memset(&out, 0, sizeof(out));
+    out.header.type = PACKET_STATS_REPLY;
+    out.header.version = SERVER_PROTOCOL_VERSION;
+    out.workerCount = (uint16_t)workers.size();
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::lock_guard<std::mutex> lock(workers[i]->statsMutex);
+        out.workers[i] = workers[i]->published;
+    }
+}
+
+// ============================================================
+// 工作线程
+// ============================================================
+
+void GameServer::workerLoop(Worker& worker) {
+    const double tickSeconds = 1.0 / FPS;
+    double nextTick = nowSeconds();
+    worker.windowStart = nextTick;
+    char buffer[SERVER_MAX_PACKET];
+
+    while (running) {
+        // 等到有数据报或者该推进下一帧
+        int waitMs = (int)((nextTick - nowSeconds()) * 1000.0);
+        if (waitMs > 0) {
+            worker.socket.wait(std::min(waitMs, 100));
+        }
+
+        double busyStart = nowSeconds();
+
+        // 读取已到达的数据报；输入只记录，到帧时统一应用。
+        // 每轮最多读 SERVER_RECEIVE_BATCH 个：观战转发满载时数据报一直读不完，帧和统计也要按时进行
+        NetAddress from;
+        int size;
+        int budget = SERVER_RECEIVE_BATCH;
+        while (budget-- > 0 && (size = worker.socket.receiveFrom(from, buffer, sizeof(buffer))) > 0) {
+            worker.packetsIn++;
+            handlePacket(worker, from, buffer, size, busyStart);
+        }
+
+        double now = nowSeconds();
+        if (now >= nextTick) {
+            tickRooms(worker, now);
+            worker.tickMicros.push_back((float)((nowSeconds() - now) * 1e6));
+            nextTick += tickSeconds;
+            if (now - nextTick > 0.25) nextTick = now;   // 落后太多时不再追帧
+        }
+
+        now = nowSeconds();
+        worker.busySeconds += now - busyStart;
+        if (now - worker.windowStart >= 1.0) {
+            expireViewers(worker, now);
+            publishStats(worker, now);
+        }
+    }
+}
+
+void GameServer::handlePacket(Worker& worker, const NetAddress& from, const char* data, int size, double now) {
+    if (size < (int)sizeof(PacketHeader)) return;
+    const PacketHeader* header = (const PacketHeader*)data;
+    if (header->version != SERVER_PROTOCOL_VERSION) return;
+
+    switch (header->type) {
+    case PACKET_HELLO: {
+        HelloReplyPacket reply = {};
+        reply.header.type = PACKET_HELLO_REPLY;
+        reply.header.version = SERVER_PROTOCOL_VERSION;
+        reply.basePort = basePort;
+        reply.workerCount = (uint16_t)workers.size();
+        worker.socket.sendTo(from, &reply, sizeof(reply));
+        worker.packetsOut++;
+        break;
+    }
+    case PACKET_STATS: {
+        StatsReplyPacket reply;
+        getStats(reply);
+        worker.socket.sendTo(from, &reply, sizeof(reply));
+        worker.packetsOut++;
+        break;
+    }
+    case PACKET_JOIN: {
+        if (size < (int)sizeof(JoinPacket)) return;
+        const JoinPacket* join = (const JoinPacket*)data;
+        if (join->roomId % workers.size() != (uint32_t)worker.index) return;   // 发错了线程
+
+        Room& room = worker.rooms[join->roomId];
+        if (room.playerCount == 0) {
+            room.id = join->roomId;
+            room.round = 0;
+        }
+        // 已经在房间里（重发的 JOIN）只更新地址
+        for (int i = 0; i < room.playerCount; i++) {
+            if (room.players[i].clientId == join->clientId) {
+                room.players[i].address = from;
+                room.players[i].lastSeen = now;
+                return;
+            }
+        }
+        if (room.playerCount >= ROOM_MAX_PLAYERS) return;
+
+        Session& session = room.players[room.playerCount++];
+        session.clientId = join->clientId;
+        session.address = from;
+        session.lastSeen = now;
+        worker.sessionCount++;
+        startRound(room);   // 有新玩家加入，所有人从头开始同一回合
+        break;
+    }
+    case PACKET_INPUT:
+    case PACKET_LEAVE: {
+        uint32_t clientId, roomId;
+        if (header->type == PACKET_INPUT) {
+            if (size < (int)sizeof(InputPacket)) return;
+            const InputPacket* input = (const InputPacket*)data;
+            clientId = input->clientId;
+            roomId = input->roomId;
+        }
+        else {
+            if (size < (int)sizeof(JoinPacket)) return;
+            const JoinPacket* leave = (const JoinPacket*)data;
+            clientId = leave->clientId;
+            roomId = leave->roomId;
+        }
+
+        auto it = worker.rooms.find(roomId);
+        if (it == worker.rooms.end()) return;
+        Room& room = it->second;
+        for (int i = 0; i < room.playerCount; i++) {
+            Session& session = room.players[i];
+            if (session.clientId != clientId) continue;
+
+            if (header->type == PACKET_LEAVE) {
+                room.players[i] = room.players[--room.playerCount];
+                worker.sessionCount--;
+                if (room.playerCount == 0) worker.rooms.erase(it);
+                return;
+            }
+            const InputPacket* input = (const InputPacket*)data;
+            session.pendingJump |= input->jump;
+            session.pendingStamp = input->stamp;
+            session.address = from;
+            session.lastSeen = now;
+            return;
+        }
+        break;
+    }
+    case PACKET_SPECTATE_JOIN:
+    case PACKET_SPECTATE_STREAM:
+        handleSpectate(worker, from, data, size, now);
+        break;
+    default:
+        break;
+    }
+}
+
+void GameServer::handleSpectate(Worker& worker, const NetAddress& from, const char* data, int size, double now) {
+    if (((const PacketHeader*)data)->type == PACKET_SPECTATE_JOIN) {
+        if (size < (int)sizeof(SpectateJoinPacket)) return;
+        const SpectateJoinPacket* join = (const SpectateJoinPacket*)data;
+        if (join->cabinetId % workers.size() != (uint32_t)worker.index) return;
+
+        Channel& channel = worker.channels[join->cabinetId];
+        uint64_t key = viewerKey(from, join->viewerId);
+        auto it = channel.viewerIndex.find(key);
+        if (it != channel.viewerIndex.end()) {
+            channel.viewers[it->second].lastSeen = now;     // 保活
+            return;
+        }
+        channel.viewerIndex[key] = channel.viewers.size();
+        channel.viewers.push_back({ key, now });
+        channel.addresses.push_back(from);
+        worker.viewerCount++;
+        return;
+    }
+
+    if (size < (int)sizeof(SpectateStreamHeader)) return;
+    const SpectateStreamHeader* stream = (const SpectateStreamHeader*)data;
+    if (stream->cabinetId % workers.size() != (uint32_t)worker.index) return;
+
+    Channel& channel = worker.channels[stream->cabinetId];
+    channel.lastPublish = now;
+    if (channel.addresses.empty()) return;
+
+    // 收到的数据报原样发给所有观众：不重新编码，也不为每个观众拷贝
+    int sent = worker.socket.sendToMany(channel.addresses.data(), (int)channel.addresses.size(), data, size);
+    worker.packetsOut += sent;
+}
+
+// 每秒一次：移除不再保活的观众，以及没有观众、机台也不再发送的频道
+void GameServer::expireViewers(Worker& worker, double now) {
+    for (auto it = worker.channels.begin(); it != worker.channels.end();) {
+        Channel& channel = it->second;
+        for (size_t i = 0; i < channel.viewers.size();) {
+            if (now - channel.viewers[i].lastSeen <= SPECTATE_TIMEOUT_SECONDS) {
+                i++;
+                continue;
+            }
+            // 用最后一个填补空位，同时更新它的下标
+            channel.viewerIndex.erase(channel.viewers[i].key);
+            size_t lastIndex = channel.viewers.size() - 1;
+            if (i != lastIndex) {
+                channel.viewers[i] = channel.viewers[lastIndex];
+                channel.addresses[i] = channel.addresses[lastIndex];
+                channel.viewerIndex[channel.viewers[i].key] = i;
+            }
+            channel.viewers.pop_back();
+            channel.addresses.pop_back();
+            worker.viewerCount--;
+        }
+
+        if (channel.viewers.empty() && now - channel.lastPublish > SPECTATE_TIMEOUT_SECONDS) {
+            it = worker.channels.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void GameServer::startRound(Room& room) {
+    room.round++;
+    room.seed = roundSeed(room.id, room.round);
+    for (int i = 0; i < room.playerCount; i++) {
+        Session& session = room.players[i];
+        Simulation::reset(session.state, room.seed, 1);
+        session.pendingJump = 0;
+        session.pendingStamp = 0;
+        session.echoStamp = 0;
+    }
+}
+
+// 推进所有房间一帧，并给每个玩家发送房间状态
+void GameServer::tickRooms(Worker& worker, double now) {
+    StatePacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.header.type = PACKET_STATE;
+    packet.header.version = SERVER_PROTOCOL_VERSION;
+
+    for (auto it = worker.rooms.begin(); it != worker.rooms.end();) {
+        Room& room = it->second;
+
+        // 移除掉线的玩家
+        for (int i = 0; i < room.playerCount;) {
+            if (now - room.players[i].lastSeen > SERVER_SESSION_TIMEOUT_SECONDS) {
+                room.players[i] = room.players[--room.playerCount];
+                worker.sessionCount--;
+            }
+            else {
+                i++;
+            }
+        }
+        if (room.playerCount == 0) {
+            it = worker.rooms.erase(it);
+            continue;
+        }
+
+        // 应用本帧收集到的输入
+        bool anyAlive = false;
+        for (int i = 0; i < room.playerCount; i++) {
+            Session& session = room.players[i];
+            Simulation::step(session.state, session.pendingJump != 0);
+            session.pendingJump = 0;
+            if (session.pendingStamp) session.echoStamp = session.pendingStamp;
+            anyAlive = anyAlive || session.state.alive;
+        }
+
+        packet.roomId = room.id;
+        packet.seed = room.seed;
+        packet.round = room.round;
+        packet.tick = room.players[0].state.tick;
+        packet.playerCount = (uint8_t)room.playerCount;
+        for (int i = 0; i < room.playerCount; i++) {
+            const SimState& s = room.players[i].state;
+            StatePlayer& p = packet.players[i];
+            p.clientId = room.players[i].clientId;
+            p.y = s.birdY;
+            p.velocity = s.birdVelocity;
+            p.score = s.score;
+            p.alive = s.alive;
+        }
+        for (int i = 0; i < room.playerCount; i++) {
+            packet.clientId = room.players[i].clientId;
+            packet.echoStamp = room.players[i].echoStamp;
+            worker.socket.sendTo(room.players[i].address, &packet, sizeof(packet));
+            worker.packetsOut++;
+        }
+
+        // 所有人都死了：下一回合
+        if (!anyAlive) startRound(room);
+        ++it;
+    }
+}
+
+void GameServer::publishStats(Worker& worker, double now) {
+    std::vector<float>& samples = worker.tickMicros;
+    std::sort(samples.begin(), samples.end());
+
+    WorkerStatsRecord record;
+    record.rooms = (uint32_t)worker.rooms.size();
+    record.sessions = (uint32_t)worker.sessionCount;
+    record.tickP50Us = percentile(samples, 0.50);
+    record.tickP99Us = percentile(samples, 0.99);
+    record.tickMaxUs = samples.empty() ? 0 : samples.back();
+    record.busy = (float)(worker.busySeconds / (now - worker.windowStart));
+    record.packetsIn = worker.packetsIn;
+    record.packetsOut = worker.packetsOut;
+    int cabinets = 0;
+    for (const auto& entry : worker.channels) {
+        if (now - entry.second.lastPublish <= SPECTATE_TIMEOUT_SECONDS) cabinets++;
+    }
+    record.cabinets = (uint16_t)std::min(cabinets, 65535);
+    record.viewers = (uint16_t)std::min(worker.viewerCount, 65535);
+    {
+        std::lock_guard<std::mutex> lock(worker.statsMutex);
+        worker.published = record;
+    }
+
+    samples.clear();
+    worker.busySeconds = 0;
+    worker.windowStart = now;
+}
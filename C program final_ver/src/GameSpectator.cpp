@@ -0,0 +1,167 @@
+﻿// GameSpectator.cpp - 观战：机台发送画面（--broadcast），观众显示另一台机台的画面（--spectate）
+#include "../include/game.h"
+#include "../include/CloudLayers.h"
+#include "../include/FrameArena.h"
+#include "../include/RenderList.h"
+#include "../include/RewindBuffer.h"
+#include "../include/SpectatorLink.h"
+#include <cstring>
+#include <iostream>
+
+bool Game::startBroadcast(const char* host, int port, uint32_t cabinetId) {
+    SpectatorBroadcaster* link = new SpectatorBroadcaster();
+    if (!link->open(host, (uint16_t)port, cabinetId)) {
+        std::cout << "No reply from spectator server " << host << ":" << port << std::endl;
+        delete link;
+        return false;
+    }
+    delete broadcaster;
+    broadcaster = link;
+    std::cout << "Broadcasting as cabinet " << cabinetId << std::endl;
+    return true;
+}
+
+// 观众看到的一帧：倒带缓冲的状态 + 界面和 HUD 需要的数据
+void Game::captureSpectatorFrame(SpectatorFrame& frame) const {
+    memset(&frame, 0, sizeof(frame));
+    frame.gameState = (uint8_t)currentState;
+    frame.highScore = highScore;
+    frame.particleSeed = particleSeed;
+    strncpy(frame.playerName, playerName.c_str(), SPECTATE_NAME_LENGTH - 1);
+    captureRewindFrame(frame.game);
+}
+
+void Game::publishSpectatorFrame() {
+    SpectatorFrame frame;
+    captureSpectatorFrame(frame);
+    broadcaster->publish(frame, spectatorEvents, currentState == STATE_PLAYING);
+    spectatorEvents = 0;
+}
+
+// 把解码出的画面放进本地的小鸟和管道，之后用正常的 render() 绘制
+void Game::applySpectatorFrame(uint8_t events) {
+    const SpectatorFrame& frame = spectator->getDecoder().getFrame();
+    restoreRewindFrame(frame.game);
+    highScore = frame.highScore;
+    playerName.assign(frame.playerName, strnlen(frame.playerName, SPECTATE_NAME_LENGTH));
+
+    // 机台的倒带界面按游戏画面显示；菜单、排行榜等界面都显示为主菜单
+    switch ((GameState)frame.gameState) {
+    case STATE_PLAYING:
+    case STATE_REWIND:
+        currentState = STATE_PLAYING;
+        break;
+    case STATE_PAUSED:
+        currentState = STATE_PAUSED;
+        break;
+    case STATE_GAME_OVER:
+        currentState = STATE_GAME_OVER;
+        bird->kill();
+        break;
+    default:
+        currentState = STATE_MENU;
+        break;
+    }
+
+    // 新的一局：同一机台的所有观众从同一个随机序列生成粒子
+    if (frame.particleSeed != particleSeed) {
+        particleSeed = frame.particleSeed;
+        srand(particleSeed);
+        particles.clear();
+    }
+    if (events & SPECTATE_EVENT_JUMP) {
+        createParticles(bird->getX(), bird->getY(), 8, RGB(255, 255, 0), 1);
+    }
+    if (events & SPECTATE_EVENT_COIN) {
+        createParticles(bird->getX(), bird->getY(), 15, RGB(255, 215, 0), 1);
+        shakeScreen(5.0f);
+    }
+    if (events & SPECTATE_EVENT_HIT) {
+        createParticles(bird->getX(), bird->getY(), 50, RGB(255, 50, 50), 2);
+        shakeScreen(10.0f);
+    }
+}
+
+void Game::drawSpectatorOverlay() {
+    RenderList& canvas = RenderList::getInstance();
+    const SpectatorDecoder& decoder = spectator->getDecoder();
+    const wchar_t* text;
+    canvas.setBkMode(TRANSPARENT);
+    canvas.setTextStyle(16, 0, _T("Arial"));
+
+    if (!decoder.hasFrame()) {
+        canvas.setTextColor(COLOR_TEXT_YELLOW);
+        text = FrameArena::getInstance().format(L"Waiting for cabinet %u ...", spectator->getCabinetId());
+    }
+    else {
+        canvas.setTextColor(decoder.isSynced() ? COLOR_TEXT_GREEN : COLOR_TEXT_YELLOW);
+        uint64_t messages = spectator->getMessagesReceived();
+        text = FrameArena::getInstance().format(L"%s  cabinet %u  %.1f bytes/msg",
+            decoder.isSynced() ? L"LIVE" : L"RESYNC", spectator->getCabinetId(),
+            messages ? (double)spectator->getBytesReceived() / messages : 0.0);
+    }
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(text) / 2, SCREEN_HEIGHT - GROUND_HEIGHT + 20, text);
+}
+
+// 观众的主循环：画面完全由机台的消息决定，本地只推进云朵、粒子和震动这些装饰效果
+bool Game::runSpectator(const char* host, int port, uint32_t cabinetId) {
+    SpectatorViewer* viewer = new SpectatorViewer();
+    if (!viewer->open(host, (uint16_t)port, cabinetId)) {
+        std::cout << "No reply from spectator server " << host << ":" << port << std::endl;
+        delete viewer;
+        return false;
+    }
+    delete spectator;
+    spectator = viewer;
+
+    initgraph(SCREEN_WIDTH, SCREEN_HEIGHT);
+    setbkcolor(BLACK);
+    currentState = STATE_MENU;
+
+    LARGE_INTEGER frequency, lastTime, currentTime;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&lastTime);
+    const double frameInterval = 1.0 / FPS;
+    double accumulator = 0.0;
+
+    // ESC 退出
+    while (!(GetAsyncKeyState(VK_ESCAPE) & 0x8000)) {
+        FrameArena::getInstance().reset();
+
+        QueryPerformanceCounter(&currentTime);
+        double elapsedTime = (double)(currentTime.QuadPart - lastTime.QuadPart) / frequency.QuadPart;
+        lastTime = currentTime;
+        if (elapsedTime > 0.25) elapsedTime = 0.25;
+        accumulator += elapsedTime;
+
+        while (accumulator >= frameInterval) {
+            float deltaTime = (float)frameInterval;
+            animationTime += deltaTime;
+            if (shakeTime > 0) {
+                shakeTime -= deltaTime;
+                shakeIntensity *= 0.9f;
+            }
+            cloudLayers->update(deltaTime);
+            updateParticles(deltaTime);
+            accumulator -= frameInterval;
+        }
+
+        uint8_t events = 0;
+        if (spectator->poll(events)) {
+            applySpectatorFrame(events);
+        }
+
+        render();
+
+        // 剩余时间休眠到下一帧
+        LARGE_INTEGER frameEnd;
+        QueryPerformanceCounter(&frameEnd);
+        double spent = (double)(frameEnd.QuadPart - currentTime.QuadPart) / frequency.QuadPart;
+        if (spent < frameInterval) {
+            Sleep((DWORD)((frameInterval - spent) * 1000.0));
+        }
+    }
+
+    closegraph();
+    return true;
+}
@@ -0,0 +1,83 @@
+﻿#include "../include/IdleWaiter.h"
+
+namespace {
+    const wchar_t* WINDOW_CLASS = L"FlappyBirdIdleWaiter";
+
+    uint64_t getProcessCpuTime() {
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+        ULARGE_INTEGER k, u;
+        k.LowPart = kernel.dwLowDateTime;
+        k.HighPart = kernel.dwHighDateTime;
+        u.LowPart = user.dwLowDateTime;
+        u.HighPart = user.dwHighDateTime;
+        return k.QuadPart + u.QuadPart;
+    }
+}
+
+IdleWaiter::IdleWaiter()
+    : window(nullptr), wakeups(0), lastWakeups(0), lastStatsMs(GetTickCount64()),
+      lastCpuTime(getProcessCpuTime()), cpuPercent(0), wakeupsPerSecond(0) {
+}
+
+IdleWaiter::~IdleWaiter() {
+    if (window) {
+        DestroyWindow(window);
+    }
+}
+
+bool IdleWaiter::init() {
+    if (window) return true;
+
+    WNDCLASSW wc = {};
+    wc.lpfnWndProc = DefWindowProcW;    // WM_INPUT 交给默认处理，释放系统的输入缓冲
+    wc.hInstance = GetModuleHandleW(nullptr);
+    wc.lpszClassName = WINDOW_CLASS;
+    RegisterClassW(&wc);
+
+    window = CreateWindowExW(0, WINDOW_CLASS, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, wc.hInstance, nullptr);
+    if (!window) return false;
+
+    RAWINPUTDEVICE keyboard;
+    keyboard.usUsagePage = 0x01;        // Generic Desktop
+    keyboard.usUsage = 0x06;            // Keyboard
+    keyboard.dwFlags = RIDEV_INPUTSINK;
+    keyboard.hwndTarget = window;
+    if (!RegisterRawInputDevices(&keyboard, 1, sizeof(keyboard))) {
+        DestroyWindow(window);
+        window = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool IdleWaiter::wait(DWORD timeoutMs) {
+    // 先取走已经到达的消息：MsgWaitForMultipleObjects 只在有"新"输入时返回
+    MSG msg;
+    while (PeekMessageW(&msg, window, 0, 0, PM_REMOVE)) {
+        DispatchMessageW(&msg);
+    }
+
+    DWORD result = MsgWaitForMultipleObjects(0, nullptr, FALSE, timeoutMs, QS_RAWINPUT);
+    wakeups++;
+    if (result != WAIT_OBJECT_0) return false;
+
+    while (PeekMessageW(&msg, window, 0, 0, PM_REMOVE)) {
+        DispatchMessageW(&msg);
+    }
+    return true;
+}
+
+void IdleWaiter::updateStats() {
+    ULONGLONG now = GetTickCount64();
+    if (now - lastStatsMs < 1000) return;
+
+    uint64_t cpuTime = getProcessCpuTime();
+    double seconds = (now - lastStatsMs) / 1000.0;
+    cpuPercent = (cpuTime - lastCpuTime) / 1e7 / seconds * 100.0;
+    wakeupsPerSecond = (wakeups - lastWakeups) / seconds;
+
+    lastStatsMs = now;
+    lastCpuTime = cpuTime;
+    lastWakeups = wakeups;
+}
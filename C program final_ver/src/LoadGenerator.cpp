@@ -0,0 +1,583 @@
+﻿#include "../include/LoadGenerator.h"
+#include "../include/NetSocket.h"
+#include "../include/ServerProtocol.h"
+#include "../include/GameRules.h"
+#include "../include/Simulation.h"
+#include "../include/SpectatorStream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    uint64_t nowMicros() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct SimulatedClient {
+        uint32_t clientId;
+        uint32_t roomId;
+        NetAddress server;          // 房间所在工作线程的端口
+        float y;
+        float velocity;
+        bool joined;                // 收到过 STATE
+        uint64_t statesReceived;
+    };
+
+    struct ThreadResult {
+        std::vector<float> latencyMs;
+        uint64_t inputsSent;
+        uint64_t statesReceived;
+    };
+
+    // 向服务器发请求并等待指定类型的回复（最多重试3次）
+    bool request(UdpSocket& socket, const NetAddress& server, uint8_t type, uint8_t replyType,
+        void* reply, int replySize) {
+        PacketHeader header = { type, SERVER_PROTOCOL_VERSION, 0 };
+        char buffer[SERVER_MAX_PACKET];
+        for (int attempt = 0; attempt < 3; attempt++) {
+            socket.sendTo(server, &header, sizeof(header));
+            uint64_t deadline = nowMicros() + 1000000;
+            while (nowMicros() < deadline) {
+                socket.wait(100);
+                NetAddress from;
+                int size;
+                while ((size = socket.receiveFrom(from, buffer, sizeof(buffer))) > 0) {
+                    if (size >= replySize && ((PacketHeader*)buffer)->type == replyType) {
+                        memcpy(reply, buffer, replySize);
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // 一个线程负责一部分模拟玩家，共用一个套接字，按 clientId 分发回复
+    void clientThread(std::vector<SimulatedClient>& clients, double seconds, ThreadResult& result) {
+        UdpSocket socket;
+        result.inputsSent = 0;
+        result.statesReceived = 0;
+        if (!socket.open(0) || clients.empty()) return;
+
+        const uint32_t firstId = clients[0].clientId;
+        const uint64_t tickMicros = (uint64_t)(1e6 / FPS);
+        const uint64_t start = nowMicros();
+        const uint64_t end = start + (uint64_t)(seconds * 1e6);
+        uint64_t nextTick = start;
+        uint64_t nextJoin = start;
+        char buffer[SERVER_MAX_PACKET];
+
+        InputPacket input = {};
+        input.header = { PACKET_INPUT, SERVER_PROTOCOL_VERSION, 0 };
+        JoinPacket join = {};
+        join.header = { PACKET_JOIN, SERVER_PROTOCOL_VERSION, 0 };
+
+        while (nowMicros() < end) {
+            uint64_t now = nowMicros();
+
+            // 还没进房间的玩家每秒重发一次 JOIN（UDP 可能丢包）
+            if (now >= nextJoin) {
+                for (SimulatedClient& c : clients) {
+                    if (c.joined) continue;
+                    join.clientId = c.clientId;
+                    join.roomId = c.roomId;
+                    socket.sendTo(c.server, &join, sizeof(join));
+                }
+                nextJoin = now + 1000000;
+            }
+
+            // 每帧每个玩家一个输入：简单的自动驾驶，低于屏幕中线且在下落时跳
+            if (now >= nextTick) {
+                for (SimulatedClient& c : clients) {
+                    if (!c.joined) continue;
+                    input.clientId = c.clientId;
+                    input.roomId = c.roomId;
+                    input.jump = c.y > (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f && c.velocity > 0;
+                    input.stamp = nowMicros();
+                    socket.sendTo(c.server, &input, sizeof(input));
+                    result.inputsSent++;
+                }
+                nextTick += tickMicros;
+                if (now > nextTick + 250000) nextTick = now;
+            }
+
+            // 接收状态直到下一帧
+            uint64_t waitUntil = std::min(nextTick, end);
+            now = nowMicros();
+            if (waitUntil > now) socket.wait((int)((waitUntil - now + 999) / 1000));
+
+            NetAddress from;
+            int size;
+            while ((size = socket.receiveFrom(from, buffer, sizeof(buffer))) > 0) {
+                if (size < (int)sizeof(StatePacket) || ((PacketHeader*)buffer)->type != PACKET_STATE) continue;
+                const StatePacket* state = (const StatePacket*)buffer;
+                uint32_t index = state->clientId - firstId;
+                if (index >= clients.size()) continue;
+
+                SimulatedClient& c = clients[index];
+                c.joined = true;
+                c.statesReceived++;
+                result.statesReceived++;
+                for (int i = 0; i < state->playerCount; i++) {
+                    if (state->players[i].clientId != c.clientId) continue;
+                    c.y = state->players[i].y;
+                    c.velocity = state->players[i].velocity;
+                }
+                if (state->echoStamp) {
+                    result.latencyMs.push_back((nowMicros() - state->echoStamp) / 1000.0f);
+                }
+            }
+        }
+
+        // 离开房间
+        for (SimulatedClient& c : clients) {
+            join.header.type = PACKET_LEAVE;
+            join.clientId = c.clientId;
+            join.roomId = c.roomId;
+            socket.sendTo(c.server, &join, sizeof(join));
+        }
+    }
+
+    float percentile(const std::vector<float>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+    }
+}
+
+bool LoadGenerator::run(const char* host, uint16_t port, int sessions, double seconds, int threads) {
+    NetAddress server;
+    if (!NetAddress::resolve(host, port, server)) {
+        std::cout << "Cannot resolve " << host << std::endl;
+        return false;
+    }
+
+    UdpSocket control;
+    HelloReplyPacket hello;
+    if (!control.open(0) || !request(control, server, PACKET_HELLO, PACKET_HELLO_REPLY, &hello, sizeof(hello))) {
+        std::cout << "No reply from server " << host << ":" << port << std::endl;
+        return false;
+    }
+    const int workerCount = std::max(1, (int)hello.workerCount);
+
+    // 玩家两两一个房间，房间按编号分到各工作线程的端口
+    threads = std::clamp(threads, 1, std::max(1, sessions));
+    std::vector<std::vector<SimulatedClient>> groups(threads);
+    for (int i = 0; i < sessions; i++) {
+        SimulatedClient c = {};
+        c.clientId = (uint32_t)i + 1;
+        c.roomId = (uint32_t)(i / ROOM_MAX_PLAYERS) + 1;
+        c.server = server;
+        c.server.addr.sin_port = htons((uint16_t)(hello.basePort + c.roomId % workerCount));
+        c.y = (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f;
+        groups[(size_t)i * threads / sessions].push_back(c);
+    }
+
+    std::cout << "Load test: " << sessions << " sessions, " << threads << " client thread(s), server has "
+        << workerCount << " worker(s), " << seconds << " s" << std::endl;
+
+    std::vector<ThreadResult> results(threads);
+    std::vector<std::thread> running;
+    for (int t = 0; t < threads; t++) {
+        results[t].latencyMs.reserve((size_t)(groups[t].size() * seconds * FPS));
+        running.emplace_back(clientThread, std::ref(groups[t]), seconds, std::ref(results[t]));
+    }
+    // 测试快结束时查询服务器统计（此时所有会话都还在）
+    std::this_thread::sleep_for(std::chrono::duration<double>(std::max(0.0, seconds - 1.0)));
+    StatsReplyPacket stats;
+    bool haveStats = request(control, server, PACKET_STATS, PACKET_STATS_REPLY, &stats, sizeof(stats));
+    for (std::thread& t : running) {
+        t.join();
+    }
+
+    // 客户端看到的延迟
+    std::vector<float> latency;
+    uint64_t sent = 0, received = 0;
+    for (ThreadResult& r : results) {
+        latency.insert(latency.end(), r.latencyMs.begin(), r.latencyMs.end());
+        sent += r.inputsSent;
+        received += r.statesReceived;
+    }
+    std::sort(latency.begin(), latency.end());
+    std::cout << "  inputs sent " << sent << ", states received " << received << std::endl;
+    std::cout << "  input-to-state latency ms: p50 " << percentile(latency, 0.50) << ", p95 "
+        << percentile(latency, 0.95) << ", p99 " << percentile(latency, 0.99) << ", max "
+        << (latency.empty() ? 0.0f : latency.back()) << std::endl;
+
+    if (!haveStats) {
+        std::cout << "  no stats reply from server" << std::endl;
+        return false;
+    }
+
+    // 服务器端：帧耗时；按忙碌比例把会话数折算到一个满载的核心
+    uint32_t totalSessions = 0;
+    double totalBusy = 0;
+    for (int i = 0; i < stats.workerCount; i++) {
+        const WorkerStatsRecord& w = stats.workers[i];
+        std::cout << "  worker " << i << ": " << w.sessions << " sessions in " << w.rooms << " rooms, tick p50 "
+            << w.tickP50Us << " us, p99 " << w.tickP99Us << " us, max " << w.tickMaxUs << " us, busy "
+            << w.busy * 100 << "%" << std::endl;
+        totalSessions += w.sessions;
+        totalBusy += w.busy;
+    }
+    std::cout << "  sessions per core: " << (double)totalSessions / stats.workerCount << " hosted, ~"
+        << (totalBusy > 0 ? totalSessions / totalBusy : 0) << " at full load" << std::endl;
+    return received > 0;
+}
+
+// ============================================================
+// 观战转发测试
+// ============================================================
+
+namespace {
+    const int STAMP_SLOTS = 1024;       // 每台机台最近这么多帧的发送时间
+
+    struct SimulatedCabinet {
+        uint32_t id;
+        NetAddress server;
+        SimState state;
+        uint32_t round;
+        uint32_t seed;
+        SpectatorEncoder encoder;
+        uint64_t messages;              // 计数期间发出的消息
+        uint64_t bytes;
+    };
+
+    struct ViewerSocket {
+        UdpSocket socket;
+        NetAddress server;
+        uint32_t cabinetId;
+        int viewers;
+        SpectatorDecoder decoder;
+    };
+
+    struct ViewerResult {
+        uint64_t received;
+        uint64_t bytes;
+        uint64_t gaps;
+        std::vector<float> latencyMs;
+        std::vector<std::pair<uint64_t, uint64_t>> checks;     // （机台编号、种子、帧号）→ 解码画面的校验和
+    };
+
+    // 机台和观众线程共享：发送时间和每帧画面的校验和
+    struct SpectatorShared {
+        std::unique_ptr<std::atomic<uint64_t>[]> stamps;
+        std::atomic<bool> counting;
+        std::atomic<bool> running;
+        std::mutex checksumMutex;
+        std::unordered_map<uint64_t, uint64_t> checksums;
+    };
+
+    uint32_t cabinetSeed(uint32_t cabinetId, uint32_t round) {
+        uint32_t h = cabinetId * 0x85EBCA6Bu ^ (round + 1) * 0x9E3779B9u;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        return h ? h : 1;
+    }
+
+    uint64_t frameKey(uint32_t cabinetId, uint32_t seed, uint32_t tick) {
+        return ((uint64_t)(cabinetId * 0x9E3779B9u ^ seed) << 32) | tick;
+    }
+
+    // 画面用到的字节（未使用的管道槽不算）的 FNV-1a
+    uint64_t frameChecksum(const SpectatorFrame& frame) {
+        const uint8_t* bytes = (const uint8_t*)&frame;
+        size_t size = offsetof(SpectatorFrame, game) + offsetof(RewindFrame, pipes) +
+            frame.game.pipeCount * sizeof(RewindPipe);
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // 模拟机台的画面；服务器不依赖图形库，管道颜色直接用颜色类型
+    void fillFrame(const SimulatedCabinet& cabinet, SpectatorFrame& frame) {
+        const SimState& s = cabinet.state;
+        memset(&frame, 0, sizeof(frame));
+        frame.gameState = 1;    // STATE_PLAYING
+        frame.highScore = 0;
+        frame.particleSeed = cabinet.seed;
+        snprintf(frame.playerName, sizeof(frame.playerName), "Cabinet %u", cabinet.id);
+
+        RewindFrame& f = frame.game;
+        f.tick = s.tick;
+        f.birdY = s.birdY;
+        f.birdVelocity = s.birdVelocity;
+        f.comboTime = s.comboTime;
+        f.comboCount = s.comboCount;
+        f.scoreMultiplier = s.scoreMultiplier;
+        f.score = s.score;
+        f.coins = s.coins;
+        f.level = s.level;
+        f.pipesPassed = s.pipesPassed;
+        f.nextPipeID = s.nextPipeID;
+        f.gameSpeed = s.gameSpeed;
+        f.pipeTimer = s.pipeTimer;
+        f.gameTime = s.gameTime;
+        f.pipeCount = std::min(s.pipeCount, (int32_t)REWIND_MAX_PIPES);
+        for (int i = 0; i < f.pipeCount; i++) {
+            const SimPipe& pipe = s.pipes[i];
+            f.pipes[i].x = pipe.x;
+            f.pipes[i].gapY = pipe.gapY;
+            f.pipes[i].id = pipe.id;
+            f.pipes[i].color = pipe.colorType;
+            f.pipes[i].coin = pipe.hasCoin && !pipe.coinCollected;
+            f.pipes[i].passed = pipe.passed;
+        }
+    }
+
+    // 一个线程负责一部分观众套接字，轮流读完每个套接字
+    void viewerThread(std::vector<ViewerSocket*>& sockets, SpectatorShared& shared, ViewerResult& result) {
+        result.received = 0;
+        result.bytes = 0;
+        result.gaps = 0;
+        char buffer[SERVER_MAX_PACKET];
+        uint64_t nextJoin = 0;
+        uint64_t sampled = 0;
+
+        SpectateJoinPacket join = {};
+        join.header = { PACKET_SPECTATE_JOIN, SERVER_PROTOCOL_VERSION, 0 };
+
+        while (shared.running) {
+            uint64_t now = nowMicros();
+            if (now >= nextJoin) {
+                for (ViewerSocket* v : sockets) {
+                    join.cabinetId = v->cabinetId;
+                    for (int i = 0; i < v->viewers; i++) {
+                        join.viewerId = (uint16_t)i;
+                        v->socket.sendTo(v->server, &join, sizeof(join));
+                    }
+                }
+                nextJoin = now + 1000000;
+            }
+
+            bool any = false;
+            for (ViewerSocket* v : sockets) {
+                NetAddress from;
+                int size;
+                while ((size = v->socket.receiveFrom(from, buffer, sizeof(buffer))) > 0) {
+                    any = true;
+                    if (size < (int)sizeof(SpectateStreamHeader)) continue;
+                    const SpectateStreamHeader* header = (const SpectateStreamHeader*)buffer;
+                    if (shared.counting) {
+                        result.received++;
+                        result.bytes += size;
+                        // 延迟每64条采样一次
+                        if (++sampled % 64 == 0) {
+                            uint64_t sent = shared.stamps[(v->cabinetId - 1) * STAMP_SLOTS + header->tick % STAMP_SLOTS];
+                            uint64_t arrived = nowMicros();
+                            if (sent && arrived >= sent) result.latencyMs.push_back((arrived - sent) / 1000.0f);
+                        }
+                    }
+
+                    // 一个套接字上的观众收到同样的副本，只有第一份会被解码器应用
+                    uint64_t gapsBefore = v->decoder.getGapCount();
+                    if (v->decoder.apply(buffer, size)) {
+                        const SpectatorFrame& frame = v->decoder.getFrame();
+                        result.checks.push_back({ frameKey(v->cabinetId, frame.particleSeed, frame.game.tick),
+                            frameChecksum(frame) });
+                    }
+                    result.gaps += v->decoder.getGapCount() - gapsBefore;
+                }
+            }
+            if (!any) std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+}
+
+bool LoadGenerator::runSpectators(const char* host, uint16_t port, int viewers, double seconds, int cabinets) {
+    NetAddress server;
+    if (!NetAddress::resolve(host, port, server)) {
+        std::cout << "Cannot resolve " << host << std::endl;
+        return false;
+    }
+
+    UdpSocket control;
+    HelloReplyPacket hello;
+    if (!control.open(0) || !request(control, server, PACKET_HELLO, PACKET_HELLO_REPLY, &hello, sizeof(hello))) {
+        std::cout << "No reply from server " << host << ":" << port << std::endl;
+        return false;
+    }
+    const int workerCount = std::max(1, (int)hello.workerCount);
+    cabinets = std::clamp(cabinets, 1, 255);
+    viewers = std::max(viewers, 1);
+
+    SpectatorShared shared;
+    shared.stamps.reset(new std::atomic<uint64_t>[(size_t)cabinets * STAMP_SLOTS]());
+    shared.counting = false;
+    shared.running = true;
+
+    // 机台编号从1开始，发到编号对应的工作线程
+    std::vector<SimulatedCabinet*> cabinetList;
+    for (int c = 0; c < cabinets; c++) {
+        SimulatedCabinet* cabinet = new SimulatedCabinet();
+        cabinet->id = (uint32_t)c + 1;
+        cabinet->server = server;
+        cabinet->server.addr.sin_port = htons((uint16_t)(hello.basePort + cabinet->id % workerCount));
+        cabinet->round = 0;
+        cabinet->seed = cabinetSeed(cabinet->id, 0);
+        cabinet->messages = 0;
+        cabinet->bytes = 0;
+        Simulation::reset(cabinet->state, cabinet->seed, 1);
+        cabinetList.push_back(cabinet);
+    }
+
+    // 观众按套接字分组，一个套接字上的观众订阅同一台机台
+    std::vector<ViewerSocket*> sockets;
+    for (int first = 0; first < viewers; first += SPECTATE_VIEWERS_PER_SOCKET) {
+        ViewerSocket* v = new ViewerSocket();
+        if (!v->socket.open(0)) {
+            std::cout << "Cannot open viewer socket" << std::endl;
+            delete v;
+            break;
+        }
+        v->cabinetId = (uint32_t)(sockets.size() % cabinets) + 1;
+        v->server = server;
+        v->server.addr.sin_port = htons((uint16_t)(hello.basePort + v->cabinetId % workerCount));
+        v->viewers = std::min(SPECTATE_VIEWERS_PER_SOCKET, viewers - first);
+        sockets.push_back(v);
+    }
+    if (sockets.empty()) return false;
+
+    const int threads = std::min((int)sockets.size(), 2);
+    std::vector<std::vector<ViewerSocket*>> groups(threads);
+    for (size_t i = 0; i < sockets.size(); i++) {
+        groups[i % threads].push_back(sockets[i]);
+    }
+    std::cout << "Spectator test: " << viewers << " viewers on " << sockets.size() << " sockets, " << cabinets
+        << " cabinets, server has " << workerCount << " worker(s), " << seconds << " s" << std::endl;
+
+    std::vector<ViewerResult> results(threads);
+    std::vector<std::thread> running;
+    for (int t = 0; t < threads; t++) {
+        running.emplace_back(viewerThread, std::ref(groups[t]), std::ref(shared), std::ref(results[t]));
+    }
+
+    // 机台：每帧推进、编码、发送；第一秒让观众完成订阅，不计数
+    const uint64_t tickMicros = (uint64_t)(1e6 / FPS);
+    const uint64_t start = nowMicros();
+    const uint64_t countFrom = start + 1000000;
+    const uint64_t end = start + (uint64_t)(std::max(seconds, 2.0) * 1e6);
+    uint64_t nextTick = start;
+    uint64_t countedTicks = 0;
+    uint8_t message[SERVER_MAX_PACKET];
+    SpectatorFrame frame;
+
+    while (nowMicros() < end) {
+        uint64_t now = nowMicros();
+        if (now < nextTick) {
+            std::this_thread::sleep_for(std::chrono::microseconds(nextTick - now));
+            continue;
+        }
+        nextTick += tickMicros;
+        if (now > nextTick + 250000) nextTick = now;
+        bool counting = now >= countFrom;
+        shared.counting = counting;
+        if (counting) countedTicks++;
+
+        for (SimulatedCabinet* cabinet : cabinetList) {
+            SimState& s = cabinet->state;
+            const SimPipe* next = Simulation::getNextPipe(s, 0);
+            bool jump = next && s.birdY > next->gapY + 20 && s.birdVelocity > 0;
+            uint32_t events = Simulation::step(s, jump);
+            if (events & SIM_EVENT_DIED) {
+                cabinet->round++;
+                cabinet->seed = cabinetSeed(cabinet->id, cabinet->round);
+                Simulation::reset(s, cabinet->seed, 1);
+            }
+
+            fillFrame(*cabinet, frame);
+            uint8_t spectateEvents = (jump ? SPECTATE_EVENT_JUMP : 0) | ((events & SIM_EVENT_COIN) ? SPECTATE_EVENT_COIN : 0);
+            int size = cabinet->encoder.encode(cabinet->id, frame, spectateEvents, true, message);
+            if (size <= 0) continue;
+            {
+                std::lock_guard<std::mutex> lock(shared.checksumMutex);
+                shared.checksums[frameKey(cabinet->id, frame.particleSeed, frame.game.tick)] = frameChecksum(frame);
+            }
+            shared.stamps[(cabinet->id - 1) * STAMP_SLOTS + frame.game.tick % STAMP_SLOTS] = nowMicros();
+            control.sendTo(cabinet->server, message, size);
+            if (counting) {
+                cabinet->messages++;
+                cabinet->bytes += size;
+            }
+        }
+    }
+    shared.counting = false;
+
+    // 服务器统计（观众还在订阅），然后等在途的消息到达
+    StatsReplyPacket stats;
+    bool haveStats = request(control, server, PACKET_STATS, PACKET_STATS_REPLY, &stats, sizeof(stats));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    shared.running = false;
+    for (std::thread& t : running) {
+        t.join();
+    }
+
+    // 机台发出的流
+    uint64_t keyframes = 0, deltas = 0, streamBytes = 0, expected = 0;
+    for (SimulatedCabinet* cabinet : cabinetList) {
+        keyframes += cabinet->encoder.getKeyframeCount();
+        deltas += cabinet->encoder.getDeltaCount();
+        streamBytes += cabinet->bytes;
+    }
+    for (ViewerSocket* v : sockets) {
+        expected += cabinetList[v->cabinetId - 1]->messages * v->viewers;
+    }
+
+    // 观众收到的
+    uint64_t received = 0, receivedBytes = 0, gaps = 0, checked = 0, mismatches = 0;
+    std::vector<float> latency;
+    for (ViewerResult& r : results) {
+        received += r.received;
+        receivedBytes += r.bytes;
+        gaps += r.gaps;
+        latency.insert(latency.end(), r.latencyMs.begin(), r.latencyMs.end());
+        for (const auto& check : r.checks) {
+            auto it = shared.checksums.find(check.first);
+            checked++;
+            if (it == shared.checksums.end() || it->second != check.second) mismatches++;
+        }
+    }
+    std::sort(latency.begin(), latency.end());
+
+    double tickCount = (double)std::max<uint64_t>(countedTicks, 1) * cabinets;
+    std::cout << "  stream: " << keyframes << " keyframes, " << deltas << " deltas, "
+        << streamBytes / tickCount << " bytes per tick per viewer (+28 bytes UDP/IP header)" << std::endl;
+    std::cout << "  delivered " << received << " / " << expected << " ("
+        << (expected ? received * 100.0 / expected : 0.0) << "%), " << receivedBytes / 1024.0 / 1024.0
+        << " MB, decoder gaps " << gaps << std::endl;
+    std::cout << "  relay latency ms: p50 " << percentile(latency, 0.50) << ", p99 " << percentile(latency, 0.99)
+        << ", max " << (latency.empty() ? 0.0f : latency.back()) << std::endl;
+    std::cout << "  decoded frames checked " << checked << ", mismatches " << mismatches << std::endl;
+
+    if (haveStats) {
+        uint32_t totalViewers = 0;
+        double totalBusy = 0;
+        for (int i = 0; i < stats.workerCount; i++) {
+            const WorkerStatsRecord& w = stats.workers[i];
+            std::cout << "  worker " << i << ": " << w.cabinets << " cabinets, " << w.viewers << " viewers, busy "
+                << w.busy * 100 << "%, " << w.packetsOut << " packets sent" << std::endl;
+            totalViewers += w.viewers;
+            totalBusy += w.busy;
+        }
+        std::cout << "  viewers per core: ~" << (totalBusy > 0 ? totalViewers / totalBusy : 0)
+            << " at full load" << std::endl;
+    }
+    else {
+        std::cout << "  no stats reply from server" << std::endl;
+    }
+
+    for (SimulatedCabinet* cabinet : cabinetList) delete cabinet;
+    for (ViewerSocket* v : sockets) delete v;
+    return received > 0 && mismatches == 0;
+}
@@ -0,0 +1,240 @@
+﻿// MixerMain.cpp - 混音器的无头测试与性能测试（MixerBench.exe）入口
+// 只依赖 AudioMixer，不需要声卡、SFML 或 Windows，Linux 下也能编译运行：
+//   g++ -std=c++17 -O2 -pthread src/MixerMain.cpp src/AudioMixer.cpp -o MixerBench
+//
+// 用法：
+//   MixerBench [--wav 文件] [--bench-seconds 秒数]
+//       按固定脚本（音乐循环、得分音效、超过声部上限的爆发、暂停/恢复/停止总线）渲染10秒，
+//       写成 WAV（默认 mixer_test.wav），再读回检查各时间段的音量；同一脚本渲染两次必须逐字节相同。
+//       然后用32个声部同时发声渲染 秒数（默认60）秒音频，输出每秒音频消耗的 CPU 微秒数。
+//       任何一项检查失败时返回1
+
+#include "../include/AudioMixer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+    const float SCRIPT_SECONDS = 10.0f;
+    const double PI = 3.14159265358979;
+
+    enum TestClip {
+        CLIP_MUSIC,         // 2秒立体声和弦，循环播放
+        CLIP_SCORE,         // 0.15秒单声道 22050Hz（经过重采样）
+        CLIP_HIT,           // 0.4秒单声道 11025Hz，衰减的方波
+        CLIP_LONG,          // 10秒单声道，测试声部抢占
+        CLIP_SHORT          // 200帧
+    };
+
+    // 生成正弦波 PCM（幅度 amplitude，0~1）
+    std::vector<int16_t> makeTone(double seconds, unsigned sampleRate, unsigned channels,
+        double frequency, double amplitude, bool decay) {
+        size_t frames = (size_t)(seconds * sampleRate);
+        std::vector<int16_t> pcm(frames * channels);
+        for (size_t f = 0; f < frames; f++) {
+            double t = (double)f / sampleRate;
+            double envelope = decay ? 1.0 - (double)f / frames : 1.0;
+            double value = amplitude * envelope * sin(2 * PI * frequency * t);
+            for (unsigned c = 0; c < channels; c++) {
+                pcm[f * channels + c] = (int16_t)(value * 32767);
+            }
+        }
+        return pcm;
+    }
+
+    bool loadTestClips(AudioMixer& mixer) {
+        std::vector<int16_t> music = makeTone(2.0, AudioMixer::SAMPLE_RATE, 2, 220.0, 0.3, false);
+        std::vector<int16_t> score = makeTone(0.15, 22050, 1, 880.0, 0.5, true);
+        std::vector<int16_t> hit = makeTone(0.4, 11025, 1, 150.0, 0.9, true);
+        std::vector<int16_t> longClip = makeTone(10.0, AudioMixer::SAMPLE_RATE, 1, 110.0, 0.2, false);
+        std::vector<int16_t> shortClip = makeTone(200.0 / AudioMixer::SAMPLE_RATE, AudioMixer::SAMPLE_RATE, 1, 440.0, 0.2, false);
+        return mixer.loadClip(CLIP_MUSIC, music.data(), music.size(), 2, AudioMixer::SAMPLE_RATE) &&
+            mixer.loadClip(CLIP_SCORE, score.data(), score.size(), 1, 22050) &&
+            mixer.loadClip(CLIP_HIT, hit.data(), hit.size(), 1, 11025) &&
+            mixer.loadClip(CLIP_LONG, longClip.data(), longClip.size(), 1, AudioMixer::SAMPLE_RATE) &&
+            mixer.loadClip(CLIP_SHORT, shortClip.data(), shortClip.size(), 1, AudioMixer::SAMPLE_RATE);
+    }
+
+    // 按脚本渲染到 WAV：命令在时间到达后的第一个块之前压入（块长约23毫秒）
+    bool renderScript(const char* path, double& microsPerSecond) {
+        AudioMixer mixer;
+        if (!loadTestClips(mixer)) return false;
+
+        double nextScore = 2.0;
+        bool musicStarted = false, burstDone = false, paused = false, resumed = false, stopped = false;
+        bool ok = mixer.renderToWav(path, SCRIPT_SECONDS, [&](uint64_t frame) {
+            double t = (double)frame / AudioMixer::SAMPLE_RATE;
+            // 0~1秒：静音
+            if (!musicStarted && t >= 1.0) {
+                mixer.play(CLIP_MUSIC, MIX_BUS_UI, 1.0f, true);
+                musicStarted = true;
+            }
+            // 2~5秒：每0.25秒一个得分音效
+            while (nextScore < 5.0 && t >= nextScore) {
+                mixer.play(CLIP_SCORE, MIX_BUS_SFX, 0.5f);
+                nextScore += 0.25;
+            }
+            // 3秒：同时40个撞击声，超过声部上限，总和超出 int16 范围
+            if (!burstDone && t >= 3.0) {
+                for (int i = 0; i < 40; i++) {
+                    mixer.play(CLIP_HIT, MIX_BUS_SFX, 1.0f);
+                }
+                burstDone = true;
+            }
+            // 5秒暂停音乐，6秒恢复，7秒停止
+            if (!paused && t >= 5.0) { mixer.pauseBus(MIX_BUS_UI); paused = true; }
+            if (!resumed && t >= 6.0) { mixer.resumeBus(MIX_BUS_UI); resumed = true; }
+            if (!stopped && t >= 7.0) { mixer.stopBus(MIX_BUS_UI); stopped = true; }
+        });
+        microsPerSecond = mixer.getMicrosPerSecondOfAudio();
+        return ok;
+    }
+
+    bool readFile(const char* path, std::vector<char>& bytes) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    uint32_t readLE(const char* p, int bytes) {
+        uint32_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= (uint32_t)(uint8_t)p[i] << (8 * i);
+        }
+        return value;
+    }
+
+    // 一段时间内的均方根和峰值（两个声道一起算）
+    struct Level {
+        double rms;
+        int peak;
+    };
+
+    Level measure(const std::vector<int16_t>& samples, double from, double to) {
+        size_t begin = (size_t)(from * AudioMixer::SAMPLE_RATE) * AudioMixer::CHANNELS;
+        size_t end = (size_t)(to * AudioMixer::SAMPLE_RATE) * AudioMixer::CHANNELS;
+        if (end > samples.size()) end = samples.size();
+        double sum = 0;
+        int peak = 0;
+        for (size_t i = begin; i < end; i++) {
+            sum += (double)samples[i] * samples[i];
+            peak = std::max(peak, std::abs((int)samples[i]));
+        }
+        Level level = { end > begin ? sqrt(sum / (end - begin)) : 0.0, peak };
+        return level;
+    }
+
+    bool check(bool condition, const char* name, double value) {
+        std::cout << (condition ? "  ok    " : "  FAIL  ") << name << " (" << value << ")" << std::endl;
+        return condition;
+    }
+
+    // 渲染脚本并检查输出
+    bool runScriptTest(const char* wavPath) {
+        double microsPerSecond = 0;
+        if (!renderScript(wavPath, microsPerSecond)) {
+            std::cout << "Failed to render " << wavPath << std::endl;
+            return false;
+        }
+        std::vector<char> wav, again;
+        std::string secondPath = std::string(wavPath) + ".2";
+        double ignored;
+        if (!readFile(wavPath, wav) || !renderScript(secondPath.c_str(), ignored) || !readFile(secondPath.c_str(), again)) {
+            std::cout << "Failed to read back " << wavPath << std::endl;
+            return false;
+        }
+        remove(secondPath.c_str());
+
+        std::cout << "Script: " << SCRIPT_SECONDS << " s rendered to " << wavPath << ", "
+            << microsPerSecond << " us CPU per second of audio" << std::endl;
+
+        bool ok = true;
+        const uint32_t frames = (uint32_t)(SCRIPT_SECONDS * AudioMixer::SAMPLE_RATE);
+        const uint32_t dataBytes = frames * AudioMixer::CHANNELS * sizeof(int16_t);
+        ok &= check(wav.size() == 44 + dataBytes && memcmp(wav.data(), "RIFF", 4) == 0 &&
+            memcmp(wav.data() + 8, "WAVE", 4) == 0 && readLE(&wav[22], 2) == AudioMixer::CHANNELS &&
+            readLE(&wav[24], 4) == AudioMixer::SAMPLE_RATE && readLE(&wav[40], 4) == dataBytes,
+            "WAV header and length", (double)wav.size());
+        ok &= check(wav == again, "same script renders identical bytes", (double)again.size());
+        if (wav.size() != 44 + dataBytes) return false;
+
+        std::vector<int16_t> samples(frames * AudioMixer::CHANNELS);
+        memcpy(samples.data(), wav.data() + 44, dataBytes);
+
+        // 0.3 幅度的正弦波，均方根为 0.3 / sqrt(2) * 32767
+        const double musicRms = 0.3 / sqrt(2.0) * 32767;
+        Level silence = measure(samples, 0.0, 0.95);
+        Level music = measure(samples, 1.1, 1.9);
+        Level burst = measure(samples, 3.05, 3.1);
+        Level paused = measure(samples, 5.1, 5.9);
+        Level resumed = measure(samples, 6.1, 6.9);
+        Level stopped = measure(samples, 7.1, SCRIPT_SECONDS);
+        ok &= check(silence.peak == 0, "silent before the first command", silence.peak);
+        ok &= check(fabs(music.rms - musicRms) < musicRms * 0.02, "music loop level", music.rms);
+        ok &= check(burst.peak >= 32000, "40-voice burst saturates instead of wrapping", burst.peak);
+        ok &= check(paused.peak == 0, "paused bus is silent", paused.peak);
+        ok &= check(fabs(resumed.rms - musicRms) < musicRms * 0.02, "resumed bus plays again", resumed.rms);
+        ok &= check(stopped.peak == 0, "stopped bus is silent", stopped.peak);
+        return ok;
+    }
+
+    // 声部分配：一个长声音之后播放31个已经结束的短声音，再播放一个，长声音不能被抢占
+    bool runVoiceTest() {
+        AudioMixer mixer;
+        if (!loadTestClips(mixer)) return false;
+        int16_t block[AudioMixer::MAX_BLOCK_FRAMES * AudioMixer::CHANNELS];
+
+        mixer.play(CLIP_LONG, MIX_BUS_SFX, 1.0f);
+        mixer.render(block, AudioMixer::MAX_BLOCK_FRAMES);
+        for (int i = 0; i < AudioMixer::MAX_VOICES - 1; i++) {
+            mixer.play(CLIP_SHORT, MIX_BUS_SFX, 1.0f);
+        }
+        mixer.render(block, AudioMixer::MAX_BLOCK_FRAMES);     // 短声音全部播放完
+        mixer.play(CLIP_SHORT, MIX_BUS_SFX, 1.0f);
+        mixer.render(block, 16);
+
+        std::cout << "Voices:" << std::endl;
+        return check(mixer.getActiveVoices() == 2, "idle voices are used before stealing", mixer.getActiveVoices());
+    }
+
+    // 性能：32个循环声部同时发声，渲染 seconds 秒（不写文件）
+    void runBenchmark(double seconds) {
+        AudioMixer mixer;
+        if (!loadTestClips(mixer)) return;
+        for (int i = 0; i < AudioMixer::MAX_VOICES; i++) {
+            mixer.play(i % 2 ? CLIP_MUSIC : CLIP_LONG, MIX_BUS_SFX, 0.03f, true);
+        }
+        std::vector<int16_t> block(AudioMixer::MAX_BLOCK_FRAMES * AudioMixer::CHANNELS);
+        uint64_t frames = (uint64_t)(seconds * AudioMixer::SAMPLE_RATE);
+        for (uint64_t done = 0; done < frames; done += AudioMixer::MAX_BLOCK_FRAMES) {
+            mixer.render(block.data(), AudioMixer::MAX_BLOCK_FRAMES);
+        }
+        double micros = mixer.getMicrosPerSecondOfAudio();
+        std::cout << "Benchmark: " << mixer.getActiveVoices() << " voices, " << seconds << " s of audio, "
+            << micros << " us CPU per second of audio (" << (micros > 0 ? 1e6 / micros : 0) << "x real time)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* wavPath = "mixer_test.wav";
+    double benchSeconds = 60.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--wav") == 0) wavPath = argv[i + 1];
+        else if (strcmp(argv[i], "--bench-seconds") == 0) benchSeconds = atof(argv[i + 1]);
+    }
+
+    bool ok = runScriptTest(wavPath);
+    ok = runVoiceTest() && ok;
+    runBenchmark(benchSeconds);
+
+    std::cout << (ok ? "All mixer checks passed" : "Mixer checks FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
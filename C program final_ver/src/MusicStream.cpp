@@ -0,0 +1,204 @@
+﻿#include "../include/MusicStream.h"
+#include <cstring>
+#include <fstream>
+
+MusicStream::MusicStream()
+    : looping(false), capacity(0), writePos(0), readPos(0), spaceSignal(0),
+      sourceChannels(0), resampleStep(1.0), resamplePos(1.0),
+      running(false), finished(false), failed(false),
+      underrunCount(0), underrunFrames(0) {
+    for (int c = 0; c < AudioMixer::CHANNELS; c++) {
+        lastFrame[c] = 0.0f;
+    }
+}
+
+MusicStream::~MusicStream() {
+    close();
+}
+
+bool MusicStream::open(const std::string& filepath, bool loop, size_t bufferFrames) {
+    close();
+
+    if (bufferFrames < DECODE_FRAMES) bufferFrames = DECODE_FRAMES;
+
+    path = filepath;
+    looping = loop;
+    capacity = bufferFrames;
+    ring.assign(capacity * AudioMixer::CHANNELS, 0.0f);
+    writePos = 0;
+    readPos = 0;
+    finished = false;
+    failed = false;
+    underrunCount = 0;
+    underrunFrames = 0;
+
+    running = true;
+    decodeThread = std::thread(&MusicStream::decodeThreadMain, this);
+    return true;
+}
+
+// 关闭音源：调用前必须保证混音线程已经不再读取它
+void MusicStream::close() {
+    if (running) {
+        running = false;
+        // 解码线程可能正在等待空间，改变信号值把它唤醒
+        spaceSignal.fetch_add(1, std::memory_order_release);
+        spaceSignal.notify_all();
+    }
+    if (decodeThread.joinable()) {
+        decodeThread.join();
+    }
+    decoder.close();
+    std::vector<char>().swap(fileData);
+}
+
+size_t MusicStream::getBufferedFrames() const {
+    return (size_t)(writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire));
+}
+
+size_t MusicStream::read(float* out, size_t frames) {
+    uint64_t w = writePos.load(std::memory_order_acquire);
+    uint64_t r = readPos.load(std::memory_order_relaxed);
+
+    size_t available = (size_t)(w - r);
+    size_t n = available < frames ? available : frames;
+
+    size_t start = (size_t)(r % capacity);
+    size_t first = n < capacity - start ? n : capacity - start;
+    memcpy(out, ring.data() + start * AudioMixer::CHANNELS, first * AudioMixer::CHANNELS * sizeof(float));
+    if (n > first) {
+        memcpy(out + first * AudioMixer::CHANNELS, ring.data(),
+            (n - first) * AudioMixer::CHANNELS * sizeof(float));
+    }
+
+    if (n > 0) {
+        readPos.store(r + n, std::memory_order_release);
+        spaceSignal.fetch_add(1, std::memory_order_release);
+        spaceSignal.notify_one();
+    }
+
+    // 还在首次预读（一帧都没解出来）或已经播完时不算欠载
+    if (n < frames && w > 0 && !finished.load(std::memory_order_acquire)) {
+        underrunCount.fetch_add(1, std::memory_order_relaxed);
+        underrunFrames.fetch_add(frames - n, std::memory_order_relaxed);
+    }
+    return n;
+}
+
+// 写入环形缓冲区，返回实际写入的帧数（空间不够时可能少于 frames）
+size_t MusicStream::writeRing(const float* data, size_t frames) {
+    uint64_t w = writePos.load(std::memory_order_relaxed);
+    uint64_t r = readPos.load(std::memory_order_acquire);
+
+    size_t space = capacity - (size_t)(w - r);
+    size_t n = space < frames ? space : frames;
+
+    size_t start = (size_t)(w % capacity);
+    size_t first = n < capacity - start ? n : capacity - start;
+    memcpy(ring.data() + start * AudioMixer::CHANNELS, data, first * AudioMixer::CHANNELS * sizeof(float));
+    if (n > first) {
+        memcpy(ring.data(), data + first * AudioMixer::CHANNELS,
+            (n - first) * AudioMixer::CHANNELS * sizeof(float));
+    }
+
+    writePos.store(w + n, std::memory_order_release);
+    return n;
+}
+
+// 把一块 int16 源数据转成输出格式（立体声 float、44.1kHz），结果放在 convertBuffer
+// 线性插值时需要上一块的最后一帧，所以 lastFrame 和 resamplePos 跨块保留
+size_t MusicStream::convertBlock(const int16_t* samples, size_t frames) {
+    const int channels = AudioMixer::CHANNELS;
+    size_t produced = 0;
+
+    // 下标 k：0 表示上一块的最后一帧，k >= 1 表示本块第 k-1 帧
+    auto frameAt = [&](size_t k, int c) -> float {
+        if (k == 0) return lastFrame[c];
+        unsigned sc = (sourceChannels == 1) ? 0 : (unsigned)c;
+        return samples[(k - 1) * sourceChannels + sc] / 32768.0f;
+    };
+
+    while (resamplePos < (double)frames) {
+        size_t i0 = (size_t)resamplePos;
+        float t = (float)(resamplePos - i0);
+        for (int c = 0; c < channels; c++) {
+            float a = frameAt(i0, c);
+            float b = frameAt(i0 + 1, c);
+            convertBuffer[produced * channels + c] = a + (b - a) * t;
+        }
+        produced++;
+        resamplePos += resampleStep;
+    }
+
+    resamplePos -= (double)frames;
+    for (int c = 0; c < channels; c++) {
+        lastFrame[c] = frameAt(frames, c);
+    }
+    return produced;
+}
+
+void MusicStream::decodeThreadMain() {
+    // 1. 把整个文件读进内存，之后解码不再访问磁盘
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        failed = true;
+        finished = true;
+        return;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    fileData.resize((size_t)size);
+    if (size <= 0 || !file.read(fileData.data(), size)) {
+        failed = true;
+        finished = true;
+        return;
+    }
+    file.close();
+
+    // 2. 从内存打开解码器
+    if (!decoder.openFromMemory(fileData.data(), fileData.size()) ||
+        decoder.getChannelCount() == 0 || decoder.getSampleCount() == 0) {
+        failed = true;
+        finished = true;
+        return;
+    }
+
+    sourceChannels = decoder.getChannelCount();
+    resampleStep = (double)decoder.getSampleRate() / AudioMixer::SAMPLE_RATE;
+    resamplePos = 1.0;
+    for (int c = 0; c < AudioMixer::CHANNELS; c++) {
+        lastFrame[c] = 0.0f;
+    }
+    decodeBuffer.resize(DECODE_FRAMES * sourceChannels);
+    convertBuffer.resize(((size_t)(DECODE_FRAMES / resampleStep) + 2) * AudioMixer::CHANNELS);
+
+    // 3. 解码循环：缓冲区满了就等混音线程取走数据
+    int emptyReads = 0;     // 连续读到0帧的次数；回到开头后仍然读不出数据说明文件已损坏
+    while (running) {
+        uint64_t count = decoder.read(decodeBuffer.data(), DECODE_FRAMES * sourceChannels);
+        size_t frames = (size_t)(count / sourceChannels);
+
+        if (frames == 0) {
+            if (looping && ++emptyReads < 2) {
+                decoder.seek(0);
+                continue;
+            }
+            // 文件头里有采样数但实际读不出数据（截断或损坏）：停止，否则会一直空转占满一个核心
+            if (looping) failed = true;
+            finished = true;
+            break;
+        }
+        emptyReads = 0;
+
+        size_t produced = convertBlock(decodeBuffer.data(), frames);
+        size_t done = 0;
+        while (done < produced && running) {
+            unsigned int seen = spaceSignal.load(std::memory_order_acquire);
+            size_t n = writeRing(convertBuffer.data() + done * AudioMixer::CHANNELS, produced - done);
+            done += n;
+            if (n == 0) {
+                spaceSignal.wait(seen, std::memory_order_acquire);
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+﻿#include "../include/NetSocket.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <mstcpip.h>    // SIO_UDP_CONNRESET
+typedef int socklen_t;
+static const NetHandle INVALID_HANDLE = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+static const NetHandle INVALID_HANDLE = -1;
+#endif
+
+// 几千个会话每帧各收发一个数据报，系统默认的缓冲区放不下一帧的突发
+static const int SOCKET_BUFFER_BYTES = 4 * 1024 * 1024;
+
+bool NetAddress::resolve(const char* host, uint16_t port, NetAddress& out) {
+    memset(&out.addr, 0, sizeof(out.addr));
+    out.addr.sin_family = AF_INET;
+    out.addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &out.addr.sin_addr) == 1) return true;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || !result) return false;
+    out.addr.sin_addr = ((sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+UdpSocket::UdpSocket() : handle(INVALID_HANDLE) {
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::startup() {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+void UdpSocket::cleanup() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool UdpSocket::open(uint16_t port) {
+    close();
+    handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_HANDLE) return false;
+
+    setsockopt(handle, SOL_SOCKET, SO_RCVBUF, (const char*)&SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+    setsockopt(handle, SOL_SOCKET, SO_SNDBUF, (const char*)&SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(handle, FIONBIO, &nonBlocking);
+    // 对方端口关闭时，Windows 会让下一次 recvfrom 报 WSAECONNRESET，服务器不需要这个通知
+    BOOL reportReset = FALSE;
+    DWORD ignored = 0;
+    WSAIoctl(handle, SIO_UDP_CONNRESET, &reportReset, sizeof(reportReset), NULL, 0, &ignored, NULL, NULL);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(handle, (const sockaddr*)&local, sizeof(local)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::close() {
+    if (handle == INVALID_HANDLE) return;
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    ::close(handle);
+#endif
+    handle = INVALID_HANDLE;
+}
+
+bool UdpSocket::isOpen() const {
+    return handle != INVALID_HANDLE;
+}
+
+uint16_t UdpSocket::getLocalPort() const {
+    sockaddr_in local;
+    socklen_t length = sizeof(local);
+    if (getsockname(handle, (sockaddr*)&local, &length) != 0) return 0;
+    return ntohs(local.sin_port);
+}
+
+bool UdpSocket::sendTo(const NetAddress& to, const void* data, int size) {
+    return sendto(handle, (const char*)data, size, 0, (const sockaddr*)&to.addr, sizeof(to.addr)) == size;
+}
+
+int UdpSocket::sendToMany(const NetAddress* to, int count, const void* data, int size) {
+    int sent = 0;
+#ifdef __linux__
+    const int BATCH = 64;
+    mmsghdr messages[BATCH];
+    iovec payload = { (void*)data, (size_t)size };
+    int next = 0;
+    while (next < count) {
+        int batch = count - next < BATCH ? count - next : BATCH;
+        memset(messages, 0, batch * sizeof(mmsghdr));
+        for (int i = 0; i < batch; i++) {
+            messages[i].msg_hdr.msg_name = (void*)&to[next + i].addr;
+            messages[i].msg_hdr.msg_namelen = sizeof(to[next + i].addr);
+            messages[i].msg_hdr.msg_iov = &payload;
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int result = sendmmsg(handle, messages, batch, 0);
+        if (result > 0) {
+            sent += result;
+            next += result;
+        }
+        else {
+            next++;     // 发送缓冲区满或地址无效：跳过这一个，和 sendTo 失败一样丢掉
+        }
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        if (sendTo(to[i], data, size)) sent++;
+    }
+#endif
+    return sent;
+}
+
+int UdpSocket::receiveFrom(NetAddress& from, void* buffer, int capacity) {
+    socklen_t length = sizeof(from.addr);
+    int received = (int)recvfrom(handle, (char*)buffer, capacity, 0, (sockaddr*)&from.addr, &length);
+    return received >= 0 ? received : -1;
+}
+
+bool UdpSocket::wait(int timeoutMs) {
+#ifdef _WIN32
+    WSAPOLLFD fd = { handle, POLLRDNORM, 0 };
+    return WSAPoll(&fd, 1, timeoutMs) > 0;
+#else
+    pollfd fd = { handle, POLLIN, 0 };
+    return poll(&fd, 1, timeoutMs) > 0;
+#endif
+}
@@ -0,0 +1,101 @@
+﻿#include "../include/ParticleRenderer.h"
+#include "../include/game.h"
+#include "../include/RenderList.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // 桶编号：类型（2位）| 线宽（3位，只有线条用）| 褪色后的 RGB（24位）
+    uint32_t makeBucket(int type, int lineWidth, int r, int g, int b) {
+        return ((uint32_t)type << 29) | ((uint32_t)lineWidth << 26) |
+            ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+    }
+}
+
+ParticleRenderer::ParticleRenderer() : buckets(0) {
+    keys.reserve(MAX_PARTICLES);
+
+    // 与 Particle::drawStar 的顶点算法相同（内半径 radius / 2 为整数除法），画出的像素一致
+    for (int radius = 0; radius <= PARTICLE_MAX_SIZE; radius++) {
+        for (int i = 0; i < 10; i++) {
+            float angle = 3.14159f * 2 * i / 10;
+            float r = (i % 2 == 0) ? radius : radius / 2;
+            starOffsets[radius][i].x = (int)(r * cos(angle));
+            starOffsets[radius][i].y = (int)(r * sin(angle));
+        }
+    }
+}
+
+int ParticleRenderer::draw(const std::vector<Particle>& particles) {
+    RenderList& canvas = RenderList::getInstance();
+    keys.clear();
+
+    // 剔除 + 计算桶编号
+    for (size_t i = 0; i < particles.size(); i++) {
+        const Particle& p = particles[i];
+        if (p.getLife() <= 0) continue;
+
+        float x = p.getX(), y = p.getY();
+        float reach = (float)p.getSize();
+        if (p.getType() == 2) {
+            reach += (fabsf(p.getVX()) + fabsf(p.getVY())) * 2;    // 线条的另一端
+        }
+        if (x + reach < 0 || x - reach >= SCREEN_WIDTH || y + reach < 0 || y - reach >= SCREEN_HEIGHT) continue;
+
+        int level = (int)(p.getLife() / p.getMaxLife() * PARTICLE_FADE_LEVELS + 0.5f);
+        if (level > PARTICLE_FADE_LEVELS) level = PARTICLE_FADE_LEVELS;
+        COLORREF color = p.getColor();
+        int lineWidth = p.getType() == 2 ? p.getSize() : 0;
+        uint32_t bucket = makeBucket(p.getType() & 3, lineWidth & 7,
+            GetRValue(color) * level / PARTICLE_FADE_LEVELS,
+            GetGValue(color) * level / PARTICLE_FADE_LEVELS,
+            GetBValue(color) * level / PARTICLE_FADE_LEVELS);
+        keys.push_back(((uint64_t)bucket << 32) | (uint32_t)i);
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    buckets = 0;
+    uint32_t current = UINT32_MAX;
+    bool usedLines = false;
+    for (uint64_t key : keys) {
+        uint32_t bucket = (uint32_t)(key >> 32);
+        const Particle& p = particles[(uint32_t)key];
+        int type = (int)(bucket >> 29);
+
+        // 新的桶：设置一次颜色和线型
+        if (bucket != current) {
+            current = bucket;
+            buckets++;
+            COLORREF color = RGB((bucket >> 16) & 0xFF, (bucket >> 8) & 0xFF, bucket & 0xFF);
+            canvas.setFillColor(color);
+            canvas.setLineColor(color);
+            if (type == 2) {
+                canvas.setLineStyle(PS_SOLID, (int)((bucket >> 26) & 7));
+                usedLines = true;
+            }
+        }
+
+        int cx = (int)p.getX(), cy = (int)p.getY();
+        if (type == 0) {
+            canvas.solidCircle(cx, cy, p.getSize());
+        }
+        else if (type == 1) {
+            const POINT* offsets = starOffsets[std::min(p.getSize(), PARTICLE_MAX_SIZE)];
+            POINT points[10];
+            for (int k = 0; k < 10; k++) {
+                points[k].x = cx + offsets[k].x;
+                points[k].y = cy + offsets[k].y;
+            }
+            canvas.solidPolygon(points, 10);
+        }
+        else if (type == 2) {
+            canvas.line(cx, cy, (int)(p.getX() + p.getVX() * 2), (int)(p.getY() + p.getVY() * 2));
+        }
+    }
+
+    if (usedLines) {
+        canvas.setLineStyle(PS_SOLID, 1);  // 恢复实线样式，避免影响其他绘制
+    }
+    return (int)keys.size();
+}
@@ -1,14 +1,16 @@
 #include "../include/pipemanager.h"
 #include "../include/game.h"
+#include "../include/RenderList.h"
 #include <cmath>
 
 // Pipe类的构造函数
-Pipe::Pipe(float startX, int pipeID) {
+Pipe::Pipe(float startX, int pipeID, uint32_t& rng) {
     x = startX;  // 设置初始X坐标（屏幕右侧）
 
-    // 随机生成管道间隙的Y坐标
-    // 150到（屏幕高度 - 地面高度 - 250）之间，确保管道不会太靠近上下边缘
-    gapY = 150 + rand() % (SCREEN_HEIGHT - GROUND_HEIGHT - 250);
+    // 间隙位置、硬币、颜色由 rollPipe 按固定顺序抽取，与 Simulation::spawnPipe 完全一致
+    // 间隙中心在 150 ~ 439 之间，确保管道不会太靠近上下边缘
+    const PipeRoll roll = rollPipe(rng);
+    gapY = (float)roll.gapY;
 
     width = 70;           // 管道宽度70像素
     gapHeight = 160;      // 管道间隙高度160像素（小鸟可以通过的空间）
@@ -16,17 +18,60 @@ Pipe::Pipe(float startX, int pipeID) {
     id = pipeID;          // 设置管道ID
 
     // 30%的几率生成带硬币的管道
-    hasCoin = (rand() % 100) < 30;
+    hasCoin = roll.hasCoin;
     coinY = gapY;         // 硬币在管道间隙的中间
     coinCollected = false; // 硬币初始状态为未收集
 
     // 随机选择管道颜色（4种颜色之一）
-    int colorType = rand() % 4;  // 生成0-3的随机数
-    switch (colorType) {
-    case 0: color = COLOR_PIPE_GREEN; break;   // 绿色管道
-    case 1: color = COLOR_PIPE_BLUE; break;    // 蓝色管道
-    case 2: color = COLOR_PIPE_PURPLE; break;  // 紫色管道
-    case 3: color = COLOR_PIPE_RED; break;     // 红色管道
+    color = colorFromType(roll.colorType);
+}
+
+// 按赛道记录创建管道：间隙、硬币和颜色都来自文件
+Pipe::Pipe(float startX, int pipeID, const CoursePipe& spec) {
+    x = startX;
+    gapY = spec.gapY;
+    width = 70;
+    gapHeight = 160;
+    passed = false;
+    id = pipeID;
+    hasCoin = (spec.flags & COURSE_PIPE_COIN) != 0;
+    coinY = gapY;
+    coinCollected = false;
+    color = colorFromType(spec.colorType);
+}
+
+// 按倒带缓冲里保存的状态恢复管道；已收集的硬币保存为"没有硬币"
+Pipe::Pipe(const RewindPipe& saved) {
+    x = saved.x;
+    gapY = saved.gapY;
+    width = 70;
+    gapHeight = 160;
+    passed = saved.passed != 0;
+    id = saved.id;
+    hasCoin = saved.coin != 0;
+    coinY = gapY;
+    coinCollected = false;
+    color = saved.color;
+}
+
+// 保存到倒带缓冲
+void Pipe::save(RewindPipe& out) const {
+    out.x = x;
+    out.gapY = gapY;
+    out.id = id;
+    out.color = color;
+    out.coin = (hasCoin && !coinCollected) ? 1 : 0;
+    out.passed = passed ? 1 : 0;
+    out.padding[0] = out.padding[1] = 0;
+}
+
+// 颜色编号对应的管道颜色
+COLORREF Pipe::colorFromType(int colorType) {
+    switch (colorType & 3) {
+    case 0: return COLOR_PIPE_GREEN;    // 绿色管道
+    case 1: return COLOR_PIPE_BLUE;     // 蓝色管道
+    case 2: return COLOR_PIPE_PURPLE;   // 紫色管道
+    default: return COLOR_PIPE_RED;     // 红色管道
     }
 }
 
@@ -51,10 +96,11 @@ void Pipe::draw() const {
 
 // 绘制单个管道部分（顶部或底部）
 void Pipe::drawPipe(float px, float top, float bottom, bool isBottom) const {
+    RenderList& canvas = RenderList::getInstance();
     // 绘制管道主体（矩形）
-    setfillcolor(color);  // 设置管道颜色
+    canvas.setFillColor(color);  // 设置管道颜色
     // 填充管道矩形（从px到px+width，从top到bottom）
-    fillrectangle((int)px, (int)top, (int)(px + width), (int)bottom);
+    canvas.fillRectangle((int)px, (int)top, (int)(px + width), (int)bottom);
 
     // 绘制管道顶部/底部的盖子（稍暗的颜色，增加立体感）
     COLORREF capColor = RGB(
@@ -62,22 +108,22 @@ void Pipe::drawPipe(float px, float top, float bottom, bool isBottom) const {
         (int)(GetGValue(color) * 0.8),  // G通道乘以0.8
         (int)(GetBValue(color) * 0.8)   // B通道乘以0.8
     );
-    setfillcolor(capColor);  // 设置盖子颜色
+    canvas.setFillColor(capColor);  // 设置盖子颜色
 
     // 根据是顶部管道还是底部管道，绘制不同位置的盖子
     if (!isBottom) {
         // 顶部管道：在底部绘制盖子（向下突出）
-        fillrectangle((int)px - 10, (int)bottom - 20,
+        canvas.fillRectangle((int)px - 10, (int)bottom - 20,
             (int)(px + width + 10), (int)bottom);
     }
     else {
         // 底部管道：在顶部绘制盖子（向上突出）
-        fillrectangle((int)px - 10, (int)top,
+        canvas.fillRectangle((int)px - 10, (int)top,
             (int)(px + width + 10), (int)top + 20);
     }
 
     // 绘制管道纹理（水平条纹，增加细节）
-    setfillcolor(RGB(
+    canvas.setFillColor(RGB(
         (int)(GetRValue(color) * 0.6),  // 更暗的颜色
         (int)(GetGValue(color) * 0.6),
         (int)(GetBValue(color) * 0.6)
@@ -88,14 +134,14 @@ void Pipe::drawPipe(float px, float top, float bottom, bool isBottom) const {
     if (!isBottom) {
         // 顶部管道：从顶部开始绘制水平条纹
         for (int y = (int)top + 10; y < (int)bottom - 25; y += textureSpacing) {
-            fillrectangle((int)px + 10, y,
+            canvas.fillRectangle((int)px + 10, y,
                 (int)(px + width - 10), y + 10);  // 绘制一个条纹
         }
     }
     else {
         // 底部管道：从顶部+30开始绘制水平条纹
         for (int y = (int)top + 30; y < (int)bottom - 10; y += textureSpacing) {
-            fillrectangle((int)px + 10, y,
+            canvas.fillRectangle((int)px + 10, y,
                 (int)(px + width - 10), y + 10);  // 绘制一个条纹
         }
     }
@@ -103,22 +149,23 @@ void Pipe::drawPipe(float px, float top, float bottom, bool isBottom) const {
 
 // 绘制硬币方法
 void Pipe::drawCoin() const {
+    RenderList& canvas = RenderList::getInstance();
     float coinX = x + width / 2;  // 硬币在管道中间的X坐标
 
     // 绘制硬币主体（金色圆形）
-    setfillcolor(RGB(255, 215, 0));  // 金色填充
-    setlinecolor(RGB(218, 165, 32)); // 深金色边框
-    solidcircle((int)coinX, (int)coinY, 12);  // 绘制12像素半径的圆形
+    canvas.setFillColor(RGB(255, 215, 0));  // 金色填充
+    canvas.setLineColor(RGB(218, 165, 32)); // 深金色边框
+    canvas.solidCircle((int)coinX, (int)coinY, 12);  // 绘制12像素半径的圆形
 
     // 绘制硬币外圈（亮金色边框）
-    setlinecolor(RGB(255, 255, 0));  // 亮黄色边框
-    circle((int)coinX, (int)coinY, 12);  // 绘制圆形边框
+    canvas.setLineColor(RGB(255, 255, 0));  // 亮黄色边框
+    canvas.circle((int)coinX, (int)coinY, 12);  // 绘制圆形边框
 
     // 在硬币上绘制"$"符号
-    settextstyle(14, 0, _T("Arial"));  // 14号字体
-    settextcolor(RGB(255, 255, 255));  // 白色文字
-    setbkmode(TRANSPARENT);            // 透明背景
-    outtextxy((int)coinX - 4, (int)coinY - 7, L"$");  // 居中显示$符号
+    canvas.setTextStyle(14, 0, _T("Arial"));  // 14号字体
+    canvas.setTextColor(RGB(255, 255, 255));  // 白色文字
+    canvas.setBkMode(TRANSPARENT);            // 透明背景
+    canvas.outText((int)coinX - 4, (int)coinY - 7, L"$");  // 居中显示$符号
 }
 
 // 获取顶部管道的碰撞矩形
@@ -193,8 +240,10 @@ bool Pipe::isOffScreen() const {
 }
 
 // PipeManager类的构造函数
-PipeManager::PipeManager() {
+PipeManager::PipeManager() : course(nullptr), courseCursor(0) {
+    setSeed(0);
     pipes.clear();  // 初始化时清空管道向量
+    pipes.reserve(MAX_PIPES);  // 预先分配，游戏中生成管道不再扩容
 }
 
 // 更新所有管道
@@ -228,6 +277,7 @@ void PipeManager::draw() const {
 
 // 绘制所有管道的碰撞框（用于调试）
 void PipeManager::drawHitboxes() const {
+    RenderList& canvas = RenderList::getInstance();
     // 遍历所有管道
     for (const auto& pipe : pipes) {
         // 获取顶部和底部管道的碰撞矩形
@@ -235,10 +285,10 @@ void PipeManager::drawHitboxes() const {
         RECT bottomRect = pipe.getBottomRect();
 
         // 绘制顶部管道碰撞框
-        rectangle(topRect.left, topRect.top, topRect.right, topRect.bottom);
+        canvas.rectangle(topRect.left, topRect.top, topRect.right, topRect.bottom);
 
         // 绘制底部管道碰撞框
-        rectangle(bottomRect.left, bottomRect.top, bottomRect.right, bottomRect.bottom);
+        canvas.rectangle(bottomRect.left, bottomRect.top, bottomRect.right, bottomRect.bottom);
     }
 }
 
@@ -283,7 +333,33 @@ bool PipeManager::checkPipePassed(float birdX) const {
     return passedAny;  // 返回是否通过了任何管道
 }
 
+// 获取小鸟前方的第一根管道（管道按生成顺序排列，X坐标递增）
+const Pipe* PipeManager::getNextPipe(float birdX) const {
+    for (const auto& pipe : pipes) {
+        if (pipe.getX() + 70 >= birdX) {
+            return &pipe;
+        }
+    }
+    return nullptr;
+}
+
+// 倒带：恢复保存的管道（容量已预留，不会分配内存）
+void PipeManager::restorePipes(const RewindPipe* saved, int count, uint64_t cursor, uint32_t rngState) {
+    pipes.clear();
+    for (int i = 0; i < count; i++) {
+        pipes.push_back(Pipe(saved[i]));
+    }
+    courseCursor = cursor;
+    rng = rngState;
+}
+
 // 添加新管道
 void PipeManager::addPipe(float startX, int pipeID) {
-    pipes.push_back(Pipe(startX, pipeID));  // 在向量末尾添加新管道
+    if (course) {
+        // 比赛模式：顺序读取赛道的下一条记录，O(1)，不调用随机数
+        if (courseCursor >= course->getPipeCount()) return;  // 赛道已经结束
+        pipes.push_back(Pipe(startX, pipeID, course->getPipe(courseCursor++)));
+        return;
+    }
+    pipes.push_back(Pipe(startX, pipeID, rng));  // 在向量末尾添加新管道
 }
\ No newline at end of file
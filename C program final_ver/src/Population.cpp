@@ -0,0 +1,339 @@
+﻿#include "../include/Population.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define POPULATION_USE_SSE2 1
+#endif
+
+namespace {
+    const float TICK = (float)(1.0 / FPS);
+    const float GROUND_Y = (float)(SCREEN_HEIGHT - GROUND_HEIGHT - SIM_BIRD_RADIUS);
+    const int BIRD_HALF = SIM_BIRD_RADIUS - SIM_BIRD_MARGIN;   // 碰撞框半边长
+    const int MIN_BIRDS_PER_THREAD = 4096;                     // 小鸟太少时线程同步的开销比计算还大
+}
+
+Population::Population()
+    : birdCount(0), aliveCount(0), generation(0), pendingWorkers(0), stopping(false),
+      currentJumps(nullptr) {
+    memset(&world, 0, sizeof(world));
+}
+
+Population::~Population() {
+    stopWorkers();
+}
+
+void Population::reset(int count, uint32_t seed, int difficulty) {
+    Simulation::reset(world, seed, difficulty);
+
+    birdCount = count > 0 ? count : 0;
+    aliveCount = birdCount;
+    birdY.assign(birdCount, world.birdY);
+    birdVelocity.assign(birdCount, 0.0f);
+    ids.resize(birdCount);
+    for (int i = 0; i < birdCount; i++) {
+        ids[i] = i;
+    }
+    lastCoinPipe.assign(birdCount, -1);
+    dead.assign(birdCount, 0);
+
+    deathTick.assign(birdCount, 0);
+    deathScore.assign(birdCount, 0);
+    coins.assign(birdCount, 0);
+}
+
+void Population::setThreadCount(int threads) {
+    stopWorkers();
+    stopping = false;
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&Population::workerLoop, this, (int)workers.size());
+    }
+}
+
+int Population::getScore(int id) const {
+    int passScore = deathTick[id] ? deathScore[id] : world.score;
+    return passScore + coins[id] / 2;   // 每枚硬币 +10 硬币、+5 分
+}
+
+// ============================================================
+// 每帧更新
+// ============================================================
+
+int Population::step(const uint8_t* jumps) {
+    if (aliveCount == 0) return 0;
+
+    // 与 Simulation::step 的顺序一致；所有小鸟共用的部分只算一次
+    world.tick++;
+    world.gameTime += TICK;
+    Simulation::updateCombo(world);
+    Simulation::movePipes(world);
+
+    // 与小鸟X范围重叠的管道，所有小鸟共用
+    Simulation::buildColumn(world, column);
+
+    if (!workers.empty() && aliveCount >= MIN_BIRDS_PER_THREAD * 2) {
+        runParallel(jumps);
+    }
+    else {
+        updateBirds(0, aliveCount, jumps);
+    }
+
+    compact();
+
+    // 计分、升级、生成管道只和"还有没有小鸟活着"有关
+    if (aliveCount > 0) {
+        Simulation::updatePassAndSpawn(world);
+    }
+    return aliveCount;
+}
+
+void Population::updateBirds(int begin, int end, const uint8_t* jumps) {
+    float* y = birdY.data();
+    float* v = birdVelocity.data();
+    int i = begin;
+
+#ifdef POPULATION_USE_SSE2
+    const __m128 gravity = _mm_set1_ps(world.gravity);
+    const __m128 jumpForce = _mm_set1_ps(world.jumpForce);
+    const __m128 ceiling = _mm_set1_ps((float)SIM_BIRD_RADIUS);
+    const __m128 ground = _mm_set1_ps(GROUND_Y);
+    const __m128i half = _mm_set1_epi32(BIRD_HALF);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 4 <= end; i += 4) {
+        // 4个跳跃字节展开成4个32位掩码
+        int packed;
+        memcpy(&packed, jumps + i, 4);
+        __m128i j = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+        __m128 jumpMask = _mm_castsi128_ps(_mm_cmpgt_epi32(j, zero));
+
+        // Bird::update：跳跃、重力、上下边界
+        __m128 vel = _mm_loadu_ps(v + i);
+        __m128 pos = _mm_loadu_ps(y + i);
+        vel = _mm_or_ps(_mm_and_ps(jumpMask, jumpForce), _mm_andnot_ps(jumpMask, vel));
+        vel = _mm_add_ps(vel, gravity);
+        pos = _mm_add_ps(pos, vel);
+
+        __m128 low = _mm_cmplt_ps(pos, ceiling);
+        pos = _mm_or_ps(_mm_and_ps(low, ceiling), _mm_andnot_ps(low, pos));
+        vel = _mm_andnot_ps(low, vel);
+        __m128 high = _mm_cmpgt_ps(pos, ground);
+        pos = _mm_or_ps(_mm_and_ps(high, ground), _mm_andnot_ps(high, pos));
+        vel = _mm_andnot_ps(high, vel);
+
+        _mm_storeu_ps(y + i, pos);
+        _mm_storeu_ps(v + i, vel);
+
+        // 落地，或者与重叠管道的上下两截相交（Y 已经 >= 半径，碰撞框不会越过屏幕上边和地面）
+        __m128i deadMask = _mm_castps_si128(_mm_cmpge_ps(pos, ground));
+        __m128i iy = _mm_cvttps_epi32(pos);     // 截断取整，与 (int) 转换一致
+        __m128i top = _mm_sub_epi32(iy, half);
+        __m128i bottom = _mm_add_epi32(iy, half);
+        for (int s = 0; s < column.count; s++) {
+            deadMask = _mm_or_si128(deadMask, _mm_cmpgt_epi32(_mm_set1_epi32(column.pipes[s].gapTop), top));
+            deadMask = _mm_or_si128(deadMask, _mm_cmpgt_epi32(bottom, _mm_set1_epi32(column.pipes[s].gapBottom)));
+        }
+        int deadBits = _mm_movemask_ps(_mm_castsi128_ps(deadMask));
+        dead[i] = deadBits & 1;
+        dead[i + 1] = (deadBits >> 1) & 1;
+        dead[i + 2] = (deadBits >> 2) & 1;
+        dead[i + 3] = (deadBits >> 3) & 1;
+
+        // 硬币：只有极少数帧有硬币经过小鸟，命中后逐只处理
+        int collected = deadBits;
+        for (int s = 0; s < column.count; s++) {
+            if (column.pipes[s].coinPipe < 0) continue;
+            __m128i hit = _mm_and_si128(_mm_cmpgt_epi32(_mm_set1_epi32(column.pipes[s].coinBottom), top),
+                _mm_cmpgt_epi32(bottom, _mm_set1_epi32(column.pipes[s].coinTop)));
+            int hitBits = _mm_movemask_ps(_mm_castsi128_ps(hit)) & ~collected;
+            for (int k = 0; k < 4; k++) {
+                if (!(hitBits & (1 << k)) || lastCoinPipe[i + k] == column.pipes[s].coinPipe) continue;
+                lastCoinPipe[i + k] = column.pipes[s].coinPipe;
+                coins[ids[i + k]] += 10;
+                collected |= 1 << k;   // 每帧最多收集一枚
+            }
+        }
+    }
+#endif
+
+    // 标量实现（剩余不足4只，或不支持 SSE2）
+    for (; i < end; i++) {
+        uint32_t events = Simulation::stepBird(world, column, y[i], v[i], lastCoinPipe[i], jumps[i] != 0);
+        dead[i] = (events & SIM_EVENT_DIED) != 0;
+        if (events & SIM_EVENT_COIN) coins[ids[i]] += 10;
+    }
+}
+
+// 把本帧死亡的小鸟移出存活数组（保持存活小鸟的相对顺序）
+void Population::compact() {
+    int kept = 0;
+    for (int i = 0; i < aliveCount; i++) {
+        if (dead[i]) {
+            deathTick[ids[i]] = world.tick;
+            deathScore[ids[i]] = world.score;
+            continue;
+        }
+        if (kept != i) {
+            birdY[kept] = birdY[i];
+            birdVelocity[kept] = birdVelocity[i];
+            ids[kept] = ids[i];
+            lastCoinPipe[kept] = lastCoinPipe[i];
+        }
+        kept++;
+    }
+    aliveCount = kept;
+}
+
+// ============================================================
+// 多线程
+// ============================================================
+
+void Population::runParallel(const uint8_t* jumps) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentJumps = jumps;
+        pendingWorkers = (int)workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    // 调用线程处理第0段
+    int threads = (int)workers.size() + 1;
+    int chunk = ((aliveCount + threads - 1) / threads + 3) & ~3;   // 按4对齐，SIMD 内核不跨段
+    updateBirds(0, chunk < aliveCount ? chunk : aliveCount, jumps);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]() { return pendingWorkers == 0; });
+}
+
+void Population::workerLoop(int index) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        startCondition.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        lock.unlock();
+
+        int threads = (int)workers.size() + 1;
+        int chunk = ((aliveCount + threads - 1) / threads + 3) & ~3;
+        int begin = chunk * (index + 1);
+        int end = begin + chunk;
+        if (end > aliveCount) end = aliveCount;
+        if (begin < end) {
+            updateBirds(begin, end, currentJumps);
+        }
+
+        lock.lock();
+        if (--pendingWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+void Population::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+// ============================================================
+// 吞吐量测试
+// ============================================================
+
+namespace {
+    // 测试用的控制器：对准下一根管道的间隙，每只小鸟有自己的偏移，模拟一个多样化的种群
+    bool decideJump(const SimState& world, float y, float velocity, float offset) {
+        const SimPipe* next = Simulation::getNextPipe(world, 0);
+        float target = next ? next->gapY : (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f;
+        return y > target + offset && velocity > 0;
+    }
+}
+
+bool Population::benchmark(int count, int ticks, int threads) {
+    Population population;
+    population.setThreadCount(threads);
+
+    std::vector<float> offsets(count);
+    uint32_t rng = 12345;
+    for (int i = 0; i < count; i++) {
+        offsets[i] = (float)(nextRandom(rng) % 121) - 40.0f;   // -40 ~ 80
+    }
+    std::vector<uint8_t> jumps(count);
+
+    const int difficulty = 1;
+    uint32_t seed = 1;
+    population.reset(count, seed, difficulty);
+
+    // 抽查：第一代里几只小鸟的结果必须与单独用 Simulation 跑的一致
+    bool verified = false;
+    bool ok = true;
+    auto verify = [&]() {
+        int samples = count < 8 ? count : 8;
+        for (int s = 0; s < samples; s++) {
+            int id = (int)((uint64_t)s * count / samples);
+            SimState single;
+            Simulation::reset(single, seed, difficulty);
+            while (single.alive && single.tick < population.getWorld().tick) {
+                Simulation::step(single, decideJump(single, single.birdY, single.birdVelocity, offsets[id]));
+            }
+            uint32_t expectedDeath = single.alive ? 0 : single.tick;
+            if (expectedDeath != population.getDeathTick(id) || single.score != population.getScore(id)) {
+                std::cout << "Population mismatch: bird " << id << " died at " << population.getDeathTick(id)
+                    << " score " << population.getScore(id) << ", expected " << expectedDeath
+                    << " score " << single.score << std::endl;
+                ok = false;
+            }
+        }
+        verified = true;
+    };
+
+    uint64_t birdTicks = 0;
+    double stepSeconds = 0;
+    int generations = 1;
+    int bestScore = 0;
+    for (int t = 0; t < ticks; t++) {
+        const SimState& world = population.getWorld();
+        int alive = population.getAliveCount();
+        for (int slot = 0; slot < alive; slot++) {
+            jumps[slot] = decideJump(world, population.getBirdY(slot), population.getBirdVelocity(slot),
+                offsets[population.getBirdId(slot)]);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        int remaining = population.step(jumps.data());
+        stepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        birdTicks += alive;
+
+        if (remaining == 0) {
+            // 整代死亡：记录成绩，开始下一代
+            if (!verified) verify();
+            for (int id = 0; id < count; id++) {
+                if (population.getScore(id) > bestScore) bestScore = population.getScore(id);
+            }
+            population.reset(count, ++seed, difficulty);
+            generations++;
+        }
+    }
+    if (!verified) verify();
+    for (int id = 0; id < count; id++) {
+        if (population.getScore(id) > bestScore) bestScore = population.getScore(id);
+    }
+
+    double birdsPerSecond = stepSeconds > 0 ? birdTicks / stepSeconds : 0;
+    std::cout << "Population: " << count << " birds, " << population.getThreadCount() << " thread(s), "
+        << ticks << " ticks, " << generations << " generation(s)" << std::endl;
+    std::cout << "  step time " << stepSeconds * 1000.0 << " ms, "
+        << birdsPerSecond / 1e6 << " M bird-ticks/s, "
+        << (birdsPerSecond / 100000.0) / FPS << "x real time at 100k birds" << std::endl;
+    std::cout << "  best score " << bestScore << (ok ? ", matches Simulation" : ", MISMATCH") << std::endl;
+    return ok;
+}
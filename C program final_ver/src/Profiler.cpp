@@ -0,0 +1,122 @@
+﻿#include "../include/Profiler.h"
+#include <ctime>
+#include <fstream>
+
+std::atomic<bool> Profiler::enabled(false);
+
+// 当前线程的缓冲区指针，第一次记录时注册
+static thread_local ProfileThreadBuffer* threadBuffer = nullptr;
+// 注册之前设置的线程名，注册时拷进缓冲区
+static thread_local const char* pendingThreadName = nullptr;
+
+Profiler::Profiler()
+    : nextThreadId(1), framesRemaining(0), captureStartNs(0), frameStartNs(0) {
+}
+
+ProfileThreadBuffer* Profiler::getThreadBuffer() {
+    if (!threadBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(std::make_unique<ProfileThreadBuffer>());
+        threadBuffer = buffers.back().get();
+        threadBuffer->threadId = nextThreadId++;
+        threadBuffer->writeIndex = 0;
+        if (pendingThreadName) threadBuffer->threadName = pendingThreadName;
+    }
+    return threadBuffer;
+}
+
+void Profiler::record(const char* name, int64_t startNs, int64_t endNs) {
+    ProfileThreadBuffer* buffer = getThreadBuffer();
+    uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+    ProfileEvent& event = buffer->events[index % ProfileThreadBuffer::CAPACITY];
+    event.name = name;
+    event.startNs = startNs;
+    event.endNs = endNs;
+    buffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* name) {
+    pendingThreadName = name;
+    if (threadBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadBuffer->threadName = name;
+    }
+}
+
+void Profiler::beginCapture(int frames) {
+    if (framesRemaining > 0 || frames <= 0) return;
+    framesRemaining = frames;
+    captureStartNs = nowNs();
+    frameStartNs = captureStartNs;
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+bool Profiler::endFrame() {
+    if (framesRemaining <= 0) return false;
+
+    int64_t now = nowNs();
+    record("Frame", frameStartNs, now);
+    frameStartNs = now;
+
+    if (--framesRemaining == 0) {
+        enabled.store(false, std::memory_order_relaxed);
+
+        // 文件名带时间戳，方便从玩家机器上收集多份
+        char path[64];
+        time_t t = time(nullptr);
+        tm local;
+        localtime_s(&local, &t);
+        strftime(path, sizeof(path), "trace_%Y%m%d_%H%M%S.json", &local);
+        if (writeTrace(path)) {
+            lastTracePath = path;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 写出 Chrome trace 格式：每个区段是一个 "X"（完整事件），时间单位为微秒
+bool Profiler::writeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // 采集已经停止，先记下每个线程的写入位置，只导出这之前写完的记录。
+    // 其他线程（例如音频线程）可能还在执行停止前进入的那一次 record()，
+    // 它写的是下标 end 的槽位，也就是环形缓冲区里最旧的那一条，所以最旧的一条也不导出
+    std::vector<uint64_t> ends;
+    ends.reserve(buffers.size());
+    for (const auto& buffer : buffers) {
+        ends.push_back(buffer->writeIndex.load(std::memory_order_acquire));
+    }
+
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (size_t b = 0; b < buffers.size(); b++) {
+        const auto& buffer = buffers[b];
+        if (!buffer->threadName.empty()) {
+            file << (first ? "" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+            first = false;
+        }
+
+        // 只导出环形缓冲区里仍然有效、且发生在本次采集期间的记录
+        uint64_t end = ends[b];
+        uint64_t begin = end >= ProfileThreadBuffer::CAPACITY ? end - ProfileThreadBuffer::CAPACITY + 1 : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const ProfileEvent& event = buffer->events[i % ProfileThreadBuffer::CAPACITY];
+            if (event.startNs < captureStartNs) continue;
+
+            file << (first ? "" : ",\n")
+                << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << (event.startNs - captureStartNs) / 1000.0
+                << ",\"dur\":" << (event.endNs - event.startNs) / 1000.0 << "}";
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return file.good();
+}
@@ -0,0 +1,473 @@
+﻿#include "../include/RenderList.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+    // 命令用到的状态
+    enum StateMask : uint32_t {
+        MASK_FILL = 1,          // 填充颜色
+        MASK_LINE = 2,          // 线条颜色、线型
+        MASK_TEXT = 4           // 文字颜色、字体、背景模式
+    };
+
+    // 帧开始时设备状态"未知"：与任何真实值和 RENDER_ANY 都不相等，第一次使用时一定会设置
+    const uint32_t UNKNOWN_COLOR = 0xFFFFFFFEu;
+    const int16_t UNKNOWN = -2;
+
+    const size_t STATE_LOOKUP_SIZE = 4096;      // 2 的幂
+    const size_t METRICS_SIZE = 512;            // 2 的幂
+
+    uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 1469598103934665603ull) {
+        const uint8_t* p = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // 把 image 的 (srcX, srcY) 起 width x height 的区域按预乘 alpha 混合到当前绘图设备的 (x, y)。
+    // alpha 为0的像素跳过、255的直接复制，其余每个像素两次乘法（红蓝两个通道一起算）
+    void alphaBlit(int x, int y, int width, int height, const IMAGE* image, int srcX, int srcY) {
+        IMAGE* target = GetWorkingImage();
+        DWORD* dst = GetImageBuffer(target);
+        const int targetW = target ? target->getwidth() : getwidth();
+        const int targetH = target ? target->getheight() : getheight();
+        const DWORD* src = GetImageBuffer(const_cast<IMAGE*>(image));
+        const int imageW = image->getwidth(), imageH = image->getheight();
+
+        if (x < 0) { srcX -= x; width += x; x = 0; }
+        if (y < 0) { srcY -= y; height += y; y = 0; }
+        width = std::min(width, std::min(targetW - x, imageW - srcX));
+        height = std::min(height, std::min(targetH - y, imageH - srcY));
+
+        for (int row = 0; row < height; row++) {
+            const DWORD* s = src + (srcY + row) * imageW + srcX;
+            DWORD* d = dst + (y + row) * targetW + x;
+            for (int i = 0; i < width; i++) {
+                DWORD p = s[i];
+                DWORD alpha = p >> 24;
+                if (alpha == 0) continue;
+                if (alpha == 255) {
+                    d[i] = p & 0xFFFFFF;
+                    continue;
+                }
+                DWORD inverse = 255 - alpha, q = d[i];
+                DWORD rb = (p & 0xFF00FF) + ((((q & 0xFF00FF) * inverse + 0x800080) >> 8) & 0xFF00FF);
+                DWORD g = (p & 0xFF00) + ((((q & 0xFF00) * inverse + 0x8000) >> 8) & 0xFF00);
+                d[i] = rb | g;
+            }
+        }
+    }
+
+    int16_t clampCoord(int value) {
+        return (int16_t)std::max(SHRT_MIN, std::min(SHRT_MAX, value));
+    }
+
+    template <typename T>
+    bool sameArray(const std::vector<T>& a, const std::vector<T>& b) {
+        return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    template <typename T>
+    void append(std::vector<uint8_t>& out, const T& value) {
+        const uint8_t* p = (const uint8_t*)&value;
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    RenderState unknownState() {
+        RenderState state;
+        state.fillColor = state.lineColor = state.textColor = UNKNOWN_COLOR;
+        state.lineStyle = state.lineWidth = UNKNOWN;
+        state.fontHeight = state.fontWidth = state.fontFace = UNKNOWN;
+        state.bkMode = UNKNOWN;
+        return state;
+    }
+
+#pragma pack(push, 1)
+    struct RenderStreamHeader {
+        char magic[4];          // "FBRL"
+        uint16_t version;
+        uint16_t faceCount;
+        uint32_t stateCount;
+        uint32_t commandCount;
+        uint32_t pointCount;
+        uint32_t textLength;    // UTF-16 字符数（含每段文字结尾的0）
+        uint32_t imageCount;    // 图片只记数量，指针在不同的运行之间没有意义
+    };
+#pragma pack(pop)
+}
+
+bool RenderState::operator==(const RenderState& other) const {
+    return memcmp(this, &other, sizeof(RenderState)) == 0;
+}
+
+RenderList::RenderList()
+    : batchCount(0), stateChanges(0), unsortedStateChanges(0), skippedFrames(0) {
+    // 预留的容量足够一帧使用，之后稳定运行时不再分配
+    const size_t COMMANDS = 4096;
+    for (std::vector<RenderState>* v : { &states, &previousStates }) v->reserve(1024);
+    for (std::vector<RenderCommand>* v : { &commands, &previousCommands }) v->reserve(COMMANDS);
+    for (std::vector<POINT>* v : { &points, &previousPoints }) v->reserve(1024);
+    for (std::vector<wchar_t>* v : { &text, &previousText }) v->reserve(16 * 1024);
+    for (std::vector<const IMAGE*>* v : { &images, &previousImages }) v->reserve(16);
+    batches.reserve(COMMANDS);
+    nextInBatch.reserve(COMMANDS);
+    stateLookup.assign(STATE_LOOKUP_SIZE, -1);
+    metrics.assign(METRICS_SIZE, TextMetrics{ 0, 0, 0 });
+    faces.reserve(8);
+
+    // 录制中的状态从 EasyX 的默认值开始；字体在第一次 setTextStyle 之前保持设备上的字体
+    current = unknownState();
+    current.fillColor = WHITE;
+    current.lineColor = WHITE;
+    current.textColor = WHITE;
+    current.lineStyle = PS_SOLID;
+    current.lineWidth = 1;
+    current.fontHeight = current.fontWidth = current.fontFace = RENDER_ANY;
+    current.bkMode = OPAQUE;
+    device = unknownState();
+}
+
+void RenderList::begin() {
+    states.swap(previousStates);
+    commands.swap(previousCommands);
+    points.swap(previousPoints);
+    text.swap(previousText);
+    images.swap(previousImages);
+
+    states.clear();
+    commands.clear();
+    points.clear();
+    text.clear();
+    images.clear();
+    std::fill(stateLookup.begin(), stateLookup.end(), -1);
+
+    // 别的代码可能直接调用过 EasyX（重新 initgraph、基准测试），每帧重新确认一次设备状态
+    device = unknownState();
+}
+
+void RenderList::setTextStyle(int height, int width, const wchar_t* face) {
+    int index = -1;
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (faces[i] == face) {
+            index = (int)i;
+            break;
+        }
+    }
+    if (index < 0) {
+        faces.push_back(face);
+        index = (int)faces.size() - 1;
+    }
+    current.fontHeight = (int16_t)height;
+    current.fontWidth = (int16_t)width;
+    current.fontFace = (int16_t)index;
+}
+
+uint16_t RenderList::internState(uint32_t stateMask) {
+    RenderState state = current;
+    if (!(stateMask & MASK_FILL)) {
+        state.fillColor = RENDER_ANY_COLOR;
+    }
+    if (!(stateMask & MASK_LINE)) {
+        state.lineColor = RENDER_ANY_COLOR;
+        state.lineStyle = state.lineWidth = RENDER_ANY;
+    }
+    if (!(stateMask & MASK_TEXT)) {
+        state.textColor = RENDER_ANY_COLOR;
+        state.fontHeight = state.fontWidth = state.fontFace = state.bkMode = RENDER_ANY;
+    }
+
+    // 最常见的情况：与上一条命令的状态相同
+    if (!states.empty() && states.back() == state) {
+        return (uint16_t)(states.size() - 1);
+    }
+
+    size_t slot = (size_t)fnv1a(&state, sizeof(state)) & (STATE_LOOKUP_SIZE - 1);
+    for (size_t probe = 0; probe < STATE_LOOKUP_SIZE; probe++) {
+        int32_t index = stateLookup[slot];
+        if (index < 0) {
+            if (states.size() >= UINT16_MAX) break;
+            stateLookup[slot] = (int32_t)states.size();
+            states.push_back(state);
+            return (uint16_t)(states.size() - 1);
+        }
+        if (states[index] == state) {
+            return (uint16_t)index;
+        }
+        slot = (slot + 1) & (STATE_LOOKUP_SIZE - 1);
+    }
+
+    // 查找表已满：不再去重（只影响合并的效果）
+    states.push_back(state);
+    return (uint16_t)(states.size() - 1);
+}
+
+void RenderList::add(RenderOp op, uint32_t stateMask, int left, int top, int right, int bottom,
+    int32_t a, int32_t b, int32_t c, int32_t d) {
+    RenderCommand command;
+    command.op = op;
+    command.reserved = 0;
+    command.state = internState(stateMask);
+    command.left = clampCoord(left);
+    command.top = clampCoord(top);
+    command.right = clampCoord(right);
+    command.bottom = clampCoord(bottom);
+    command.a = a;
+    command.b = b;
+    command.c = c;
+    command.d = d;
+    commands.push_back(command);
+}
+
+void RenderList::clear() {
+    add(RENDER_CLEAR, 0, SHRT_MIN, SHRT_MIN, SHRT_MAX, SHRT_MAX, 0, 0, 0, 0);
+}
+
+void RenderList::solidCircle(int x, int y, int radius) {
+    add(RENDER_SOLID_CIRCLE, MASK_FILL, x - radius - 1, y - radius - 1, x + radius + 1, y + radius + 1,
+        x, y, radius, 0);
+}
+
+void RenderList::circle(int x, int y, int radius) {
+    int r = radius + current.lineWidth + 1;
+    add(RENDER_CIRCLE, MASK_LINE, x - r, y - r, x + r, y + r, x, y, radius, 0);
+}
+
+void RenderList::solidRectangle(int left, int top, int right, int bottom) {
+    add(RENDER_SOLID_RECTANGLE, MASK_FILL, left - 1, top - 1, right + 1, bottom + 1, left, top, right, bottom);
+}
+
+void RenderList::fillRectangle(int left, int top, int right, int bottom) {
+    int w = current.lineWidth + 1;
+    add(RENDER_FILL_RECTANGLE, MASK_FILL | MASK_LINE, left - w, top - w, right + w, bottom + w,
+        left, top, right, bottom);
+}
+
+void RenderList::rectangle(int left, int top, int right, int bottom) {
+    int w = current.lineWidth + 1;
+    add(RENDER_RECTANGLE, MASK_LINE, left - w, top - w, right + w, bottom + w, left, top, right, bottom);
+}
+
+void RenderList::line(int x1, int y1, int x2, int y2) {
+    int w = current.lineWidth + 1;
+    add(RENDER_LINE, MASK_LINE, std::min(x1, x2) - w, std::min(y1, y2) - w, std::max(x1, x2) + w,
+        std::max(y1, y2) + w, x1, y1, x2, y2);
+}
+
+void RenderList::solidPolygon(const POINT* vertices, int count) {
+    if (count <= 0) return;
+    int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+    int offset = (int)points.size();
+    for (int i = 0; i < count; i++) {
+        left = std::min(left, (int)vertices[i].x);
+        top = std::min(top, (int)vertices[i].y);
+        right = std::max(right, (int)vertices[i].x);
+        bottom = std::max(bottom, (int)vertices[i].y);
+        points.push_back(vertices[i]);
+    }
+    add(RENDER_SOLID_POLYGON, MASK_FILL, left - 1, top - 1, right + 1, bottom + 1, 0, 0, offset, count);
+}
+
+void RenderList::outText(int x, int y, const wchar_t* str) {
+    const TextMetrics& size = measure(str);
+    int length = (int)wcslen(str);
+    int offset = (int)text.size();
+    text.insert(text.end(), str, str + length + 1);     // 连同结尾的0
+    add(RENDER_TEXT, MASK_TEXT, x - 1, y - 1, x + size.width + 1, y + size.height + 1, x, y, offset, length);
+}
+
+void RenderList::putImage(int x, int y, const IMAGE* image) {
+    putImage(x, y, image->getwidth(), image->getheight(), image, 0, 0);
+}
+
+void RenderList::putImage(int x, int y, int width, int height, const IMAGE* image, int srcX, int srcY) {
+    add(RENDER_IMAGE, 0, x, y, x + width, y + height, x, y, internImage(image), (srcX & 0xFFFF) | (srcY << 16));
+}
+
+void RenderList::blendImage(int x, int y, int width, int height, const IMAGE* image, int srcX, int srcY) {
+    add(RENDER_BLEND_IMAGE, 0, x, y, x + width, y + height, x, y, internImage(image), (srcX & 0xFFFF) | (srcY << 16));
+}
+
+int RenderList::internImage(const IMAGE* image) {
+    int index = -1;
+    for (size_t i = 0; i < images.size(); i++) {
+        if (images[i] == image) {
+            index = (int)i;
+            break;
+        }
+    }
+    if (index < 0) {
+        images.push_back(image);
+        index = (int)images.size() - 1;
+    }
+    return index;
+}
+
+const RenderList::TextMetrics& RenderList::measure(const wchar_t* str) {
+    uint64_t key = fnv1a(&current.fontHeight, sizeof(int16_t) * 3);     // 字高、字宽、字体名称
+    key = fnv1a(str, wcslen(str) * sizeof(wchar_t), key) | 1;           // 0 留给空槽
+    TextMetrics& entry = metrics[(size_t)key & (METRICS_SIZE - 1)];
+    if (entry.key == key) {
+        return entry;
+    }
+
+    // 缓存未命中：把设备切换到录制中的字体再测量
+    if (current.fontFace != RENDER_ANY &&
+        (device.fontHeight != current.fontHeight || device.fontWidth != current.fontWidth ||
+            device.fontFace != current.fontFace)) {
+        settextstyle(current.fontHeight, current.fontWidth, faces[current.fontFace].c_str());
+        device.fontHeight = current.fontHeight;
+        device.fontWidth = current.fontWidth;
+        device.fontFace = current.fontFace;
+    }
+    entry.key = key;
+    entry.width = textwidth(str);
+    entry.height = textheight(str);
+    return entry;
+}
+
+int RenderList::textWidth(const wchar_t* str) {
+    return measure(str).width;
+}
+
+int RenderList::textHeight(const wchar_t* str) {
+    return measure(str).height;
+}
+
+bool RenderList::isSameAsPrevious() const {
+    return sameArray(commands, previousCommands) && sameArray(states, previousStates) &&
+        sameArray(points, previousPoints) && sameArray(text, previousText) && sameArray(images, previousImages);
+}
+
+int RenderList::applyState(const RenderState& state, RenderState& dev, bool apply) {
+    int changes = 0;
+    if (state.fillColor != RENDER_ANY_COLOR && state.fillColor != dev.fillColor) {
+        if (apply) setfillcolor(state.fillColor);
+        dev.fillColor = state.fillColor;
+        changes++;
+    }
+    if (state.lineColor != RENDER_ANY_COLOR && state.lineColor != dev.lineColor) {
+        if (apply) setlinecolor(state.lineColor);
+        dev.lineColor = state.lineColor;
+        changes++;
+    }
+    if (state.lineStyle != RENDER_ANY && (state.lineStyle != dev.lineStyle || state.lineWidth != dev.lineWidth)) {
+        if (apply) setlinestyle(state.lineStyle, state.lineWidth);
+        dev.lineStyle = state.lineStyle;
+        dev.lineWidth = state.lineWidth;
+        changes++;
+    }
+    if (state.textColor != RENDER_ANY_COLOR && state.textColor != dev.textColor) {
+        if (apply) settextcolor(state.textColor);
+        dev.textColor = state.textColor;
+        changes++;
+    }
+    if (state.fontFace != RENDER_ANY && (state.fontHeight != dev.fontHeight ||
+        state.fontWidth != dev.fontWidth || state.fontFace != dev.fontFace)) {
+        if (apply) settextstyle(state.fontHeight, state.fontWidth, faces[state.fontFace].c_str());
+        dev.fontHeight = state.fontHeight;
+        dev.fontWidth = state.fontWidth;
+        dev.fontFace = state.fontFace;
+        changes++;
+    }
+    if (state.bkMode != RENDER_ANY && state.bkMode != dev.bkMode) {
+        if (apply) setbkmode(state.bkMode);
+        dev.bkMode = state.bkMode;
+        changes++;
+    }
+    return changes;
+}
+
+void RenderList::execute() {
+    const int count = (int)commands.size();
+
+    // 按录制顺序执行需要的切换次数（只用于统计）
+    RenderState simulated = device;
+    unsortedStateChanges = 0;
+    for (const RenderCommand& command : commands) {
+        unsortedStateChanges += applyState(states[command.state], simulated, false);
+    }
+
+    // 分批：每条命令向前找状态相同的批次，遇到与它重叠的批次就停
+    batches.clear();
+    nextInBatch.assign(count, -1);
+    for (int i = 0; i < count; i++) {
+        const RenderCommand& command = commands[i];
+        int target = -1;
+        if (command.op != RENDER_CLEAR) {
+            int stop = std::max(0, (int)batches.size() - RENDER_REORDER_WINDOW);
+            for (int b = (int)batches.size() - 1; b >= stop; b--) {
+                const Batch& batch = batches[b];
+                if (batch.state == command.state) target = b;
+                if (batch.left <= command.right && command.left <= batch.right &&
+                    batch.top <= command.bottom && command.top <= batch.bottom) break;
+            }
+        }
+
+        if (target < 0) {
+            Batch batch = { command.state, command.left, command.top, command.right, command.bottom, i, i };
+            batches.push_back(batch);
+        }
+        else {
+            Batch& batch = batches[target];
+            nextInBatch[batch.tail] = i;
+            batch.tail = i;
+            batch.left = std::min(batch.left, command.left);
+            batch.top = std::min(batch.top, command.top);
+            batch.right = std::max(batch.right, command.right);
+            batch.bottom = std::max(batch.bottom, command.bottom);
+        }
+    }
+
+    stateChanges = 0;
+    for (const Batch& batch : batches) {
+        stateChanges += applyState(states[batch.state], device, true);
+        for (int i = batch.head; i >= 0; i = nextInBatch[i]) {
+            const RenderCommand& c = commands[i];
+            switch (c.op) {
+            case RENDER_CLEAR: cleardevice(); break;
+            case RENDER_SOLID_CIRCLE: solidcircle(c.a, c.b, c.c); break;
+            case RENDER_CIRCLE: ::circle(c.a, c.b, c.c); break;
+            case RENDER_SOLID_RECTANGLE: solidrectangle(c.a, c.b, c.c, c.d); break;
+            case RENDER_FILL_RECTANGLE: fillrectangle(c.a, c.b, c.c, c.d); break;
+            case RENDER_RECTANGLE: ::rectangle(c.a, c.b, c.c, c.d); break;
+            case RENDER_LINE: ::line(c.a, c.b, c.c, c.d); break;
+            case RENDER_SOLID_POLYGON: solidpolygon(&points[c.c], c.d); break;
+            case RENDER_TEXT: outtextxy(c.a, c.b, &text[c.c]); break;
+            case RENDER_IMAGE:
+                putimage(c.a, c.b, c.right - c.left, c.bottom - c.top, images[c.c], c.d & 0xFFFF, (c.d >> 16) & 0xFFFF);
+                break;
+            case RENDER_BLEND_IMAGE:
+                alphaBlit(c.a, c.b, c.right - c.left, c.bottom - c.top, images[c.c], c.d & 0xFFFF, (c.d >> 16) & 0xFFFF);
+                break;
+            }
+        }
+    }
+    batchCount = (int)batches.size();
+}
+
+void RenderList::serialize(std::vector<uint8_t>& out) const {
+    RenderStreamHeader header;
+    memcpy(header.magic, "FBRL", 4);
+    header.version = RENDER_LIST_VERSION;
+    header.faceCount = (uint16_t)faces.size();
+    header.stateCount = (uint32_t)states.size();
+    header.commandCount = (uint32_t)commands.size();
+    header.pointCount = (uint32_t)points.size();
+    header.textLength = (uint32_t)text.size();
+    header.imageCount = (uint32_t)images.size();
+    append(out, header);
+
+    for (const std::wstring& face : faces) {
+        append(out, (uint16_t)face.size());
+        for (wchar_t ch : face) append(out, (uint16_t)ch);
+    }
+    for (const RenderState& state : states) append(out, state);
+    for (const RenderCommand& command : commands) append(out, command);
+    for (const POINT& point : points) {
+        append(out, (int32_t)point.x);
+        append(out, (int32_t)point.y);
+    }
+    for (wchar_t ch : text) append(out, (uint16_t)ch);     // Windows 上 wchar_t 本来就是 UTF-16
+}
@@ -0,0 +1,57 @@
+﻿#include "../include/Replay.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const size_t RESERVED_TICKS = 60 * 60 * 60;     // 预留1小时的跳跃位（27KB）
+}
+
+ReplayRecorder::ReplayRecorder() : seed(0), difficulty(1) {
+    jumps.reserve(getJumpBytes(RESERVED_TICKS));
+}
+
+void ReplayRecorder::start(uint32_t newSeed, int newDifficulty) {
+    seed = newSeed;
+    difficulty = newDifficulty;
+    jumps.clear();      // 保留容量
+}
+
+void ReplayRecorder::recordJump(uint32_t tick) {
+    size_t byte = tick >> 3;
+    if (byte >= jumps.size()) {
+        jumps.resize(byte + 1, 0);
+    }
+    jumps[byte] |= (uint8_t)(1u << (tick & 7));
+}
+
+void ReplayRecorder::fillHeader(ReplayHeader& header, uint32_t seed, int difficulty, uint32_t ticks,
+    const char* playerName, int score, int level, int playTime, int64_t date) {
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "FBRP", 4);
+    header.version = REPLAY_VERSION;
+    header.difficulty = (uint8_t)difficulty;
+    header.seed = seed;
+    header.ticks = ticks;
+    header.score = score;
+    header.level = level;
+    header.playTime = playTime;
+    header.date = date;
+    strncpy(header.playerName, playerName, REPLAY_NAME_LENGTH - 1);
+}
+
+bool ReplayRecorder::append(const char* path, const char* playerName, int score, int level, int playTime,
+    int64_t date, uint32_t ticks) const {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    if (!file.is_open()) return false;
+
+    ReplayHeader header;
+    fillHeader(header, seed, difficulty, ticks, playerName, score, level, playTime, date);
+    file.write((const char*)&header, sizeof(header));
+
+    // 最后几帧没有跳跃时，录制的字节比 ticks 帧需要的少，补0
+    size_t bytes = getJumpBytes(ticks);
+    size_t recorded = jumps.size() < bytes ? jumps.size() : bytes;
+    if (recorded > 0) file.write((const char*)jumps.data(), recorded);
+    for (size_t i = recorded; i < bytes; i++) file.put(0);
+    return file.good();
+}
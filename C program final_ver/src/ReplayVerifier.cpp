@@ -0,0 +1,352 @@
+﻿#include "../include/ReplayVerifier.h"
+#include "../include/Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t CHUNK = 64;        // 工作线程每次领取的记录数
+
+    double millisSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 一批回放的校验结果（下标与记录的顺序相同）
+    struct BatchResult {
+        std::vector<uint8_t> verdicts;      // ReplayVerdict
+        std::vector<uint32_t> nanos;        // 每条回放的模拟耗时
+        uint64_t ticks;                     // 模拟的总帧数
+        double millis;                      // 并行校验的墙钟时间
+    };
+
+    // 扫描一遍，记录每条回放的偏移。遇到不合法的文件头时停止（之后的记录无法再定位），返回已扫描的字节数
+    size_t indexRecords(const std::vector<uint8_t>& data, std::vector<size_t>& offsets) {
+        size_t offset = 0;
+        while (data.size() - offset >= sizeof(ReplayHeader)) {
+            ReplayHeader header;
+            memcpy(&header, data.data() + offset, sizeof(header));
+            if (memcmp(header.magic, "FBRP", 4) != 0 || header.version != REPLAY_VERSION ||
+                header.ticks > REPLAY_MAX_TICKS) break;
+            size_t size = sizeof(header) + ReplayRecorder::getJumpBytes(header.ticks);
+            if (data.size() - offset < size) break;
+            offsets.push_back(offset);
+            offset += size;
+        }
+        return offset;
+    }
+
+    // 所有线程按块领取记录并行校验（调用线程也参与）
+    void verifyBatch(const std::vector<uint8_t>& data, const std::vector<size_t>& offsets, int threads,
+        BatchResult& result) {
+        const size_t count = offsets.size();
+        result.verdicts.assign(count, REPLAY_BAD_RECORD);
+        result.nanos.assign(count, 0);
+
+        std::atomic<size_t> next(0);
+        std::atomic<uint64_t> totalTicks(0);
+        auto work = [&]() {
+            uint64_t ticks = 0;
+            for (;;) {
+                size_t begin = next.fetch_add(CHUNK);
+                if (begin >= count) break;
+                size_t end = std::min(begin + CHUNK, count);
+                for (size_t i = begin; i < end; i++) {
+                    Clock::time_point start = Clock::now();
+                    ReplayHeader header;
+                    memcpy(&header, data.data() + offsets[i], sizeof(header));
+                    ReplayOutcome outcome;
+                    result.verdicts[i] = ReplayVerifier::verify(header, data.data() + offsets[i] + sizeof(header), outcome);
+                    result.nanos[i] = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - start).count();
+                    ticks += outcome.ticks;
+                }
+            }
+            totalTicks += ticks;
+        };
+
+        Clock::time_point start = Clock::now();
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; i++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        result.millis = millisSince(start);
+        result.ticks = totalTicks;
+    }
+
+    double percentileMicros(std::vector<uint32_t> nanos, double p) {
+        if (nanos.empty()) return 0;
+        size_t index = (size_t)(p * (nanos.size() - 1));
+        std::nth_element(nanos.begin(), nanos.begin() + index, nanos.end());
+        return nanos[index] / 1000.0;
+    }
+
+    // 吞吐量、各判定的条数和每条回放的耗时分解
+    void printReport(const BatchResult& result, int threads, double loadMillis, double indexMillis) {
+        const size_t count = result.verdicts.size();
+        const double perReplay = count ? 1000.0 / count : 0;     // 毫秒 → 每条的微秒
+
+        size_t verdicts[REPLAY_VERDICT_COUNT] = {};
+        for (uint8_t verdict : result.verdicts) {
+            verdicts[verdict]++;
+        }
+        uint64_t simulateNanos = 0;
+        for (uint32_t nanos : result.nanos) {
+            simulateNanos += nanos;
+        }
+
+        std::cout << "Verified " << count << " replays on " << threads << " thread(s) in " << result.millis
+            << " ms: " << (result.millis > 0 ? count * 60000.0 / result.millis : 0) << " per minute" << std::endl;
+        for (int v = 0; v < REPLAY_VERDICT_COUNT; v++) {
+            if (verdicts[v]) {
+                std::cout << "  " << ReplayVerifier::getVerdictName((ReplayVerdict)v) << ": " << verdicts[v] << std::endl;
+            }
+        }
+        std::cout << "  per replay us: load " << loadMillis * perReplay << ", index " << indexMillis * perReplay
+            << ", simulate+compare " << (count ? simulateNanos / 1000.0 / count : 0)
+            << " (p50 " << percentileMicros(result.nanos, 0.50) << ", p99 " << percentileMicros(result.nanos, 0.99)
+            << "), wall per core " << result.millis * perReplay * threads << std::endl;
+        std::cout << "  average " << (count ? (double)result.ticks / count : 0) << " ticks per replay, "
+            << (result.ticks ? simulateNanos / (double)result.ticks : 0) << " ns per tick" << std::endl;
+    }
+
+    // 排行榜文件的一行
+    struct AcceptedEntry {
+        std::string name;
+        int32_t score, level, playTime;
+        int64_t date;
+
+        // 与 ScoreEntry 的排序相同：分数降序，分数相同时时间升序
+        bool operator<(const AcceptedEntry& other) const {
+            if (score != other.score) return score > other.score;
+            return playTime < other.playTime;
+        }
+    };
+
+    bool writeLeaderboard(const char* path, const std::vector<uint8_t>& data, const std::vector<size_t>& offsets,
+        const BatchResult& result) {
+        std::vector<AcceptedEntry> entries;
+        for (size_t i = 0; i < offsets.size(); i++) {
+            if (result.verdicts[i] != REPLAY_ACCEPTED) continue;
+            ReplayHeader header;
+            memcpy(&header, data.data() + offsets[i], sizeof(header));
+            AcceptedEntry entry;
+            entry.name.assign(header.playerName, strnlen(header.playerName, REPLAY_NAME_LENGTH));
+            // 排行榜按空白分隔字段
+            std::replace(entry.name.begin(), entry.name.end(), ' ', '_');
+            if (entry.name.empty()) entry.name = "Player";
+            entry.score = header.score;
+            entry.level = header.level;
+            entry.playTime = header.playTime;
+            entry.date = header.date;
+            entries.push_back(entry);
+        }
+        std::stable_sort(entries.begin(), entries.end());
+
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        for (const AcceptedEntry& entry : entries) {
+            file << entry.name << " " << entry.score << " " << entry.level << " "
+                << entry.playTime << " " << entry.date << std::endl;
+        }
+        return file.good();
+    }
+
+    // 测试用的一条回放：简单的自动驾驶玩到随机选定的帧数（10~100秒），之后不再跳跃直到落地
+    void generateReplay(uint32_t index, std::vector<uint8_t>& record) {
+        uint32_t rng = index * 2654435761u + 0x9E3779B9u;
+        if (rng == 0) rng = 1;
+        uint32_t seed = nextRandom(rng);
+        int difficulty = (int)(nextRandom(rng) % 3);
+        uint32_t giveUpTick = 600 + nextRandom(rng) % (60 * 90);
+
+        SimState state;
+        Simulation::reset(state, seed, difficulty);
+        std::vector<uint8_t> jumps;
+        while (state.alive) {
+            const SimPipe* pipe = Simulation::getNextPipe(state, 0);
+            float target = pipe ? pipe->gapY + 20 : (float)(SCREEN_HEIGHT / 2);
+            bool jump = state.tick < giveUpTick && state.birdY > target && state.birdVelocity > 0;
+            if (jump) {
+                if ((state.tick >> 3) >= jumps.size()) jumps.resize((state.tick >> 3) + 1, 0);
+                jumps[state.tick >> 3] |= (uint8_t)(1u << (state.tick & 7));
+            }
+            Simulation::step(state, jump);
+        }
+
+        ReplayHeader header;
+        char name[REPLAY_NAME_LENGTH];
+        snprintf(name, sizeof(name), "Bot%u", index);
+        ReplayRecorder::fillHeader(header, seed, difficulty, state.tick, name, state.score, state.level,
+            (int)state.gameTime, 1700000000 + index);
+
+        // 每10条篡改1条：分数、等级、时间，或者截掉死亡的那一帧
+        if (index % 10 == 9) {
+            switch ((index / 10) % 4) {
+            case 0: header.score++; break;
+            case 1: header.level++; break;
+            case 2: header.playTime += 2; break;
+            default: header.ticks--; break;
+            }
+        }
+
+        size_t bytes = ReplayRecorder::getJumpBytes(header.ticks);
+        jumps.resize(bytes, 0);
+        record.resize(sizeof(header) + bytes);
+        memcpy(record.data(), &header, sizeof(header));
+        if (bytes) memcpy(record.data() + sizeof(header), jumps.data(), bytes);
+    }
+}
+
+ReplayVerdict ReplayVerifier::verify(const ReplayHeader& header, const uint8_t* jumps, ReplayOutcome& outcome) {
+    memset(&outcome, 0, sizeof(outcome));
+    if (header.difficulty > 2 || header.ticks == 0 || header.ticks > REPLAY_MAX_TICKS) return REPLAY_BAD_RECORD;
+
+    SimState state;
+    Simulation::reset(state, header.seed, header.difficulty);
+    for (uint32_t t = 0; t < header.ticks; t++) {
+        bool jump = ((jumps[t >> 3] >> (t & 7)) & 1) != 0;
+        if (Simulation::step(state, jump) & SIM_EVENT_DIED) break;
+    }
+
+    // 与 Game::addToLeaderboard 提交的值相同
+    outcome.score = state.score;
+    outcome.level = state.level;
+    outcome.playTime = (int)state.gameTime;
+    outcome.ticks = state.tick;
+
+    if (state.alive) return REPLAY_STILL_ALIVE;
+    if (state.tick != header.ticks) return REPLAY_DIED_EARLY;
+    if (outcome.score != header.score) return REPLAY_WRONG_SCORE;
+    if (outcome.level != header.level) return REPLAY_WRONG_LEVEL;
+    if (outcome.playTime != header.playTime) return REPLAY_WRONG_TIME;
+    return REPLAY_ACCEPTED;
+}
+
+bool ReplayVerifier::verifyFile(const char* replayPath, const char* leaderboardPath, int threads) {
+    if (threads < 1) threads = 1;
+
+    // 一次读入整个文件
+    Clock::time_point start = Clock::now();
+    std::ifstream file(replayPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cout << "Cannot open " << replayPath << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((size_t)file.tellg());
+    file.seekg(0);
+    if (!data.empty()) file.read((char*)data.data(), data.size());
+    if (!file) {
+        std::cout << "Cannot read " << replayPath << std::endl;
+        return false;
+    }
+    double loadMillis = millisSince(start);
+
+    start = Clock::now();
+    std::vector<size_t> offsets;
+    size_t indexed = indexRecords(data, offsets);
+    double indexMillis = millisSince(start);
+    bool ok = true;
+    if (indexed != data.size()) {
+        std::cout << "Corrupt record at offset " << indexed << ", ignored the last "
+            << data.size() - indexed << " bytes" << std::endl;
+        ok = false;
+    }
+
+    BatchResult result;
+    verifyBatch(data, offsets, threads, result);
+    printReport(result, threads, loadMillis, indexMillis);
+
+    if (leaderboardPath) {
+        if (!writeLeaderboard(leaderboardPath, data, offsets, result)) {
+            std::cout << "Cannot write " << leaderboardPath << std::endl;
+            return false;
+        }
+        std::cout << "Accepted scores written to " << leaderboardPath << std::endl;
+    }
+    return ok;
+}
+
+bool ReplayVerifier::benchmark(int count, int threads, const char* savePath) {
+    if (count < 1) count = 1;
+    if (threads < 1) threads = 1;
+
+    // 并行生成（不计入校验时间）
+    Clock::time_point start = Clock::now();
+    std::vector<std::vector<uint8_t>> records(count);
+    std::atomic<int> next(0);
+    auto generate = [&]() {
+        for (int i; (i = next++) < count;) {
+            generateReplay((uint32_t)i, records[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(generate);
+    }
+    generate();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<uint8_t> data;
+    for (const std::vector<uint8_t>& record : records) {
+        data.insert(data.end(), record.begin(), record.end());
+    }
+    records.clear();
+    std::cout << "Generated " << count << " replays (" << data.size() / 1024 << " KB) in " << millisSince(start)
+        << " ms" << std::endl;
+
+    if (savePath) {
+        std::ofstream file(savePath, std::ios::binary);
+        file.write((const char*)data.data(), data.size());
+        if (!file.good()) {
+            std::cout << "Cannot write " << savePath << std::endl;
+            return false;
+        }
+    }
+
+    // 与 verifyFile 相同的流程，只是数据已经在内存里
+    start = Clock::now();
+    std::vector<size_t> offsets;
+    size_t indexed = indexRecords(data, offsets);
+    double indexMillis = millisSince(start);
+
+    BatchResult result;
+    verifyBatch(data, offsets, threads, result);
+    printReport(result, threads, 0, indexMillis);
+
+    // 篡改的恰好是下标为 10k+9 的记录
+    int wrong = 0;
+    for (size_t i = 0; i < result.verdicts.size(); i++) {
+        bool tampered = i % 10 == 9;
+        if ((result.verdicts[i] == REPLAY_ACCEPTED) == tampered) wrong++;
+    }
+    std::cout << "  misjudged replays: " << wrong << std::endl;
+    return indexed == data.size() && offsets.size() == (size_t)count && wrong == 0;
+}
+
+const char* ReplayVerifier::getVerdictName(ReplayVerdict verdict) {
+    switch (verdict) {
+    case REPLAY_ACCEPTED: return "accepted";
+    case REPLAY_BAD_RECORD: return "bad record";
+    case REPLAY_DIED_EARLY: return "died before the last tick";
+    case REPLAY_STILL_ALIVE: return "still alive after the last tick";
+    case REPLAY_WRONG_SCORE: return "score mismatch";
+    case REPLAY_WRONG_LEVEL: return "level mismatch";
+    case REPLAY_WRONG_TIME: return "play time mismatch";
+    default: return "unknown";
+    }
+}
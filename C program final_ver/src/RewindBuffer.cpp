@@ -0,0 +1,223 @@
+﻿#include "../include/RewindBuffer.h"
+#include <cstring>
+
+RewindBuffer::RewindBuffer() : keyframesWritten(0), forcedKeyframes(0) {
+    memset(keyframes, 0, sizeof(keyframes));
+    memset(deltas, 0, sizeof(deltas));
+    memset(&last, 0, sizeof(last));
+    clear();
+}
+
+void RewindBuffer::clear() {
+    memset(keyframeValid, 0, sizeof(keyframeValid));
+    nextKeyframe = 0;
+    hasFrames = false;
+    highestTick = 0;
+}
+
+void RewindBuffer::record(const RewindFrame& frame) {
+    if (!hasFrames || frame.tick != last.tick + 1) {
+        clear();
+        writeKeyframe(frame);
+        last = frame;
+        highestTick = frame.tick;
+        hasFrames = true;
+        return;
+    }
+
+    bool encoded = encodeDelta(last, frame, deltas[frame.tick % REWIND_DELTA_SLOTS]);
+    if (!encoded) {
+        // 这一帧的增量无效，但关键帧就在这一帧，跳转时不会用到它
+        forcedKeyframes++;
+        writeKeyframe(frame);
+    }
+    else if (frame.tick % REWIND_KEYFRAME_INTERVAL == 0) {
+        writeKeyframe(frame);
+    }
+    last = frame;
+    if (frame.tick > highestTick) highestTick = frame.tick;
+}
+
+// 关键帧环按写入顺序覆盖，被覆盖的总是最旧的一个，较新的关键帧和它们之后的增量都还在
+void RewindBuffer::writeKeyframe(const RewindFrame& frame) {
+    keyframes[nextKeyframe] = frame;
+    keyframeValid[nextKeyframe] = true;
+    nextKeyframe = (nextKeyframe + 1) % REWIND_KEYFRAME_SLOTS;
+    keyframesWritten++;
+}
+
+bool RewindBuffer::encodeDelta(const RewindFrame& last, const RewindFrame& frame, RewindDelta& delta) {
+    memset(&delta, 0, sizeof(delta));
+
+    // 队首移出了几根管道：剩下的管道编号必须和新一帧开头的管道一一对应
+    int retired = -1;
+    for (int r = 0; r <= last.pipeCount && retired < 0; r++) {
+        int surviving = last.pipeCount - r;
+        if (surviving > frame.pipeCount) continue;
+        bool match = true;
+        for (int i = 0; i < surviving && match; i++) {
+            match = frame.pipes[i].id == last.pipes[r + i].id;
+        }
+        if (match) retired = r;
+    }
+    if (retired < 0) return false;
+
+    const int surviving = last.pipeCount - retired;
+    const int spawned = frame.pipeCount - surviving;
+    if (spawned > 1) return false;
+
+    for (int i = 0; i < surviving; i++) {
+        const RewindPipe& before = last.pipes[retired + i];
+        const RewindPipe& after = frame.pipes[i];
+        float moved = before.x - last.gameSpeed;    // 与 Pipe::update 相同的运算
+        if (after.x != moved || after.gapY != before.gapY || after.color != before.color) return false;
+        if (after.passed != before.passed) {
+            if (!after.passed) return false;
+            delta.passedMask |= (uint16_t)(1u << i);
+        }
+        if (after.coin != before.coin) {
+            if (after.coin) return false;
+            delta.coinMask |= (uint16_t)(1u << i);
+        }
+    }
+    if (spawned == 1) {
+        delta.spawn = frame.pipes[surviving];
+    }
+
+    // 随机数状态按 applyDelta 的规则推算，对不上（例如一局中途换了种子）时存关键帧
+    if (advancePipeRng(last.pipeRng, spawned, frame.courseCursor != last.courseCursor) != frame.pipeRng) {
+        return false;
+    }
+
+    // 数值的变化，超出字段范围时存关键帧
+    int scoreDelta = frame.score - last.score;
+    int coinsDelta = frame.coins - last.coins;
+    int levelDelta = frame.level - last.level;
+    int passedDelta = frame.pipesPassed - last.pipesPassed;
+    int idsUsed = frame.nextPipeID - last.nextPipeID;
+    uint64_t coursePipes = frame.courseCursor - last.courseCursor;
+    if (scoreDelta < INT16_MIN || scoreDelta > INT16_MAX || coinsDelta < INT16_MIN || coinsDelta > INT16_MAX ||
+        levelDelta < INT8_MIN || levelDelta > INT8_MAX || passedDelta < INT8_MIN || passedDelta > INT8_MAX ||
+        idsUsed < 0 || idsUsed > UINT8_MAX || frame.courseCursor < last.courseCursor || coursePipes > UINT8_MAX ||
+        frame.comboCount > INT16_MAX || frame.scoreMultiplier > INT16_MAX) {
+        return false;
+    }
+
+    delta.birdY = frame.birdY;
+    delta.birdVelocity = frame.birdVelocity;
+    delta.comboTime = frame.comboTime;
+    delta.gameSpeed = frame.gameSpeed;
+    delta.pipeTimer = frame.pipeTimer;
+    delta.gameTime = frame.gameTime;
+    delta.comboCount = (int16_t)frame.comboCount;
+    delta.scoreMultiplier = (int16_t)frame.scoreMultiplier;
+    delta.scoreDelta = (int16_t)scoreDelta;
+    delta.coinsDelta = (int16_t)coinsDelta;
+    delta.levelDelta = (int8_t)levelDelta;
+    delta.pipesPassedDelta = (int8_t)passedDelta;
+    delta.idsUsed = (uint8_t)idsUsed;
+    delta.coursePipes = (uint8_t)coursePipes;
+    delta.retired = (uint8_t)retired;
+    delta.spawned = (uint8_t)spawned;
+    return true;
+}
+
+// 随机管道每根抽取一次 rollPipe；赛道上的管道来自文件，不消耗随机数
+uint32_t RewindBuffer::advancePipeRng(uint32_t rng, int spawned, bool fromCourse) {
+    if (spawned && !fromCourse) {
+        rollPipe(rng);
+    }
+    return rng;
+}
+
+void RewindBuffer::applyDelta(RewindFrame& frame, const RewindDelta& delta) {
+    const float speed = frame.gameSpeed;    // 管道按上一帧的速度移动
+    frame.pipeRng = advancePipeRng(frame.pipeRng, delta.spawned, delta.coursePipes != 0);
+
+    int count = frame.pipeCount - delta.retired;
+    memmove(frame.pipes, frame.pipes + delta.retired, count * sizeof(RewindPipe));
+    for (int i = 0; i < count; i++) {
+        RewindPipe& pipe = frame.pipes[i];
+        pipe.x -= speed;
+        if (delta.passedMask & (1u << i)) pipe.passed = 1;
+        if (delta.coinMask & (1u << i)) pipe.coin = 0;
+    }
+    if (delta.spawned) {
+        frame.pipes[count++] = delta.spawn;
+    }
+    frame.pipeCount = count;
+
+    frame.tick++;
+    frame.birdY = delta.birdY;
+    frame.birdVelocity = delta.birdVelocity;
+    frame.comboTime = delta.comboTime;
+    frame.comboCount = delta.comboCount;
+    frame.scoreMultiplier = delta.scoreMultiplier;
+    frame.score += delta.scoreDelta;
+    frame.coins += delta.coinsDelta;
+    frame.level += delta.levelDelta;
+    frame.pipesPassed += delta.pipesPassedDelta;
+    frame.nextPipeID += delta.idsUsed;
+    frame.courseCursor += delta.coursePipes;
+    frame.gameSpeed = delta.gameSpeed;
+    frame.pipeTimer = delta.pipeTimer;
+    frame.gameTime = delta.gameTime;
+}
+
+// 关键帧之后的增量都必须还在环里。倒带后继续游戏时，被放弃的那段记录也占过增量槽位，
+// 所以按写入过的最大帧号算：关键帧不能早于 highestTick - REWIND_DELTA_SLOTS + 1
+uint32_t RewindBuffer::getWindowStart() const {
+    return highestTick + 1 >= REWIND_DELTA_SLOTS ? highestTick + 1 - REWIND_DELTA_SLOTS : 0;
+}
+
+int RewindBuffer::findKeyframe(uint32_t tick) const {
+    const uint32_t oldest = getWindowStart();
+    int best = -1;
+    for (int i = 0; i < REWIND_KEYFRAME_SLOTS; i++) {
+        if (!keyframeValid[i]) continue;
+        uint32_t t = keyframes[i].tick;
+        if (t < oldest || t > tick) continue;
+        if (best < 0 || t > keyframes[best].tick) best = i;
+    }
+    return best;
+}
+
+uint32_t RewindBuffer::getOldestTick() const {
+    const uint32_t oldest = getWindowStart();
+    uint32_t result = last.tick;
+    for (int i = 0; i < REWIND_KEYFRAME_SLOTS; i++) {
+        if (keyframeValid[i] && keyframes[i].tick >= oldest && keyframes[i].tick < result) {
+            result = keyframes[i].tick;
+        }
+    }
+    return result;
+}
+
+bool RewindBuffer::seek(uint32_t tick, RewindFrame& out) const {
+    if (!hasFrames || tick > last.tick) return false;
+    int k = findKeyframe(tick);
+    if (k < 0) return false;
+
+    out = keyframes[k];
+    while (out.tick < tick) {
+        applyDelta(out, deltas[(out.tick + 1) % REWIND_DELTA_SLOTS]);
+    }
+    return true;
+}
+
+bool RewindBuffer::resumeAt(uint32_t tick, RewindFrame& out) {
+    if (!seek(tick, out)) return false;
+
+    // 之后的关键帧作废（它们是写入顺序的最后几个），写入位置退回到剩下的最新一个之后；
+    // 之后的增量槽位会被接下来的录制覆盖
+    for (int i = 0; i < REWIND_KEYFRAME_SLOTS; i++) {
+        if (keyframeValid[i] && keyframes[i].tick > tick) keyframeValid[i] = false;
+    }
+    for (int i = 0; i < REWIND_KEYFRAME_SLOTS; i++) {
+        int previous = (nextKeyframe + REWIND_KEYFRAME_SLOTS - 1) % REWIND_KEYFRAME_SLOTS;
+        if (keyframeValid[previous]) break;
+        nextKeyframe = previous;
+    }
+    last = out;
+    return true;
+}
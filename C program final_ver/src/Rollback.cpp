@@ -0,0 +1,334 @@
+﻿#include "../include/Rollback.h"
+#include "../include/NetSocket.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    const uint32_t NO_ROLLBACK = 0xFFFFFFFFu;
+
+    // 每回合的种子：同一场比赛的两端算出的相同
+    uint32_t roundSeed(uint32_t seed, uint32_t round) {
+        uint32_t h = seed ^ (0x9E3779B9u * (round + 1));
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        return h;
+    }
+
+    void startRound(RollbackState& state) {
+        for (int p = 0; p < ROLLBACK_PLAYERS; p++) {
+            Simulation::reset(state.players[p], roundSeed(state.seed, state.round), state.difficulty);
+        }
+    }
+}
+
+RollbackSession::RollbackSession() {
+    reset(1, 1, 0);
+}
+
+void RollbackSession::reset(uint32_t seed, int difficulty, int player) {
+    memset(&current, 0, sizeof(current));
+    current.seed = seed;
+    current.difficulty = difficulty;
+    startRound(current);
+    memset(saved, 0, sizeof(saved));
+
+    localPlayer = player;
+    memset(localInputs, 0, sizeof(localInputs));
+    memset(remoteInputs, 0, sizeof(remoteInputs));
+    memset(remoteKnown, 0, sizeof(remoteKnown));
+    memset(predicted, 0, sizeof(predicted));
+    remoteFrames = 0;
+    peerAck = 0;
+    rollbackFrame = NO_ROLLBACK;
+    syncFrame = 0;
+    memset(&stats, 0, sizeof(stats));
+    updateChecksums();
+}
+
+bool RollbackSession::canAdvance() const {
+    return current.frame - remoteFrames < ROLLBACK_MAX_FRAMES;
+}
+
+void RollbackSession::advance(bool localJump) {
+    resolveRollback();
+
+    localInputs[current.frame % ROLLBACK_INPUT_HISTORY] = localJump ? 1 : 0;
+    saved[current.frame % ROLLBACK_SAVE_SLOTS] = current;
+    simulateFrame(current);
+    stats.frames++;
+
+    updateChecksums();
+}
+
+bool RollbackSession::isRemoteKnown(uint32_t frame) const {
+    return remoteKnown[frame % ROLLBACK_INPUT_HISTORY] == frame + 1;
+}
+
+// 预测：对方保持最近一次确认的输入
+uint8_t RollbackSession::predictRemote() const {
+    return remoteFrames > 0 ? remoteInputs[(remoteFrames - 1) % ROLLBACK_INPUT_HISTORY] : 0;
+}
+
+void RollbackSession::addRemoteInput(uint32_t frame, bool jump) {
+    // 已经确认过，或者超出了缓冲范围（对方不可能领先这么多）
+    if (frame < remoteFrames || frame >= remoteFrames + ROLLBACK_INPUT_HISTORY) return;
+    if (isRemoteKnown(frame)) return;
+
+    const int slot = frame % ROLLBACK_INPUT_HISTORY;
+    remoteInputs[slot] = jump ? 1 : 0;
+    remoteKnown[slot] = frame + 1;
+
+    // 这一帧已经按预测模拟过，预测错了就要从这一帧重算
+    if (frame < current.frame && predicted[slot] != remoteInputs[slot]) {
+        rollbackFrame = std::min(rollbackFrame, frame);
+    }
+
+    // 连续确认的帧数前移；之后的帧的预测值随之改变，也需要重算
+    uint32_t before = remoteFrames;
+    while (isRemoteKnown(remoteFrames)) remoteFrames++;
+    if (remoteFrames > before) {
+        uint8_t newPrediction = remoteInputs[(remoteFrames - 1) % ROLLBACK_INPUT_HISTORY];
+        for (uint32_t f = remoteFrames; f < current.frame; f++) {
+            if (!isRemoteKnown(f) && predicted[f % ROLLBACK_INPUT_HISTORY] != newPrediction) {
+                rollbackFrame = std::min(rollbackFrame, f);
+                break;
+            }
+        }
+    }
+}
+
+void RollbackSession::simulateFrame(RollbackState& state) {
+    const uint32_t frame = state.frame;
+    const int slot = frame % ROLLBACK_INPUT_HISTORY;
+
+    uint8_t remote;
+    if (isRemoteKnown(frame)) {
+        remote = remoteInputs[slot];
+    }
+    else {
+        remote = predictRemote();
+        predicted[slot] = remote;
+    }
+
+    bool anyAlive = false;
+    for (int p = 0; p < ROLLBACK_PLAYERS; p++) {
+        bool jump = (p == localPlayer ? localInputs[slot] : remote) != 0;
+        Simulation::step(state.players[p], jump);
+        if (state.players[p].alive) anyAlive = true;
+    }
+    if (!anyAlive) {
+        state.round++;
+        startRound(state);
+    }
+    state.frame++;
+}
+
+void RollbackSession::resolveRollback() {
+    if (rollbackFrame == NO_ROLLBACK) return;
+
+    const uint32_t target = current.frame;
+    const int depth = (int)(target - rollbackFrame);
+    current = saved[rollbackFrame % ROLLBACK_SAVE_SLOTS];
+    rollbackFrame = NO_ROLLBACK;
+
+    while (current.frame < target) {
+        saved[current.frame % ROLLBACK_SAVE_SLOTS] = current;
+        simulateFrame(current);
+    }
+
+    stats.rollbacks++;
+    stats.resimulatedFrames += depth;
+    stats.maxRollback = std::max(stats.maxRollback, depth);
+}
+
+// 所有输入都已确认的帧的状态不会再变，记录它们的校验和
+void RollbackSession::updateChecksums() {
+    const uint32_t last = std::min(remoteFrames, current.frame);
+    while (syncFrame <= last) {
+        const RollbackState& state = syncFrame == current.frame
+            ? current : saved[syncFrame % ROLLBACK_SAVE_SLOTS];
+        checksums[syncFrame % ROLLBACK_INPUT_HISTORY] = checksum(state);
+        syncFrame++;
+    }
+}
+
+bool RollbackSession::getChecksum(uint32_t frame, uint64_t& out) const {
+    if (frame >= syncFrame || syncFrame - frame > ROLLBACK_INPUT_HISTORY) return false;
+    out = checksums[frame % ROLLBACK_INPUT_HISTORY];
+    return true;
+}
+
+// FNV-1a；状态里没有填充字节（reset 时整体清零），可以直接按字节计算
+uint64_t RollbackSession::checksum(const RollbackState& state) {
+    const uint8_t* bytes = (const uint8_t*)&state;
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < sizeof(state); i++) {
+        h ^= bytes[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+// ============================================================
+// 网络包
+// ============================================================
+
+void RollbackSession::buildPacket(PeerInputPacket& packet) const {
+    const uint32_t localFrames = current.frame;
+    uint32_t first = std::max(peerAck, localFrames > 64 ? localFrames - 64 : 0);
+
+    memset(&packet, 0, sizeof(packet));
+    packet.header = { PACKET_PEER_INPUT, SERVER_PROTOCOL_VERSION, 0 };
+    packet.firstFrame = first;
+    packet.ackFrame = remoteFrames;
+    packet.count = (uint8_t)(localFrames - first);
+    for (uint32_t f = first; f < localFrames; f++) {
+        if (localInputs[f % ROLLBACK_INPUT_HISTORY]) packet.jumps |= 1ull << (f - first);
+    }
+}
+
+void RollbackSession::receivePacket(const PeerInputPacket& packet) {
+    if (packet.header.type != PACKET_PEER_INPUT || packet.count > 64) return;
+
+    peerAck = std::max(peerAck, std::min(packet.ackFrame, current.frame));
+    for (int i = 0; i < packet.count; i++) {
+        addRemoteInput(packet.firstFrame + i, ((packet.jumps >> i) & 1) != 0);
+    }
+}
+
+// ============================================================
+// 本机回环测试
+// ============================================================
+
+namespace {
+    struct DelayedPacket {
+        std::chrono::steady_clock::time_point deliverAt;
+        PeerInputPacket packet;
+    };
+
+    struct Peer {
+        RollbackSession session;
+        UdpSocket socket;
+        NetAddress remote;
+        std::vector<DelayedPacket> outgoing;    // 注入延迟：到时间才真正发出
+        std::vector<uint64_t> checksums;        // 已确认帧的校验和，按帧号
+        uint64_t stalledFrames;
+    };
+
+    // 测试用的简单玩家：低于下一根管道间隙中心时跳，偶尔乱跳，让预测经常出错
+    bool botJump(const SimState& s, std::mt19937& rng) {
+        if (!s.alive) return false;
+        const SimPipe* pipe = Simulation::getNextPipe(s, 0);
+        float target = pipe ? pipe->gapY + 20 : (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f;
+        if (rng() % 100 < 2) return true;
+        return s.birdY > target && s.birdVelocity > 0;
+    }
+
+    float percentile(std::vector<float>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+    }
+}
+
+bool RollbackSession::runLoopbackTest(int latencyMs, int jitterMs, int lossPercent, double seconds) {
+    using Clock = std::chrono::steady_clock;
+
+    Peer peers[2];
+    for (int i = 0; i < 2; i++) {
+        if (!peers[i].socket.open(0)) {
+            std::cout << "Failed to open UDP socket" << std::endl;
+            return false;
+        }
+        peers[i].session.reset(12345, 1, i);
+        peers[i].stalledFrames = 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        NetAddress::resolve("127.0.0.1", peers[1 - i].socket.getLocalPort(), peers[i].remote);
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> jitter(-jitterMs, jitterMs);
+    std::vector<float> advanceMicros;
+    const auto frameTime = std::chrono::microseconds((int64_t)(1e6 / FPS));
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::microseconds((int64_t)(seconds * 1e6));
+    auto nextFrame = start;
+
+    while (Clock::now() < end) {
+        std::this_thread::sleep_until(nextFrame);
+        nextFrame += frameTime;
+        const auto now = Clock::now();
+
+        for (int i = 0; i < 2; i++) {
+            Peer& peer = peers[i];
+
+            // 发出到时间的包
+            auto due = std::partition(peer.outgoing.begin(), peer.outgoing.end(),
+                [&](const DelayedPacket& d) { return d.deliverAt > now; });
+            for (auto it = due; it != peer.outgoing.end(); ++it) {
+                peer.socket.sendTo(peer.remote, &it->packet, sizeof(it->packet));
+            }
+            peer.outgoing.erase(due, peer.outgoing.end());
+
+            NetAddress from;
+            PeerInputPacket packet;
+            while (peer.socket.receiveFrom(from, &packet, sizeof(packet)) == (int)sizeof(packet)) {
+                peer.session.receivePacket(packet);
+            }
+
+            if (peer.session.canAdvance()) {
+                const RollbackState& state = peer.session.getState();
+                bool jump = botJump(state.players[i], rng);
+                auto t0 = Clock::now();
+                peer.session.advance(jump);
+                advanceMicros.push_back(std::chrono::duration<float, std::micro>(Clock::now() - t0).count());
+            }
+            else {
+                peer.stalledFrames++;
+            }
+
+            uint64_t sum;
+            while (peer.session.getChecksum((uint32_t)peer.checksums.size(), sum)) {
+                peer.checksums.push_back(sum);
+            }
+
+            if ((int)(rng() % 100) >= lossPercent) {
+                DelayedPacket d;
+                d.deliverAt = now + std::chrono::milliseconds(std::max(0, latencyMs + jitter(rng)));
+                peer.session.buildPacket(d.packet);
+                peer.outgoing.push_back(d);
+            }
+        }
+    }
+
+    size_t verified = std::min(peers[0].checksums.size(), peers[1].checksums.size());
+    size_t desyncs = 0;
+    for (size_t f = 0; f < verified; f++) {
+        if (peers[0].checksums[f] != peers[1].checksums[f]) desyncs++;
+    }
+
+    std::sort(advanceMicros.begin(), advanceMicros.end());
+    const float budgetMicros = 1e6f / FPS;
+    const float maxMicros = advanceMicros.empty() ? 0 : advanceMicros.back();
+
+    std::cout << "Rollback loopback test: latency " << latencyMs << " ms, jitter +/-" << jitterMs
+        << " ms, loss " << lossPercent << "%, " << seconds << " s" << std::endl;
+    for (int i = 0; i < 2; i++) {
+        const RollbackStats& s = peers[i].session.getStats();
+        std::cout << "  peer " << i << ": " << s.frames << " frames, " << peers[i].stalledFrames << " stalled, "
+            << s.rollbacks << " rollbacks (avg " << (s.rollbacks ? (double)s.resimulatedFrames / s.rollbacks : 0)
+            << ", max " << s.maxRollback << " frames), round " << peers[i].session.getState().round << std::endl;
+    }
+    std::cout << "  advance() us: p50 " << percentile(advanceMicros, 0.50) << ", p99 "
+        << percentile(advanceMicros, 0.99) << ", max " << maxMicros
+        << " (frame budget " << budgetMicros << ")" << std::endl;
+    std::cout << "  sync check: " << verified << " confirmed frames compared, " << desyncs << " desyncs" << std::endl;
+
+    return verified > 0 && desyncs == 0 && maxMicros < budgetMicros;
+}
@@ -0,0 +1,93 @@
+﻿// ServerMain.cpp - 联机对战服务器（FlappyServer.exe）入口
+//
+// 用法：
+//   FlappyServer [--port 端口] [--workers 线程数] [--seconds 秒数]
+//       启动服务器；工作线程 i 监听 端口+i，默认每个CPU核心一个线程，一直运行
+//   FlappyServer --loadgen [主机] [端口] [会话数] [秒数] [客户端线程数]
+//       压力测试客户端，默认 127.0.0.1 27960 2000 10 1
+//   FlappyServer --rollback-test [单程延迟毫秒] [抖动毫秒] [丢包百分比] [秒数]
+//       点对点回滚联机的本机回环测试，默认 100 30 2 10；两端不同步或单帧超时返回1
+//   FlappyServer --spectator-load [主机] [端口] [观众数] [秒数] [机台数]
+//       观战转发压力测试（服务器需要已经启动），默认 127.0.0.1 27960 2000 10 4；画面解码不一致返回1
+//   FlappyServer --verify [回放文件] [排行榜输出] [线程数]
+//       重新模拟回放文件（默认 replays.dat）里的全部成绩，通过的成绩按排行榜格式写入输出文件；
+//       线程数默认每个CPU核心一个
+//   FlappyServer --verify-bench [回放条数] [线程数] [保存到]
+//       回放校验的吞吐量测试，默认 20000 条；篡改的成绩没有全部被拒绝或正常成绩被拒绝时返回1
+
+#include "../include/GameServer.h"
+#include "../include/LoadGenerator.h"
+#include "../include/ReplayVerifier.h"
+#include "../include/Rollback.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+    if (!UdpSocket::startup()) {
+        std::cout << "Network startup failed" << std::endl;
+        return 1;
+    }
+
+    int result = 0;
+    if (argc > 1 && strcmp(argv[1], "--loadgen") == 0) {
+        const char* host = argc > 2 ? argv[2] : "127.0.0.1";
+        uint16_t port = (uint16_t)(argc > 3 ? atoi(argv[3]) : SERVER_DEFAULT_PORT);
+        int sessions = argc > 4 ? atoi(argv[4]) : 2000;
+        double seconds = argc > 5 ? atof(argv[5]) : 10.0;
+        int threads = argc > 6 ? atoi(argv[6]) : 1;
+        result = LoadGenerator::run(host, port, sessions, seconds, threads) ? 0 : 1;
+    }
+    else if (argc > 1 && strcmp(argv[1], "--spectator-load") == 0) {
+        const char* host = argc > 2 ? argv[2] : "127.0.0.1";
+        uint16_t port = (uint16_t)(argc > 3 ? atoi(argv[3]) : SERVER_DEFAULT_PORT);
+        int viewers = argc > 4 ? atoi(argv[4]) : 2000;
+        double seconds = argc > 5 ? atof(argv[5]) : 10.0;
+        int cabinets = argc > 6 ? atoi(argv[6]) : 4;
+        result = LoadGenerator::runSpectators(host, port, viewers, seconds, cabinets) ? 0 : 1;
+    }
+    else if (argc > 1 && strcmp(argv[1], "--rollback-test") == 0) {
+        int latency = argc > 2 ? atoi(argv[2]) : 100;
+        int jitter = argc > 3 ? atoi(argv[3]) : 30;
+        int loss = argc > 4 ? atoi(argv[4]) : 2;
+        double seconds = argc > 5 ? atof(argv[5]) : 10.0;
+        result = RollbackSession::runLoopbackTest(latency, jitter, loss, seconds) ? 0 : 1;
+    }
+    else if (argc > 1 && strcmp(argv[1], "--verify") == 0) {
+        const char* path = argc > 2 ? argv[2] : REPLAY_FILE;
+        const char* output = argc > 3 ? argv[3] : nullptr;
+        int threads = argc > 4 ? atoi(argv[4]) : (int)std::thread::hardware_concurrency();
+        result = ReplayVerifier::verifyFile(path, output, threads) ? 0 : 1;
+    }
+    else if (argc > 1 && strcmp(argv[1], "--verify-bench") == 0) {
+        int count = argc > 2 ? atoi(argv[2]) : 20000;
+        int threads = argc > 3 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+        const char* savePath = argc > 4 ? argv[4] : nullptr;
+        result = ReplayVerifier::benchmark(count, threads, savePath) ? 0 : 1;
+    }
+    else {
+        uint16_t port = SERVER_DEFAULT_PORT;
+        int workers = (int)std::thread::hardware_concurrency();
+        double seconds = 0;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--port") == 0) port = (uint16_t)atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--workers") == 0) workers = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--seconds") == 0) seconds = atof(argv[i + 1]);
+        }
+
+        GameServer server(port, workers > 0 ? workers : 1);
+        if (server.start()) {
+            std::cout << "Server listening on UDP " << port << " ~ " << port + server.getWorkerCount() - 1
+                << " (" << server.getWorkerCount() << " workers)" << std::endl;
+            server.run(seconds);
+            server.stop();
+        }
+        else {
+            result = 1;
+        }
+    }
+
+    UdpSocket::cleanup();
+    return result;
+}
@@ -0,0 +1,268 @@
+﻿#include "../include/Simulation.h"
+#include <cstring>
+
+namespace {
+    const float TICK = (float)(1.0 / FPS);
+    const float GROUND_Y = (float)(SCREEN_HEIGHT - GROUND_HEIGHT - SIM_BIRD_RADIUS);
+
+    // 与 Windows RECT 相同的整数矩形，取整方式与游戏中的 (int) 转换一致
+    struct SimRect {
+        int left, top, right, bottom;
+    };
+
+    bool overlaps(const SimRect& a, const SimRect& b) {
+        return a.right > b.left && a.left < b.right && a.bottom > b.top && a.top < b.bottom;
+    }
+
+    SimRect birdRect(const SimState& s) {
+        const int r = SIM_BIRD_RADIUS, m = SIM_BIRD_MARGIN;
+        return { (int)s.birdX - r + m, (int)s.birdY - r + m, (int)s.birdX + r - m, (int)s.birdY + r - m };
+    }
+}
+
+void Simulation::reset(SimState& state, uint32_t seed, int difficulty) {
+    memset(&state, 0, sizeof(state));
+    state.rng = seed ? seed : 0x9E3779B9u;   // xorshift 的状态不能为0
+
+    // 与 Bird::reset 和 Game::startNewGame / applyDifficulty 一致
+    state.birdX = (float)(SCREEN_WIDTH / 4);
+    state.birdY = (float)(SCREEN_HEIGHT / 2);
+    state.scoreMultiplier = 1;
+    state.alive = 1;
+    state.difficulty = (uint8_t)difficulty;
+    state.level = 1;
+
+    switch (difficulty) {
+    case 0:
+        state.gravity = 0.4f;
+        state.jumpForce = -7.5f;
+        state.gameSpeed = 2.5f;
+        break;
+    case 2:
+        state.gravity = 0.6f;
+        state.jumpForce = -9.5f;
+        state.gameSpeed = 3.5f;
+        break;
+    default:
+        state.gravity = 0.5f;
+        state.jumpForce = -8.5f;
+        state.gameSpeed = 3.0f;
+        break;
+    }
+}
+
+// 与 Pipe::Pipe 共用 rollPipe，游戏和回放校验生成的管道逐位相同
+void Simulation::spawnPipe(SimState& state) {
+    if (state.pipeCount >= SIM_MAX_PIPES) return;
+
+    const PipeRoll roll = rollPipe(state.rng);
+    SimPipe& pipe = state.pipes[state.pipeCount++];
+    pipe.x = (float)SCREEN_WIDTH;
+    pipe.gapY = (float)roll.gapY;
+    pipe.id = state.nextPipeID++;
+    pipe.hasCoin = roll.hasCoin ? 1 : 0;
+    pipe.coinCollected = 0;
+    pipe.passed = 0;
+    pipe.colorType = (uint8_t)roll.colorType;
+}
+
+uint32_t Simulation::step(SimState& state, bool jump) {
+    if (!state.alive) return 0;
+
+    state.tick++;
+
+    // 输入
+    if (jump) {
+        state.birdVelocity = state.jumpForce;
+    }
+
+    state.gameTime += TICK;
+
+    // Bird::update
+    state.birdVelocity += state.gravity;
+    state.birdY += state.birdVelocity;
+    updateCombo(state);
+    if (state.birdY < SIM_BIRD_RADIUS) {
+        state.birdY = SIM_BIRD_RADIUS;
+        state.birdVelocity = 0;
+    }
+    if (state.birdY > GROUND_Y) {
+        state.birdY = GROUND_Y;
+        state.birdVelocity = 0;
+    }
+
+    // 落地
+    if (state.birdY >= GROUND_Y) {
+        state.alive = 0;
+        return SIM_EVENT_DIED;
+    }
+
+    movePipes(state);
+
+    SimRect bird = birdRect(state);
+
+    // 撞管道
+    for (int i = 0; i < state.pipeCount; i++) {
+        const SimPipe& pipe = state.pipes[i];
+        SimRect top = { (int)pipe.x, 0, (int)(pipe.x + SIM_PIPE_WIDTH), (int)(pipe.gapY - SIM_PIPE_GAP / 2) };
+        SimRect bottom = { (int)pipe.x, (int)(pipe.gapY + SIM_PIPE_GAP / 2),
+            (int)(pipe.x + SIM_PIPE_WIDTH), SCREEN_HEIGHT - GROUND_HEIGHT };
+        if (overlaps(bird, top) || overlaps(bird, bottom)) {
+            state.alive = 0;
+            return SIM_EVENT_DIED;
+        }
+    }
+
+    uint32_t events = 0;
+
+    // 硬币：每帧最多收集一枚
+    for (int i = 0; i < state.pipeCount; i++) {
+        SimPipe& pipe = state.pipes[i];
+        if (!pipe.hasCoin || pipe.coinCollected) continue;
+        SimRect coin = {
+            (int)(pipe.x + SIM_PIPE_WIDTH / 2 - SIM_COIN_RADIUS), (int)pipe.gapY - SIM_COIN_RADIUS,
+            (int)(pipe.x + SIM_PIPE_WIDTH / 2 + SIM_COIN_RADIUS), (int)pipe.gapY + SIM_COIN_RADIUS
+        };
+        if (overlaps(bird, coin)) {
+            pipe.coinCollected = 1;
+            state.coins += 10;
+            state.score += 5;
+            events |= SIM_EVENT_COIN;
+            break;
+        }
+    }
+
+    return events | updatePassAndSpawn(state);
+}
+
+void Simulation::updateCombo(SimState& state) {
+    if (state.comboTime > 0) {
+        state.comboTime -= TICK;
+        if (state.comboTime <= 0) {
+            state.comboCount = 0;
+            state.scoreMultiplier = 1;
+        }
+    }
+}
+
+// PipeManager::update：移动，移除出界的管道（保持顺序）
+void Simulation::movePipes(SimState& state) {
+    int kept = 0;
+    for (int i = 0; i < state.pipeCount; i++) {
+        SimPipe& pipe = state.pipes[i];
+        pipe.x -= state.gameSpeed;
+        if (pipe.x + SIM_PIPE_WIDTH >= 0) {
+            state.pipes[kept++] = pipe;
+        }
+    }
+    state.pipeCount = kept;
+}
+
+uint32_t Simulation::updatePassAndSpawn(SimState& state) {
+    uint32_t events = 0;
+
+    // 通过管道：同一帧通过多根也只计一次
+    bool passedAny = false;
+    for (int i = 0; i < state.pipeCount; i++) {
+        SimPipe& pipe = state.pipes[i];
+        if (!pipe.passed && pipe.x + SIM_PIPE_WIDTH < state.birdX) {
+            pipe.passed = 1;
+            passedAny = true;
+        }
+    }
+    if (passedAny) {
+        state.pipesPassed++;
+        state.score += state.scoreMultiplier;
+        // Bird::addCombo
+        state.comboCount++;
+        state.comboTime = 2.0f;
+        state.scoreMultiplier = 1 + state.comboCount / 3;
+        events |= SIM_EVENT_PASSED;
+
+        if (state.pipesPassed % 5 == 0) {
+            state.level++;
+            state.gameSpeed += 0.2f;
+            events |= SIM_EVENT_LEVEL_UP;
+        }
+    }
+
+    // 生成管道
+    state.pipeTimer += TICK;
+    float spawnInterval = (3.0f - state.level * 0.1f) > 1.5f ? (3.0f - state.level * 0.1f) : 1.5f;
+    if (state.pipeTimer > spawnInterval) {
+        state.pipeTimer = 0;
+        spawnPipe(state);
+        events |= SIM_EVENT_SPAWN;
+    }
+
+    return events;
+}
+
+void Simulation::buildColumn(const SimState& world, SimColumn& column) {
+    const int half = SIM_BIRD_RADIUS - SIM_BIRD_MARGIN;
+    const int birdLeft = (int)world.birdX - half;
+    const int birdRight = (int)world.birdX + half;
+
+    column.count = 0;
+    for (int i = 0; i < world.pipeCount; i++) {
+        const SimPipe& pipe = world.pipes[i];
+        if (!(birdRight > (int)pipe.x && birdLeft < (int)(pipe.x + SIM_PIPE_WIDTH))) continue;
+
+        SimColumnPipe& span = column.pipes[column.count++];
+        span.gapTop = (int)(pipe.gapY - SIM_PIPE_GAP / 2);
+        span.gapBottom = (int)(pipe.gapY + SIM_PIPE_GAP / 2);
+        span.coinTop = (int)pipe.gapY - SIM_COIN_RADIUS;
+        span.coinBottom = (int)pipe.gapY + SIM_COIN_RADIUS;
+        span.coinPipe = -1;
+        if (pipe.hasCoin && !pipe.coinCollected &&
+            birdRight > (int)(pipe.x + SIM_PIPE_WIDTH / 2 - SIM_COIN_RADIUS) &&
+            birdLeft < (int)(pipe.x + SIM_PIPE_WIDTH / 2 + SIM_COIN_RADIUS)) {
+            span.coinPipe = pipe.id;
+        }
+    }
+}
+
+uint32_t Simulation::stepBird(const SimState& world, const SimColumn& column,
+    float& y, float& velocity, int32_t& lastCoinPipe, bool jump) {
+    if (jump) velocity = world.jumpForce;
+    velocity += world.gravity;
+    y += velocity;
+    if (y < SIM_BIRD_RADIUS) {
+        y = SIM_BIRD_RADIUS;
+        velocity = 0;
+    }
+    if (y > GROUND_Y) {
+        y = GROUND_Y;
+        velocity = 0;
+    }
+    if (y >= GROUND_Y) return SIM_EVENT_DIED;
+
+    // Y 不小于半径，碰撞框不会越过屏幕上边和地面，只需比较间隙的上下边
+    const int half = SIM_BIRD_RADIUS - SIM_BIRD_MARGIN;
+    int top = (int)y - half;
+    int bottom = (int)y + half;
+    for (int s = 0; s < column.count; s++) {
+        if (top < column.pipes[s].gapTop || bottom > column.pipes[s].gapBottom) return SIM_EVENT_DIED;
+    }
+
+    for (int s = 0; s < column.count; s++) {
+        const SimColumnPipe& span = column.pipes[s];
+        if (span.coinPipe < 0 || lastCoinPipe == span.coinPipe) continue;
+        if (top < span.coinBottom && bottom > span.coinTop) {
+            lastCoinPipe = span.coinPipe;
+            return SIM_EVENT_COIN;   // 每帧最多收集一枚
+        }
+    }
+    return 0;
+}
+
+const SimPipe* Simulation::getNextPipe(const SimState& state, int skip) {
+    for (int i = 0; i < state.pipeCount; i++) {
+        const SimPipe& pipe = state.pipes[i];
+        if (pipe.x + SIM_PIPE_WIDTH >= state.birdX - SIM_BIRD_RADIUS) {
+            if (skip == 0) return &pipe;
+            skip--;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,296 @@
+﻿#include "../include/Solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const float TICK = (float)(1.0 / FPS);
+    const uint32_t NO_SLOT = 0xFFFFFFFFu;
+    const int MAX_PROBES = 64;
+    const size_t BATCH = 1024;          // 每次领取的路线数
+
+    // 键的布局（从低到高）：硬币标记1位、速度9位、Y 11位、帧号20位
+    const int TICK_BITS = 20;
+    const uint64_t TICK_MASK = (1u << TICK_BITS) - 1;
+    const int TICK_SHIFT = 16 + 21;
+
+    uint64_t packKey(uint32_t tick, float y, float velocity, bool coinFlag) {
+        int qy = (int)(y * SOLVER_Y_STEPS_PER_PIXEL);
+        int qv = (int)((velocity + 32.0f) * SOLVER_VELOCITY_STEPS);
+        qy = std::clamp(qy, 0, (1 << 11) - 1);
+        qv = std::clamp(qv, 0, (1 << 9) - 1);
+        return ((uint64_t)(tick & TICK_MASK) << 21) | ((uint64_t)qy << 10) | ((uint64_t)qv << 1) | (coinFlag ? 1 : 0);
+    }
+
+    uint64_t hashKey(uint64_t key) {
+        key ^= key >> 29;
+        key *= 0xBF58476D1CE4E5B9ull;
+        key ^= key >> 32;
+        return key;
+    }
+}
+
+Solver::Solver(int threads, int bits)
+    : table((size_t)1 << bits), tableMask(((uint64_t)1 << bits) - 1), nextPipeId(-1),
+      cursor(0), generation(0), pendingWorkers(0), stopping(false) {
+    memset(&world, 0, sizeof(world));
+    column.count = 0;
+    if (threads < 1) threads = 1;
+    outputs.resize(threads);
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&Solver::workerLoop, this, i);
+    }
+}
+
+Solver::~Solver() {
+    stopWorkers();
+}
+
+// ============================================================
+// 求解
+// ============================================================
+
+SolverResult Solver::solve(uint32_t seed, int difficulty, int targetPipes) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto& entry : table) {
+        entry.store(0, std::memory_order_relaxed);
+    }
+
+    Simulation::reset(world, seed, difficulty);
+    frontier.clear();
+    frontier.push_back({ world.birdY, world.birdVelocity, -1, NO_SLOT, 0 });
+
+    SolverResult result = {};
+    int bestDeathScore = 0;
+    int bestDeathPipes = 0;
+    int32_t lastCoins = 0;
+
+    while (!frontier.empty() && world.pipesPassed < targetPipes) {
+        // 所有路线共用的部分：与 Simulation::step 的顺序一致
+        world.tick++;
+        world.gameTime += TICK;
+        Simulation::updateCombo(world);
+        Simulation::movePipes(world);
+        Simulation::buildColumn(world, column);
+        const SimPipe* next = Simulation::getNextPipe(world, 0);
+        nextPipeId = next ? next->id : -1;
+
+        runLayer();
+
+        // 合并各线程的结果
+        frontier.clear();
+        for (WorkerOutput& out : outputs) {
+            frontier.insert(frontier.end(), out.next.begin(), out.next.end());
+            if (out.bestDeathScore > bestDeathScore) {
+                bestDeathScore = out.bestDeathScore;
+                bestDeathPipes = world.pipesPassed;
+            }
+            result.states += out.expanded;
+        }
+        result.peakWidth = std::max(result.peakWidth, frontier.size());
+
+        // 表里同时有两层的状态，保持负载在 1/4 以下，探测才会短
+        if (frontier.size() * 8 > table.size()) {
+            growTable(frontier.size() * 8);
+        }
+
+        if (!frontier.empty()) {
+            // 存活路线的最多硬币数（路线死光时用上一层的值）
+            lastCoins = 0;
+            for (const Node& node : frontier) {
+                lastCoins = std::max(lastCoins, readCoins(node));
+            }
+            result.ticks = world.tick;
+            Simulation::updatePassAndSpawn(world);
+        }
+    }
+
+    // 通过管道的得分对所有存活路线都一样，差别只在硬币（每枚 +5 分）
+    int survivorScore = world.score + lastCoins * 5;
+    result.completed = !frontier.empty();
+    result.pipesPassed = result.completed ? world.pipesPassed : std::max(world.pipesPassed, bestDeathPipes);
+    result.maxScore = std::max(bestDeathScore, survivorScore);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int Solver::readCoins(const Node& node) const {
+    if (node.slot == NO_SLOT) return node.coins;
+    return (int)(table[node.slot].load(std::memory_order_relaxed) & 0xFFFF);
+}
+
+// 扩大置换表：旧的项全部丢弃，只把当前层的状态重新放进去
+void Solver::growTable(size_t minEntries) {
+    for (Node& node : frontier) {
+        node.coins = readCoins(node);   // 旧表里合并过的硬币数
+    }
+
+    size_t size = table.size();
+    while (size < minEntries) size *= 2;
+    table = std::vector<std::atomic<uint64_t>>(size);
+    tableMask = size - 1;
+
+    for (Node& node : frontier) {
+        int coins = node.coins;
+        uint64_t key = packKey(world.tick, node.y, node.velocity, node.lastCoinPipe == nextPipeId);
+        uint64_t index = hashKey(key) & tableMask;
+        node.slot = NO_SLOT;
+        for (int probe = 0; probe < MAX_PROBES; probe++, index = (index + 1) & tableMask) {
+            uint64_t current = table[index].load(std::memory_order_relaxed);
+            if (current == 0) {
+                table[index].store((key << 16) | (uint64_t)std::min(coins, 0xFFFF), std::memory_order_relaxed);
+                node.slot = (uint32_t)index;
+                break;
+            }
+        }
+    }
+}
+
+// 展开一批路线：每条分别尝试"跳"和"不跳"
+void Solver::expandRange(WorkerOutput& out) {
+    for (;;) {
+        size_t begin = cursor.fetch_add(BATCH, std::memory_order_relaxed);
+        if (begin >= frontier.size()) return;
+        size_t end = std::min(begin + BATCH, frontier.size());
+
+        for (size_t i = begin; i < end; i++) {
+            const Node& parent = frontier[i];
+            int coins = readCoins(parent);
+            for (int jump = 0; jump < 2; jump++) {
+                Node child = { parent.y, parent.velocity, parent.lastCoinPipe, NO_SLOT, coins };
+                uint32_t events = Simulation::stepBird(world, column, child.y, child.velocity, child.lastCoinPipe,
+                    jump != 0);
+                out.expanded++;
+
+                if (events & SIM_EVENT_DIED) {
+                    // 死在这一帧：本帧的通过管道还没计分
+                    out.bestDeathScore = std::max(out.bestDeathScore, world.score + coins * 5);
+                    continue;
+                }
+                if (events & SIM_EVENT_COIN) child.coins++;
+                insert(out, child, child.lastCoinPipe == nextPipeId);
+            }
+        }
+    }
+}
+
+// 插入置换表：新状态加入下一层；已有的状态只更新硬币数的最大值
+void Solver::insert(WorkerOutput& out, const Node& node, bool coinFlag) {
+    const uint64_t key = packKey(world.tick, node.y, node.velocity, coinFlag);
+    const uint64_t word = (key << 16) | (uint64_t)std::min(node.coins, 0xFFFF);
+    const uint32_t tick = world.tick & TICK_MASK;
+
+    uint64_t index = hashKey(key) & tableMask;
+    for (int probe = 0; probe < MAX_PROBES; probe++, index = (index + 1) & tableMask) {
+        std::atomic<uint64_t>& entry = table[index];
+        uint64_t current = entry.load(std::memory_order_acquire);
+        for (;;) {
+            // 空位，或者是两层以前的旧状态（已经不会再被读取）
+            uint32_t entryTick = (uint32_t)(current >> TICK_SHIFT) & TICK_MASK;
+            bool stale = current == 0 || ((tick - entryTick) & TICK_MASK) >= 2;
+            if (stale) {
+                if (entry.compare_exchange_weak(current, word, std::memory_order_acq_rel)) {
+                    Node stored = node;
+                    stored.slot = (uint32_t)index;
+                    out.next.push_back(stored);
+                    return;
+                }
+                continue;   // 被其他线程抢先，重新判断这一格
+            }
+            if ((current >> 16) != key) break;   // 别的状态，探测下一格
+
+            // 同一个状态：保留较多的硬币数
+            if ((current & 0xFFFF) >= (word & 0xFFFF)) return;
+            if (entry.compare_exchange_weak(current, word, std::memory_order_acq_rel)) return;
+        }
+    }
+
+    // 表太满：不去重，直接加入下一层
+    out.next.push_back(node);
+}
+
+// ============================================================
+// 多线程：每层所有线程一起从 frontier 领取路线
+// ============================================================
+
+void Solver::runLayer() {
+    for (WorkerOutput& out : outputs) {
+        out.next.clear();
+        out.bestDeathScore = 0;
+        out.expanded = 0;
+    }
+    cursor.store(0, std::memory_order_relaxed);
+
+    if (!workers.empty() && frontier.size() > BATCH) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingWorkers = (int)workers.size();
+            generation++;
+        }
+        startCondition.notify_all();
+        expandRange(outputs[0]);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this]() { return pendingWorkers == 0; });
+    }
+    else {
+        expandRange(outputs[0]);
+    }
+}
+
+void Solver::workerLoop(int index) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        startCondition.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        lock.unlock();
+
+        expandRange(outputs[index]);
+
+        lock.lock();
+        if (--pendingWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+void Solver::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+// ============================================================
+// 命令行工具
+// ============================================================
+
+bool Solver::run(uint32_t seed, int targetPipes, int difficulty, int threads) {
+    Solver solver(threads);
+    const char* names[] = { "easy", "normal", "hard" };
+
+    bool allCompleted = true;
+    for (int d = 0; d < 3; d++) {
+        if (difficulty >= 0 && d != difficulty) continue;
+
+        SolverResult r = solver.solve(seed, d, targetPipes);
+        allCompleted = allCompleted && r.completed;
+        // 状态按格子合并过，没找到路线不能证明不可能；分数和管道数都是实际能达到的下界
+        std::cout << "Seed " << seed << " " << names[d] << ": "
+            << (r.completed ? "solvable" : "no line found at this resolution") << ", >= " << r.pipesPassed
+            << "/" << targetPipes << " pipes, max score >= " << r.maxScore << ", " << r.ticks << " ticks" << std::endl;
+        std::cout << "  " << r.states << " states in " << r.seconds << " s ("
+            << (r.seconds > 0 ? r.states / r.seconds / 1e6 : 0) << " M states/s, "
+            << threads << " thread(s)), peak width " << r.peakWidth << std::endl;
+    }
+    return allCompleted;
+}
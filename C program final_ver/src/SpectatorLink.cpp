@@ -0,0 +1,113 @@
+﻿#include "../include/NetSocket.h"     // 必须在其他可能包含 windows.h 的头文件之前
+#include "../include/SpectatorLink.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+    uint64_t nowMillis() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // HELLO 得到工作线程数，机台固定在 cabinetId % workerCount 号线程（端口 = 基础端口 + 线程编号）
+    bool findWorker(UdpSocket& socket, const char* host, uint16_t port, uint32_t cabinetId, NetAddress& out) {
+        NetAddress server;
+        if (!NetAddress::resolve(host, port, server)) return false;
+
+        PacketHeader hello = { PACKET_HELLO, SERVER_PROTOCOL_VERSION, 0 };
+        char buffer[SERVER_MAX_PACKET];
+        for (int attempt = 0; attempt < 3; attempt++) {
+            socket.sendTo(server, &hello, sizeof(hello));
+            uint64_t deadline = nowMillis() + 1000;
+            while (nowMillis() < deadline) {
+                socket.wait(100);
+                NetAddress from;
+                int size;
+                while ((size = socket.receiveFrom(from, buffer, sizeof(buffer))) > 0) {
+                    if (size < (int)sizeof(HelloReplyPacket) || ((PacketHeader*)buffer)->type != PACKET_HELLO_REPLY) continue;
+                    const HelloReplyPacket* reply = (const HelloReplyPacket*)buffer;
+                    int workers = reply->workerCount > 0 ? reply->workerCount : 1;
+                    out = server;
+                    out.addr.sin_port = htons((uint16_t)(reply->basePort + cabinetId % workers));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+// ============================================================
+// 机台
+// ============================================================
+
+SpectatorBroadcaster::SpectatorBroadcaster()
+    : socket(new UdpSocket()), server(new NetAddress()), cabinetId(0) {
+    UdpSocket::startup();
+}
+
+SpectatorBroadcaster::~SpectatorBroadcaster() {
+    delete socket;
+    delete server;
+    UdpSocket::cleanup();
+}
+
+bool SpectatorBroadcaster::open(const char* host, uint16_t port, uint32_t id) {
+    cabinetId = id;
+    encoder.reset();
+    return socket->open(0) && findWorker(*socket, host, port, id, *server);
+}
+
+void SpectatorBroadcaster::publish(const SpectatorFrame& frame, uint8_t events, bool playing) {
+    uint8_t message[SERVER_MAX_PACKET];
+    int size = encoder.encode(cabinetId, frame, events, playing, message);
+    if (size > 0) socket->sendTo(*server, message, size);
+}
+
+// ============================================================
+// 观众
+// ============================================================
+
+SpectatorViewer::SpectatorViewer()
+    : socket(new UdpSocket()), server(new NetAddress()), cabinetId(0), nextJoinMillis(0), messages(0), bytes(0) {
+    UdpSocket::startup();
+}
+
+SpectatorViewer::~SpectatorViewer() {
+    delete socket;
+    delete server;
+    UdpSocket::cleanup();
+}
+
+bool SpectatorViewer::open(const char* host, uint16_t port, uint32_t id) {
+    cabinetId = id;
+    decoder.reset();
+    nextJoinMillis = 0;
+    return socket->open(0) && findWorker(*socket, host, port, id, *server);
+}
+
+bool SpectatorViewer::poll(uint8_t& events) {
+    uint64_t now = nowMillis();
+    if (now >= nextJoinMillis) {
+        SpectateJoinPacket join = {};
+        join.header = { PACKET_SPECTATE_JOIN, SERVER_PROTOCOL_VERSION, 0 };
+        join.cabinetId = cabinetId;
+        socket->sendTo(*server, &join, sizeof(join));
+        nextJoinMillis = now + 1000;
+    }
+
+    bool updated = false;
+    events = 0;
+    char buffer[SERVER_MAX_PACKET];
+    NetAddress from;
+    int size;
+    while ((size = socket->receiveFrom(from, buffer, sizeof(buffer))) > 0) {
+        messages++;
+        bytes += size;
+        if (decoder.apply(buffer, size)) {
+            events |= decoder.getEvents();
+            updated = true;
+        }
+    }
+    return updated;
+}
@@ -0,0 +1,274 @@
+﻿#include "../include/SpectatorStream.h"
+#include <cstring>
+
+namespace {
+    const float TICK = (float)(1.0 / FPS);      // 与游戏的固定步长相同
+    const int FRAME_PREFIX = (int)(offsetof(SpectatorFrame, game) + offsetof(RewindFrame, pipes));
+
+    // 省略字段时观众端推算的值，与游戏的运算相同（结果逐位一致）
+    float predictComboTime(float comboTime) {
+        return comboTime > 0 ? comboTime - TICK : comboTime;
+    }
+
+    struct Writer {
+        uint8_t* p;
+        template <typename T> void put(const T& value) {
+            memcpy(p, &value, sizeof(T));
+            p += sizeof(T);
+        }
+    };
+
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+        template <typename T> bool get(T& value) {
+            if (end - p < (ptrdiff_t)sizeof(T)) return false;
+            memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+    };
+
+    void fillHeader(SpectateStreamHeader& header, uint32_t cabinetId, uint32_t tick, uint8_t kind, uint8_t events) {
+        memset(&header, 0, sizeof(header));
+        header.header.type = PACKET_SPECTATE_STREAM;
+        header.header.version = SERVER_PROTOCOL_VERSION;
+        header.cabinetId = cabinetId;
+        header.tick = tick;
+        header.kind = kind;
+        header.events = events;
+    }
+}
+
+// ============================================================
+// 编码
+// ============================================================
+
+SpectatorEncoder::SpectatorEncoder() : keyframes(0), deltas(0), bytes(0) {
+    memset(&last, 0, sizeof(last));
+    reset();
+}
+
+void SpectatorEncoder::reset() {
+    hasLast = false;
+    sinceKeyframe = 0;
+}
+
+int SpectatorEncoder::getKeyframeSize(const SpectatorFrame& frame) {
+    return (int)sizeof(SpectateStreamHeader) + FRAME_PREFIX + frame.game.pipeCount * (int)sizeof(RewindPipe);
+}
+
+int SpectatorEncoder::encode(uint32_t cabinetId, const SpectatorFrame& frame, uint8_t events, bool playing,
+    uint8_t* out) {
+    sinceKeyframe++;
+    const bool due = !hasLast || sinceKeyframe >= SPECTATE_KEYFRAME_TICKS;
+
+    int size = 0;
+    if (!playing) {
+        // 静止的画面：没有变化就只发心跳快照
+        bool changed = !hasLast || events != 0 || memcmp(&frame, &last, FRAME_PREFIX) != 0 ||
+            memcmp(&frame.game.pipes, &last.game.pipes, frame.game.pipeCount * sizeof(RewindPipe)) != 0;
+        if (!changed && !due) return 0;
+        size = writeKeyframe(cabinetId, frame, events, out);
+    }
+    else if (due || frame.game.tick != last.game.tick + 1 || frame.gameState != last.gameState ||
+        frame.particleSeed != last.particleSeed ||
+        memcmp(frame.playerName, last.playerName, SPECTATE_NAME_LENGTH) != 0) {
+        size = writeKeyframe(cabinetId, frame, events, out);
+    }
+    else {
+        size = writeDelta(cabinetId, frame, events, out);
+        if (size == 0) size = writeKeyframe(cabinetId, frame, events, out);   // 增量表示不了
+    }
+
+    last = frame;
+    hasLast = true;
+    bytes += size;
+    return size;
+}
+
+int SpectatorEncoder::writeKeyframe(uint32_t cabinetId, const SpectatorFrame& frame, uint8_t events, uint8_t* out) {
+    SpectateStreamHeader header;
+    fillHeader(header, cabinetId, frame.game.tick, SPECTATE_KEYFRAME, events);
+    memcpy(out, &header, sizeof(header));
+
+    int pipes = frame.game.pipeCount;
+    memcpy(out + sizeof(header), &frame, FRAME_PREFIX);
+    memcpy(out + sizeof(header) + FRAME_PREFIX, frame.game.pipes, pipes * sizeof(RewindPipe));
+
+    sinceKeyframe = 0;
+    keyframes++;
+    return getKeyframeSize(frame);
+}
+
+int SpectatorEncoder::writeDelta(uint32_t cabinetId, const SpectatorFrame& frame, uint8_t events, uint8_t* out) {
+    RewindDelta delta;
+    if (!RewindBuffer::encodeDelta(last.game, frame.game, delta)) return 0;
+
+    const RewindFrame& before = last.game;
+    uint16_t fields = 0;
+    Writer w = { out + sizeof(SpectateStreamHeader) };
+
+    if (delta.birdY != before.birdY || delta.birdVelocity != before.birdVelocity) {
+        fields |= SPECTATE_FIELD_BIRD;
+        w.put(delta.birdY);
+        w.put(delta.birdVelocity);
+    }
+    if (delta.comboCount != before.comboCount || delta.scoreMultiplier != before.scoreMultiplier ||
+        delta.comboTime != predictComboTime(before.comboTime)) {
+        fields |= SPECTATE_FIELD_COMBO;
+        w.put(delta.comboCount);
+        w.put(delta.scoreMultiplier);
+        w.put(delta.comboTime);
+    }
+    if (delta.scoreDelta || delta.coinsDelta) {
+        fields |= SPECTATE_FIELD_SCORE;
+        w.put(delta.scoreDelta);
+        w.put(delta.coinsDelta);
+    }
+    if (delta.levelDelta || delta.pipesPassedDelta || delta.gameSpeed != before.gameSpeed) {
+        fields |= SPECTATE_FIELD_LEVEL;
+        w.put(delta.levelDelta);
+        w.put(delta.pipesPassedDelta);
+        w.put(delta.gameSpeed);
+    }
+    if (delta.retired || delta.idsUsed || delta.coursePipes) {
+        fields |= SPECTATE_FIELD_PIPES;
+        w.put(delta.retired);
+        w.put(delta.idsUsed);
+        w.put(delta.coursePipes);
+    }
+    if (delta.passedMask || delta.coinMask) {
+        fields |= SPECTATE_FIELD_MASKS;
+        w.put(delta.passedMask);
+        w.put(delta.coinMask);
+    }
+    if (delta.spawned) {
+        fields |= SPECTATE_FIELD_SPAWN;
+        w.put(delta.spawn);
+    }
+    if (delta.pipeTimer != before.pipeTimer + TICK) {
+        fields |= SPECTATE_FIELD_TIMER;
+        w.put(delta.pipeTimer);
+    }
+    if (delta.gameTime != before.gameTime + TICK) {
+        fields |= SPECTATE_FIELD_TIME;
+        w.put(delta.gameTime);
+    }
+    if (frame.highScore != last.highScore) {
+        fields |= SPECTATE_FIELD_HIGH_SCORE;
+        w.put(frame.highScore);
+    }
+
+    SpectateStreamHeader header;
+    fillHeader(header, cabinetId, frame.game.tick, SPECTATE_DELTA, events);
+    header.fields = fields;
+    memcpy(out, &header, sizeof(header));
+
+    deltas++;
+    return (int)(w.p - out);
+}
+
+// ============================================================
+// 解码
+// ============================================================
+
+SpectatorDecoder::SpectatorDecoder() : gaps(0) {
+    reset();
+}
+
+void SpectatorDecoder::reset() {
+    memset(&frame, 0, sizeof(frame));
+    hasAny = false;
+    synced = false;
+    events = 0;
+}
+
+bool SpectatorDecoder::apply(const void* data, int size) {
+    if (size < (int)sizeof(SpectateStreamHeader)) return false;
+    SpectateStreamHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.header.type != PACKET_SPECTATE_STREAM || header.header.version != SERVER_PROTOCOL_VERSION) return false;
+
+    const uint8_t* body = (const uint8_t*)data + sizeof(header);
+    size -= (int)sizeof(header);
+
+    if (header.kind == SPECTATE_KEYFRAME) {
+        if (size < FRAME_PREFIX) return false;
+        SpectatorFrame received;
+        memcpy(&received, body, FRAME_PREFIX);
+        int pipes = received.game.pipeCount;
+        if (pipes < 0 || pipes > REWIND_MAX_PIPES || size < FRAME_PREFIX + pipes * (int)sizeof(RewindPipe)) return false;
+
+        memset(received.game.pipes, 0, sizeof(received.game.pipes));
+        memcpy(received.game.pipes, body + FRAME_PREFIX, pipes * sizeof(RewindPipe));
+        received.playerName[SPECTATE_NAME_LENGTH - 1] = 0;
+        frame = received;
+        hasAny = true;
+        synced = true;
+        events = header.events;
+        return true;
+    }
+    if (header.kind == SPECTATE_DELTA) {
+        if (!synced || header.tick <= frame.game.tick) return false;     // 等快照，或重复的消息
+        if (header.tick != frame.game.tick + 1) {
+            gaps++;
+            synced = false;
+            return false;
+        }
+        if (!applyDelta(header, body, size)) {
+            synced = false;
+            return false;
+        }
+        events = header.events;
+        return true;
+    }
+    return false;
+}
+
+bool SpectatorDecoder::applyDelta(const SpectateStreamHeader& header, const uint8_t* body, int size) {
+    const RewindFrame& before = frame.game;
+    const uint16_t fields = header.fields;
+    Reader r = { body, body + size };
+
+    // 省略的字段取上一帧的值或推算值
+    RewindDelta delta;
+    memset(&delta, 0, sizeof(delta));
+    delta.birdY = before.birdY;
+    delta.birdVelocity = before.birdVelocity;
+    delta.comboCount = (int16_t)before.comboCount;
+    delta.scoreMultiplier = (int16_t)before.scoreMultiplier;
+    delta.comboTime = predictComboTime(before.comboTime);
+    delta.gameSpeed = before.gameSpeed;
+    delta.pipeTimer = before.pipeTimer + TICK;
+    delta.gameTime = before.gameTime + TICK;
+    int32_t highScore = frame.highScore;
+
+    bool ok = true;
+    if (fields & SPECTATE_FIELD_BIRD) ok = ok && r.get(delta.birdY) && r.get(delta.birdVelocity);
+    if (fields & SPECTATE_FIELD_COMBO) {
+        ok = ok && r.get(delta.comboCount) && r.get(delta.scoreMultiplier) && r.get(delta.comboTime);
+    }
+    if (fields & SPECTATE_FIELD_SCORE) ok = ok && r.get(delta.scoreDelta) && r.get(delta.coinsDelta);
+    if (fields & SPECTATE_FIELD_LEVEL) {
+        ok = ok && r.get(delta.levelDelta) && r.get(delta.pipesPassedDelta) && r.get(delta.gameSpeed);
+    }
+    if (fields & SPECTATE_FIELD_PIPES) ok = ok && r.get(delta.retired) && r.get(delta.idsUsed) && r.get(delta.coursePipes);
+    if (fields & SPECTATE_FIELD_MASKS) ok = ok && r.get(delta.passedMask) && r.get(delta.coinMask);
+    if (fields & SPECTATE_FIELD_SPAWN) {
+        ok = ok && r.get(delta.spawn);
+        delta.spawned = 1;
+    }
+    if (fields & SPECTATE_FIELD_TIMER) ok = ok && r.get(delta.pipeTimer);
+    if (fields & SPECTATE_FIELD_TIME) ok = ok && r.get(delta.gameTime);
+    if (fields & SPECTATE_FIELD_HIGH_SCORE) ok = ok && r.get(highScore);
+    if (!ok) return false;
+
+    // 网络上来的数据：管道数不能越界
+    int surviving = before.pipeCount - delta.retired;
+    if (surviving < 0 || surviving + delta.spawned > REWIND_MAX_PIPES) return false;
+
+    RewindBuffer::applyDelta(frame.game, delta);
+    frame.highScore = highScore;
+    return true;
+}
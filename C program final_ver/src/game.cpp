@@ -8,9 +8,21 @@
 #include "../include/Bird.h"          // 包含小鸟类头文件
 #include "../include/Pipemanager.h"   // 包含管道管理器头文件
 #include "../include/AudioManager.h"
+#include "../include/AssetBundle.h"
+#include "../include/Profiler.h"
+#include "../include/AllocCounter.h"
+#include "../include/FrameArena.h"
+#include "../include/Autopilot.h"
+#include "../include/RewindBuffer.h"
+#include "../include/SpectatorLink.h"
+#include "../include/Replay.h"
+#include "../include/ParticleRenderer.h"
+#include "../include/RenderList.h"
+#include "../include/IdleWaiter.h"
+#include "../include/CloudLayers.h"
 #include <string>
-#include <mmsystem.h>
-#pragma comment(lib, "Winmm.lib")
+#include <atomic>
+#include <thread>
 // ============================================================
 // Particle类方法的实现
 // ============================================================
@@ -73,7 +85,7 @@ void Particle::draw() const {
 
 // 绘制星星形状的辅助方法
 void Particle::drawStar(int cx, int cy, int radius) const {
-    POINT points[10];  // 星星有10个顶点（5个外角，5个内角）
+    FrameVector<POINT> points(10);  // 星星有10个顶点（5个外角，5个内角），放在帧内存里
 
     // 计算星星的所有顶点坐标
     for (int i = 0; i < 10; i++) {
@@ -86,47 +98,7 @@ void Particle::drawStar(int cx, int cy, int radius) const {
     }
 
     // 使用多边形填充函数绘制星星
-    solidpolygon(points, 10);
-}
-
-// ============================================================
-// Cloud类方法的实现
-// ============================================================
-
-// Cloud构造函数：随机初始化云朵的属性
-Cloud::Cloud() {
-    x = rand() % SCREEN_WIDTH;          // 随机X坐标（0到屏幕宽度）
-    y = rand() % 200;                   // 随机Y坐标（0到200，天空区域）
-    // 随机速度（0.2到0.7像素/帧）
-    speed = (rand() % 50 + 20) / 100.0f;
-    size = 20 + rand() % 40;            // 随机大小（20到59像素）
-    alpha = 150 + rand() % 100;         // 随机透明度（150到249）
-}
-
-// 云朵更新方法：根据时间移动云朵
-void Cloud::update(float deltaTime) {
-    x -= speed * deltaTime * 60;        // 向左移动云朵（乘以60匹配游戏速度）
-
-    // 如果云朵完全移出屏幕左侧
-    if (x < -100) {
-        x = SCREEN_WIDTH + 100;         // 重置到屏幕右侧
-        y = rand() % 200;               // 随机新的Y坐标
-    }
-}
-
-// 云朵绘制方法：绘制云朵（多个圆形组合）
-void Cloud::draw() const {
-    setfillcolor(RGB(255, 255, 255));  // 设置填充颜色为白色
-    setlinecolor(RGB(255, 255, 255));  // 设置边框颜色为白色
-
-    // 绘制云朵的主体（4个重叠的圆形）
-    solidcircle((int)x, (int)y, size);                         // 主圆形
-    solidcircle((int)(x + size * 0.6), (int)(y - size * 0.3),  // 右上圆形
-        (int)(size * 0.7));
-    solidcircle((int)(x + size * 1.2), (int)y,                // 右圆形
-        (int)(size * 0.5));
-    solidcircle((int)(x - size * 0.4), (int)(y + size * 0.3), // 左下圆形
-        (int)(size * 0.6));
+    solidpolygon(points.data(), 10);
 }
 
 // ============================================================
@@ -135,7 +107,14 @@ void Cloud::draw() const {
 
 // Game构造函数：初始化游戏对象指针为nullptr
 Game::Game() 
-    : bird(nullptr), pipeManager(nullptr) {
+    : bird(nullptr), pipeManager(nullptr), assetLoadMillis(0),
+      frameStats(new FrameStats(FRAME_STATS_WINDOW_SECONDS)), tickAllocations(0), frameAllocations(0),
+      idleWaiter(new IdleWaiter()),
+      autopilot(new Autopilot()), autopilotEnabled(false), attractMode(false), idleTime(0), attractRounds(0),
+      rewind(new RewindBuffer()), rewindTick(0), rewindReturnState(STATE_MENU), rewindSeekMicros(0),
+      practiceRun(false), autopilotRun(false), broadcaster(nullptr), spectator(nullptr), spectatorEvents(0),
+      particleSeed((uint32_t)time(0)), replay(new ReplayRecorder()), particleRenderer(new ParticleRenderer()),
+      cloudLayers(new CloudLayers()) {
     init();  // 调用初始化方法
 }
 
@@ -143,6 +122,15 @@ Game::Game()
 Game::~Game() {
     delete bird;        // 释放小鸟对象内存
     delete pipeManager; // 释放管道管理器内存
+    delete frameStats;  // 释放帧时间统计
+    delete idleWaiter;
+    delete autopilot;   // 释放自动驾驶
+    delete rewind;      // 释放倒带缓冲
+    delete broadcaster; // 释放观战连接
+    delete spectator;
+    delete replay;      // 释放回放录制
+    delete particleRenderer;
+    delete cloudLayers;
 }
 
 // 游戏初始化方法：设置所有游戏变量和对象的初始状态
@@ -159,20 +147,16 @@ void Game::init() {
     gameTime = 0;       // 游戏总时间
     pipesPassed = 0;    // 通过的管道数量
     nextPipeID = 0;     // 下一个管道的ID
+    gameTicks = 0;      // 本局帧数
 
     // 初始化UI相关变量
     playerName = "Player";  // 默认玩家名称
     selectedMenu = 0;       // 菜单选择索引
     selectedSetting = 0;    // 设置选择索引
 
-    //加载背景图片
-    loadimage(&menuBackground, _T("assets/beginning.jpg"), SCREEN_WIDTH, SCREEN_HEIGHT);
-
-	//加载暂停背景图片
-	loadimage(&pauseBackground, _T("assets/pause.jpg"), SCREEN_WIDTH, SCREEN_HEIGHT);
-
     // 初始化动画效果变量
     animationTime = 0;      // 动画时间累计
+    groundOffset = 0;       // 地面滚动位置
     shakeTime = 0;          // 屏幕震动剩余时间
     shakeIntensity = 0;     // 屏幕震动强度
 
@@ -196,14 +180,12 @@ void Game::init() {
     if (pipeManager) delete pipeManager; // 如果已存在则先删除
     pipeManager = new PipeManager();    // 创建新的管道管理器
 
-    // 清空粒子效果和云朵
+    // 清空粒子效果
     particles.clear();  // 清空粒子数组
-    clouds.clear();     // 清空云朵数组
+    particles.reserve(MAX_PARTICLES);  // 一次性分配好，游戏中不再扩容
 
-    // 创建初始云朵（8朵）
-    for (int i = 0; i < 8; i++) {
-        clouds.push_back(Cloud());  // 添加新的云朵对象
-    }
+    // 放置云朵并合成视差层（一屏内平均 CLOUD_COUNT 朵）
+    cloudLayers->build(CLOUD_COUNT, (uint32_t)rand());
 
     // 加载排行榜数据
     loadLeaderboard();
@@ -212,22 +194,12 @@ void Game::init() {
     if (!leaderboard.empty()) {
         highScore = leaderboard[0].score;  // 取最高分记录
     }
+    // 加载背景图片和全部音效（优先使用资源包）
+    loadAssets();
+
     static bool audioLoaded = false; // 静态变量确保只加载一次
     if (!audioLoaded) {
         auto& audio = AudioManager::getInstance();
-        audio.loadSoundEffect("jump", "assets/jump.wav");
-        audio.loadSoundEffect("score", "assets/score.wav");
-        audio.loadSoundEffect("coin", "assets/coin.wav");
-        audio.loadSoundEffect("hit", "assets/hit.wav");
-        audio.loadSoundEffect("menu_move", "assets/menu_move.wav"); // 菜单移动声
-        audio.loadSoundEffect("menu_select", "assets/menu_select.wav"); // 菜单选择声
-        audio.loadSoundEffect("1", "assets/1.wav");
-        audio.loadSoundEffect("2", "assets/2.wav");
-        audio.loadSoundEffect("3", "assets/3.wav");
-        audio.loadSoundEffect("4", "assets/4.wav");
-        audio.loadSoundEffect("5", "assets/5.wav");
-        audio.loadSoundEffect("ui_bgm", "assets/ui_bgm.wav");
-
 
         // --- 设置全局音量 ---
         audio.setMasterVolume(100.0f); // 总音量
@@ -238,11 +210,326 @@ void Game::init() {
     }
 }
 
+#define UI_BGM_PATH "assets/ui_bgm.wav"
+
+// 资源清单：打包工具、资源包加载和散文件加载共用同一张表
+struct SoundAsset {
+    SoundId id;
+    const char* path;
+};
+
+static const SoundAsset soundAssets[] = {
+    { SOUND_JUMP, "assets/jump.wav" },
+    { SOUND_SCORE, "assets/score.wav" },
+    { SOUND_COIN, "assets/coin.wav" },
+    { SOUND_HIT, "assets/hit.wav" },
+    { SOUND_MENU_MOVE, "assets/menu_move.wav" },      // 菜单移动声
+    { SOUND_MENU_SELECT, "assets/menu_select.wav" },  // 菜单选择声
+    { SOUND_LEVEL_1, "assets/1.wav" },
+    { SOUND_LEVEL_2, "assets/2.wav" },
+    { SOUND_LEVEL_3, "assets/3.wav" },
+    { SOUND_LEVEL_4, "assets/4.wav" },
+    { SOUND_LEVEL_5, "assets/5.wav" },
+    { SOUND_UI_BGM, UI_BGM_PATH },      // 菜单音乐平时走流式播放，这个片段是读不到文件时的替补
+};
+
+#define MENU_BACKGROUND_PATH "assets/beginning.jpg"
+#define PAUSE_BACKGROUND_PATH "assets/pause.jpg"
+
+// 加载所有资源：有资源包就走资源包，否则退回到逐个读取散文件
+void Game::loadAssets() {
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+
+    if (!loadAssetBundle(ASSET_BUNDLE_PATH)) {
+        loadAssetFiles();
+    }
+
+    QueryPerformanceCounter(&end);
+    assetLoadMillis = (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart;
+}
+
+// 散文件加载（原来的方式）：JPG 解码缩放、WAV 解码都在主线程上逐个完成
+void Game::loadAssetFiles() {
+    loadimage(&menuBackground, _T(MENU_BACKGROUND_PATH), SCREEN_WIDTH, SCREEN_HEIGHT);
+    loadimage(&pauseBackground, _T(PAUSE_BACKGROUND_PATH), SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    auto& audio = AudioManager::getInstance();
+    for (const auto& asset : soundAssets) {
+        audio.loadSoundEffect(asset.id, asset.path);
+    }
+}
+
+// 资源包加载：映射整个文件，然后把每个条目的拷贝/格式转换分给多个线程并行完成
+bool Game::loadAssetBundle(const char* path) {
+    AssetBundle bundle;
+    if (!bundle.open(path)) return false;
+
+    // 每个任务负责一个条目：图片直接拷进 IMAGE 缓冲区，PCM 交给混音器转换格式
+    struct LoadJob {
+        const AssetEntry* entry;
+        DWORD* pixels;
+        SoundId sound;
+    };
+    std::vector<LoadJob> jobs;
+
+    // IMAGE 的尺寸调整必须在主线程完成，线程里只写像素
+    IMAGE* images[] = { &menuBackground, &pauseBackground };
+    const char* imagePaths[] = { MENU_BACKGROUND_PATH, PAUSE_BACKGROUND_PATH };
+    for (int i = 0; i < 2; i++) {
+        const AssetEntry* entry = bundle.find(imagePaths[i]);
+        if (!entry || entry->type != ASSET_IMAGE ||
+            entry->size != (uint64_t)entry->param0 * entry->param1 * sizeof(DWORD)) {
+            return false;
+        }
+        images[i]->Resize((int)entry->param0, (int)entry->param1);
+        jobs.push_back({ entry, GetImageBuffer(images[i]), SOUND_COUNT });
+    }
+    for (const auto& asset : soundAssets) {
+        const AssetEntry* entry = bundle.find(asset.path);
+        if (entry && entry->type == ASSET_PCM) {
+            jobs.push_back({ entry, nullptr, asset.id });
+        }
+    }
+
+    std::atomic<size_t> nextJob(0);
+    auto worker = [&]() {
+        auto& audio = AudioManager::getInstance();
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            const LoadJob& job = jobs[i];
+            const void* data = bundle.getData(job.entry);
+            if (job.pixels) {
+                memcpy(job.pixels, data, (size_t)job.entry->size);
+            }
+            else {
+                audio.loadSoundEffect(job.sound, (const int16_t*)data,
+                    (size_t)(job.entry->size / sizeof(int16_t)),
+                    job.entry->param0, job.entry->param1);
+            }
+        }
+    };
+
+    unsigned workerCount = std::thread::hardware_concurrency();
+    if (workerCount == 0) workerCount = 2;
+    if (workerCount > jobs.size()) workerCount = (unsigned)jobs.size();
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < workerCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();  // 主线程也参与
+    for (auto& t : workers) {
+        t.join();
+    }
+    return true;
+}
+
+// 打包工具：把原始 JPG/WAV 解码、缩放后写成一个资源包（FlappyBird.exe --pack）
+bool Game::packAssets(const char* path) {
+    AssetBundleWriter writer;
+
+    const char* imagePaths[] = { MENU_BACKGROUND_PATH, PAUSE_BACKGROUND_PATH };
+    for (const char* imagePath : imagePaths) {
+        wchar_t wpath[MAX_PATH];
+        size_t converted = 0;
+        mbstowcs_s(&converted, wpath, imagePath, MAX_PATH);
+
+        IMAGE image;
+        loadimage(&image, wpath, SCREEN_WIDTH, SCREEN_HEIGHT);
+        if (image.getwidth() != SCREEN_WIDTH || image.getheight() != SCREEN_HEIGHT) {
+            std::cout << "Failed to load " << imagePath << std::endl;
+            return false;
+        }
+        writer.addImage(imagePath, GetImageBuffer(&image), SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+
+    for (const auto& asset : soundAssets) {
+        sf::SoundBuffer buffer;
+        if (!buffer.loadFromFile(asset.path)) {
+            std::cout << "Skipped missing sound " << asset.path << std::endl;
+            continue;
+        }
+        writer.addPCM(asset.path, buffer.getSamples(), (size_t)buffer.getSampleCount(),
+            buffer.getChannelCount(), buffer.getSampleRate());
+    }
+
+    if (!writer.write(path)) {
+        std::cout << "Failed to write " << path << std::endl;
+        return false;
+    }
+    std::cout << "Asset bundle written to " << path << std::endl;
+    return true;
+}
+
+// 启动耗时测试：重复加载资源 runs 次，输出最短/平均/最长耗时（FlappyBird.exe --bench-startup）
+void Game::benchmarkStartup(int runs) {
+    double total = 0, best = 1e9, worst = 0;
+    for (int i = 0; i < runs; i++) {
+        loadAssets();
+        total += assetLoadMillis;
+        if (assetLoadMillis < best) best = assetLoadMillis;
+        if (assetLoadMillis > worst) worst = assetLoadMillis;
+    }
+    std::cout << "Asset load over " << runs << " runs: min " << best
+        << " ms, avg " << total / runs << " ms, max " << worst << " ms" << std::endl;
+}
+
+// 加载比赛赛道：之后的每一局都使用赛道里固定的管道序列
+bool Game::loadCourse(const char* path) {
+    if (!course.open(path)) {
+        std::cout << "无法加载赛道: " << path << std::endl;
+        return false;
+    }
+    std::cout << "赛道已加载: " << path << "（" << course.getPipeCount() << " 根管道）" << std::endl;
+    return true;
+}
+
+// 把当前局面（小鸟、管道、本局数据）复制成 Simulation 的状态，供自动驾驶向前模拟
+// 随机数种子无关紧要：新管道生成在屏幕右边缘，搜索视野内到不了小鸟
+void Game::captureSimState(SimState& state) const {
+    Simulation::reset(state, (uint32_t)gameTicks + 1, difficulty);
+
+    state.tick = (uint32_t)gameTicks;
+    state.birdX = bird->getX();
+    state.birdY = bird->getY();
+    state.birdVelocity = bird->getVelocity();
+    state.gravity = bird->getGravity();
+    state.jumpForce = bird->getJumpForce();
+    state.comboTime = bird->getComboTime();
+    state.comboCount = bird->getComboCount();
+    state.scoreMultiplier = bird->getScoreMultiplier();
+    state.alive = bird->isAlive() ? 1 : 0;
+
+    state.score = score;
+    state.coins = coins;
+    state.level = level;
+    state.pipesPassed = pipesPassed;
+    state.nextPipeID = nextPipeID;
+    state.gameSpeed = gameSpeed;
+    state.pipeTimer = pipeTimer;
+    state.gameTime = gameTime;
+
+    size_t count = std::min(pipeManager->getPipeCount(), (size_t)SIM_MAX_PIPES);
+    state.pipeCount = (int32_t)count;
+    for (size_t i = 0; i < count; i++) {
+        const Pipe& pipe = pipeManager->getPipe(i);
+        SimPipe& sim = state.pipes[i];
+        sim.x = pipe.getX();
+        sim.gapY = pipe.getGapY();
+        sim.id = pipe.getID();
+        sim.hasCoin = pipe.hasCoinAvailable() ? 1 : 0;
+        sim.coinCollected = 0;
+        sim.passed = pipe.isPassed() ? 1 : 0;
+        sim.colorType = 0;
+    }
+}
+
+// 稳定状态零分配检查：自动驾驶玩 ticks 帧（每帧 update + render，不限速），
+// 开局后的预热帧不计，小鸟死亡则重开；任何一帧有堆分配就返回 false
+bool Game::checkSteadyStateAllocations(int ticks) {
+    const int WARMUP_TICKS = 120;
+    const float tick = (float)(1.0 / FPS);
+
+    initgraph(SCREEN_WIDTH, SCREEN_HEIGHT);
+    AudioManager::getInstance().setMasterVolume(0);
+    srand(12345);
+    startNewGame();
+
+    int sinceStart = 0, jumpCooldown = 0;
+    int checkedTicks = 0, dirtyTicks = 0, dirtyFrames = 0;
+    uint64_t totalAllocations = 0;
+    for (int i = 0; i < ticks; i++) {
+        // 跳跃走与玩家输入相同的 jumpBird()（粒子、音效、观战事件、回放记录），
+        // 和 update 一样计入这一帧的分配
+        AllocationScope tickScope;
+
+        // 简单的自动驾驶：低于下一根管道间隙中心就跳（两次跳跃之间留出间隔）
+        float targetY = (SCREEN_HEIGHT - GROUND_HEIGHT) / 2.0f;
+        const Pipe* next = pipeManager->getNextPipe(bird->getX());
+        if (next) targetY = next->getGapY() + 20;
+        if (jumpCooldown > 0) jumpCooldown--;
+        if (bird->getY() > targetY && jumpCooldown == 0) {
+            jumpBird();
+            jumpCooldown = 12;
+        }
+
+        update(tick);
+        uint64_t tickCount = tickScope.count();
+
+        AllocationScope frameScope;
+        render();
+        uint64_t frameCount = frameScope.count();
+        FrameArena::getInstance().reset();
+
+        if (currentState != STATE_PLAYING) {
+            // 死亡和重开会读写排行榜文件，不属于稳定状态
+            startNewGame();
+            sinceStart = 0;
+            continue;
+        }
+        if (++sinceStart <= WARMUP_TICKS) continue;
+
+        checkedTicks++;
+        if (tickCount) dirtyTicks++;
+        if (frameCount) dirtyFrames++;
+        totalAllocations += tickCount + frameCount;
+    }
+
+    closegraph();
+
+    std::cout << "Steady-state allocation check: " << checkedTicks << " ticks checked, "
+        << dirtyTicks << " ticks and " << dirtyFrames << " frames allocated ("
+        << totalAllocations << " allocations)" << std::endl;
+    return checkedTicks > 0 && totalAllocations == 0;
+}
+
+// 导出各界面的绘制命令：固定随机种子，自动玩一小段后依次渲染每个界面一帧，
+// 把命令列表的字节流依次写入 path。两个版本导出的文件逐字节相同，说明画面没有变化
+bool Game::dumpRenderCommands(const char* path) {
+    const float tick = (float)(1.0 / FPS);
+    const GameState screens[] = {
+        STATE_MENU, STATE_PLAYING, STATE_PAUSED, STATE_GAME_OVER,
+        STATE_LEADERBOARD, STATE_SETTINGS, STATE_HELP, STATE_CREDITS
+    };
+    const char* names[] = { "menu", "playing", "paused", "game over", "leaderboard", "settings", "help", "credits" };
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Failed to write " << path << std::endl;
+        return false;
+    }
+
+    initgraph(SCREEN_WIDTH, SCREEN_HEIGHT);
+    AudioManager::getInstance().setMasterVolume(0);
+    showFPS = false;        // 统计面板的内容每次运行都不同
+    srand(12345);
+    startNewGame();
+    for (int i = 0; i < 90; i++) {
+        if (i % 15 == 0) bird->jump();
+        update(tick);
+    }
+
+    RenderList& canvas = RenderList::getInstance();
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < (int)(sizeof(screens) / sizeof(screens[0])); i++) {
+        currentState = screens[i];
+        render();
+        canvas.serialize(bytes);
+        file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+        std::cout << names[i] << ": " << canvas.getCommandCount() << " commands, "
+            << bytes.size() << " bytes" << std::endl;
+    }
+
+    closegraph();
+    return file.good();
+}
+
 // 加载排行榜方法：从文件读取排行榜数据
-void Game::loadLeaderboard() {
+void Game::loadLeaderboard(const char* path) {
     leaderboard.clear();  // 清空当前排行榜
 
-    std::ifstream file("leaderboard.dat");  // 打开排行榜文件
+    std::ifstream file(path);  // 打开排行榜文件
     if (file.is_open()) {  // 如果文件成功打开
         std::string line;  // 用于存储每行数据
 
@@ -271,11 +558,11 @@ void Game::loadLeaderboard() {
 }
 
 // 保存排行榜方法：将排行榜数据写入文件
-void Game::saveLeaderboard() {
-    std::ofstream file("leaderboard.dat");  // 打开排行榜文件（输出模式）
+void Game::saveLeaderboard(const char* path, size_t maxEntries) {
+    std::ofstream file(path);  // 打开排行榜文件（输出模式）
     if (file.is_open()) {  // 如果文件成功打开
-        // 保存前10名记录
-        for (size_t i = 0; i < leaderboard.size() && i < 10; i++) {
+        // 保存前 maxEntries 名记录（默认10名）
+        for (size_t i = 0; i < leaderboard.size() && i < maxEntries; i++) {
             // 将记录写入文件（空格分隔）
             file << leaderboard[i].playerName << " "
                 << leaderboard[i].score << " "
@@ -289,27 +576,39 @@ void Game::saveLeaderboard() {
 
 // 添加到排行榜方法：将当前游戏记录添加到排行榜
 void Game::addToLeaderboard() {
-    // 创建当前游戏的分数记录
+    // 创建当前游戏的分数记录并插入排行榜
     ScoreEntry entry(playerName, score, level, (int)gameTime);
-    leaderboard.push_back(entry);  // 添加到排行榜数组
+    insertLeaderboardEntry(entry);
 
-    std::sort(leaderboard.begin(), leaderboard.end());  // 重新排序
+    saveLeaderboard();  // 保存到文件
 
-    // 如果超过10条记录，只保留前10名
-    if (leaderboard.size() > 10) {
-        leaderboard.resize(10);  // 调整数组大小为10
+    // 随机管道的成绩附上回放（死亡的那一帧没有计入 gameTicks），比赛赛道的成绩由赛道本身校验
+    if (!pipeManager->hasCourse()) {
+        replay->append(REPLAY_FILE, playerName.c_str(), score, level, (int)gameTime,
+            (int64_t)entry.date, (uint32_t)gameTicks + 1);
     }
 
-    saveLeaderboard();  // 保存到文件
-
     // 更新最高分
     if (score > highScore) {
         highScore = score;
     }
 }
 
+// 插入一条记录：重新排序，只保留前 LEADERBOARD_SIZE 名
+void Game::insertLeaderboardEntry(const ScoreEntry& entry) {
+    leaderboard.push_back(entry);  // 添加到排行榜数组
+
+    std::sort(leaderboard.begin(), leaderboard.end());  // 重新排序
+
+    // 如果超过10条记录，只保留前10名
+    if (leaderboard.size() > LEADERBOARD_SIZE) {
+        leaderboard.resize(LEADERBOARD_SIZE);  // 调整数组大小为10
+    }
+}
+
 // 更新输入方法：检测键盘按键状态
 void Game::updateInput() {
+    bool anyPressed = false;
     // 遍历256个可能的按键
     for (int i = 0; i < 256; i++) {
         // 获取当前按键状态（GetAsyncKeyState返回按键状态）
@@ -318,13 +617,56 @@ void Game::updateInput() {
         keyPressed[i] = currentKeyState && !keys[i];
         // 更新当前帧按键状态
         keys[i] = currentKeyState;
+        anyPressed = anyPressed || keyPressed[i];
+    }
+
+    if (anyPressed) {
+        idleTime = 0;  // 有操作，重新计算主菜单的空闲时间
+        attractRounds = 0;
+        // 自动演示中按任意键回到主菜单，这次按键不再做其他处理
+        if (attractMode) {
+            stopAttractMode();
+            return;
+        }
     }
 
     handleInput();  // 调用输入处理函数
 }
 
+// 是否有按键的按下/松开状态与上一次 updateInput 不同（不修改按键状态）
+bool Game::keyStateChanged() const {
+    for (int i = 0; i < 256; i++) {
+        bool currentKeyState = GetAsyncKeyState(i) & 0x8000;
+        if (currentKeyState != keys[i]) return true;
+    }
+    return false;
+}
+
+// 静态界面：画面只随输入和背景动画变化，可以不按60FPS重画
+bool Game::isStaticScreen() const {
+    return currentState == STATE_MENU || currentState == STATE_LEADERBOARD ||
+        currentState == STATE_SETTINGS || currentState == STATE_HELP ||
+        currentState == STATE_CREDITS;
+}
+
 // 处理输入方法：根据当前游戏状态调用对应的输入处理函数
 void Game::handleInput() {
+    // F9：采集接下来的帧并导出性能分析文件（任何界面都可用）
+    if (keyPressed[VK_F9]) {
+        Profiler::getInstance().beginCapture(PROFILER_CAPTURE_FRAMES);
+    }
+    // F8：把最近的帧时间原始样本导出为 CSV
+    if (keyPressed[VK_F8]) {
+        char path[64];
+        time_t t = time(nullptr);
+        tm local;
+        localtime_s(&local, &t);
+        strftime(path, sizeof(path), "frametimes_%Y%m%d_%H%M%S.csv", &local);
+        if (frameStats->dumpCsv(path)) {
+            std::cout << "帧时间已保存: " << path << std::endl;
+        }
+    }
+
     switch (currentState) {  // 根据游戏状态选择处理函数
     case STATE_MENU:
         handleMenuInput();           // 主菜单输入处理
@@ -350,9 +692,107 @@ void Game::handleInput() {
     case STATE_CREDITS:
         handleCreditsInput();        // 制作人员界面输入处理
         break;
+    case STATE_REWIND:
+        handleRewindInput();         // 倒带界面输入处理
+        break;
+    }
+}
+
+// 小鸟跳跃：粒子效果和音效（玩家和自动驾驶共用）
+void Game::jumpBird() {
+    bird->jump();  // 调用小鸟跳跃方法
+    // 在跳跃位置创建粒子效果
+    createParticles(bird->getX(), bird->getY(), 8, RGB(255, 255, 0), 1);
+    AudioManager::getInstance().playSound(SOUND_JUMP, 15.0f);
+    spectatorEvents |= SPECTATE_EVENT_JUMP;
+    replay->recordJump((uint32_t)gameTicks);   // 在第 gameTicks 帧更新之前生效
+}
+
+// 自动演示：由自动驾驶玩一局，成绩不进排行榜
+void Game::startAttractMode() {
+    attractMode = true;
+    autopilotEnabled = true;
+    idleTime = 0;
+    attractRounds++;
+    startNewGame();
+}
+
+void Game::stopAttractMode() {
+    attractMode = false;
+    autopilotEnabled = false;
+    idleTime = 0;
+    currentState = STATE_MENU;
+}
+
+// 进入倒带界面，从最新记录的一帧开始（自动演示不记录，也不能倒带）
+void Game::startRewind() {
+    if (attractMode || rewind->isEmpty()) return;
+
+    rewindReturnState = currentState;
+    shakeTime = 0;
+    currentState = STATE_REWIND;
+    seekRewind(rewind->getNewestTick());
+}
+
+// 跳到第 tick 帧并显示
+void Game::seekRewind(uint32_t tick) {
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+
+    RewindFrame frame;
+    bool found = rewind->seek(tick, frame);
+
+    QueryPerformanceCounter(&end);
+    rewindSeekMicros = (double)(end.QuadPart - start.QuadPart) * 1e6 / frequency.QuadPart;
+
+    if (found) {
+        restoreRewindFrame(frame);
+        rewindTick = tick;
+    }
+}
+
+// 倒带缓冲的一帧：小鸟、管道和本局数据（重力、跳跃力量等设置在一局中不变，不保存）
+void Game::captureRewindFrame(RewindFrame& frame) const {
+    memset(&frame, 0, sizeof(frame));
+    frame.courseCursor = pipeManager->getCourseCursor();
+    frame.tick = (uint32_t)gameTicks;
+    frame.pipeRng = pipeManager->getRngState();
+    frame.birdY = bird->getY();
+    frame.birdVelocity = bird->getVelocity();
+    frame.comboTime = bird->getComboTime();
+    frame.comboCount = bird->getComboCount();
+    frame.scoreMultiplier = bird->getScoreMultiplier();
+    frame.score = score;
+    frame.coins = coins;
+    frame.level = level;
+    frame.pipesPassed = pipesPassed;
+    frame.nextPipeID = nextPipeID;
+    frame.gameSpeed = gameSpeed;
+    frame.pipeTimer = pipeTimer;
+    frame.gameTime = gameTime;
+
+    size_t count = std::min(pipeManager->getPipeCount(), (size_t)REWIND_MAX_PIPES);
+    frame.pipeCount = (int32_t)count;
+    for (size_t i = 0; i < count; i++) {
+        pipeManager->getPipe(i).save(frame.pipes[i]);
     }
 }
 
+void Game::restoreRewindFrame(const RewindFrame& frame) {
+    bird->restore(frame.birdY, frame.birdVelocity, frame.comboTime, frame.comboCount, frame.scoreMultiplier);
+    pipeManager->restorePipes(frame.pipes, frame.pipeCount, frame.courseCursor, frame.pipeRng);
+    score = frame.score;
+    coins = frame.coins;
+    level = frame.level;
+    pipesPassed = frame.pipesPassed;
+    nextPipeID = frame.nextPipeID;
+    gameSpeed = frame.gameSpeed;
+    pipeTimer = frame.pipeTimer;
+    gameTime = frame.gameTime;
+    gameTicks = (int)frame.tick;
+}
+
 // 主菜单输入处理方法：处理菜单导航和选择
 void Game::handleMenuInput() {
     // 上方向键：菜单项向上移动
@@ -399,12 +839,15 @@ void Game::handleMenuInput() {
 
 // 游戏输入处理方法：处理游戏中的按键
 void Game::handleGameInput() {
-    // 空格键或上方向键：小鸟跳跃
-    if (keyPressed[VK_SPACE] || keyPressed[VK_UP]) {
-        bird->jump();  // 调用小鸟跳跃方法
-        // 在跳跃位置创建粒子效果
-        createParticles(bird->getX(), bird->getY(), 8, RGB(255, 255, 0), 1);
-        AudioManager::getInstance().playSound("jump",15.0f);
+    // 空格键或上方向键：小鸟跳跃（自动驾驶时由它控制）
+    if ((keyPressed[VK_SPACE] || keyPressed[VK_UP]) && !autopilotEnabled) {
+        jumpBird();
+    }
+    // F7：切换自动驾驶；开过一次，这一局就不算玩家自己的成绩
+    if (keyPressed[VK_F7]) {
+        autopilotEnabled = !autopilotEnabled;
+        autopilot->reset();
+        if (autopilotEnabled) autopilotRun = true;
     }
     // ESC键：暂停游戏
     if (keyPressed[VK_ESCAPE]) {
@@ -414,6 +857,10 @@ void Game::handleGameInput() {
     if (keyPressed['R'] || keyPressed['r']) {
         startNewGame();  // 开始新游戏
     }
+    // 退格键：倒带
+    if (keyPressed[VK_BACK]) {
+        startRewind();
+    }
 }
 
 // 暂停状态输入处理方法
@@ -442,9 +889,47 @@ void Game::handleGameOverInput() {
     if (keyPressed[VK_ESCAPE]) {
         currentState = STATE_MENU;  // 切换到主菜单
     }
+    // 退格键：倒带到死亡之前
+    if (keyPressed[VK_BACK]) {
+        startRewind();
+    }
 }
 
-// 排行榜界面输入处理方法
+// 倒带界面输入处理：按住左方向键（或退格键）往回倒，右方向键往前，空格/回车从这一帧继续，ESC取消
+void Game::handleRewindInput() {
+    uint32_t oldest = rewind->getOldestTick();
+    uint32_t newest = rewind->getNewestTick();
+    uint32_t target = rewindTick;
+
+    if (keys[VK_LEFT] || keys[VK_BACK]) {
+        target = target > oldest + REWIND_SCRUB_TICKS ? target - REWIND_SCRUB_TICKS : oldest;
+    }
+    if (keys[VK_RIGHT]) {
+        target = std::min(target + REWIND_SCRUB_TICKS, newest);
+    }
+    if (target != rewindTick) {
+        seekRewind(target);
+    }
+
+    if (keyPressed[VK_SPACE] || keyPressed[VK_RETURN]) {
+        // 丢弃之后的记录，从这一帧继续；用过倒带的这一局不再记录成绩
+        RewindFrame frame;
+        if (rewind->resumeAt(rewindTick, frame)) {
+            restoreRewindFrame(frame);
+        }
+        practiceRun = true;
+        autopilot->reset();
+        currentState = STATE_PLAYING;
+    }
+    else if (keyPressed[VK_ESCAPE]) {
+        // 取消：回到最新的一帧；从结束界面进来的，小鸟仍然是死亡状态
+        seekRewind(newest);
+        if (rewindReturnState == STATE_GAME_OVER) {
+            bird->kill();
+        }
+        currentState = rewindReturnState;
+    }
+}
 void Game::handleLeaderboardInput() {
     // ESC键或空格键：返回主菜单
     if (keyPressed[VK_ESCAPE] || keyPressed[VK_SPACE]) {
@@ -549,31 +1034,43 @@ void Game::handleCreditsInput() {
 
 // 游戏更新方法：根据时间更新游戏状态
 void Game::update(float deltaTime) {
+    PROFILE_SCOPE("Game::update");
+
     // --- 音频控制逻辑 ---
+    // UI 背景音乐走音乐总线（音量30%，与原来 MCI 的 300/1000 一致），由 MusicStream 在后台线程
+    // 读文件、解码。流只在第一次进入菜单时打开一次：进入游戏时暂停，回到菜单/暂停界面时恢复，
+    // 预读好的缓冲区原样保留，从上次的位置立即接着播放，不再重新读盘
+    static bool isUIBGMOpened = false;
     static bool isUIBGMPlaying = false;
-    const char* uiAlias = "UI_BGM_CHANNEL"; // 给 UI 音乐一个固定别名
+    static bool isUIBGMFallback = false;    // 文件读不出来时改用启动时解码好的片段
+    AudioManager& audio = AudioManager::getInstance();
 
     if (currentState == STATE_MENU || currentState == STATE_PAUSED) {
         if (!isUIBGMPlaying) {
-            // 1. 先关闭旧的（以防万一）
-            mciSendStringA("close UI_BGM_CHANNEL", NULL, 0, NULL);
-            // 2. 打开文件
-            mciSendStringA("open \"assets/ui_bgm.wav\" type mpegvideo alias UI_BGM_CHANNEL", NULL, 0, NULL);
-            // 3. 设置音量 (0-1000)
-            mciSendStringA("setaudio UI_BGM_CHANNEL volume to 300", NULL, 0, NULL);
-            // 4. 循环播放 (repeat)
-            mciSendStringA("play UI_BGM_CHANNEL repeat", NULL, 0, NULL);
-
-            isUIBGMPlaying = true;
+            if (isUIBGMFallback) {
+                audio.startLoop(SOUND_UI_BGM, 30.0f);
+                isUIBGMPlaying = true;
+            }
+            else if (isUIBGMOpened) {
+                audio.resumeMusic();
+                isUIBGMPlaying = true;
+            }
+            else if (audio.playMusic(UI_BGM_PATH, true)) {  // 返回 false 时下一帧再试
+                isUIBGMOpened = true;
+                isUIBGMPlaying = true;
+            }
+        }
+        if (isUIBGMPlaying && !isUIBGMFallback && audio.getMusicStream().hasError()) {
+            audio.stopMusic();
+            audio.startLoop(SOUND_UI_BGM, 30.0f);
+            isUIBGMFallback = true;
         }
     }
     else {
         // 当状态不是菜单或暂停时（例如进入了 STATE_PLAYING）
         if (isUIBGMPlaying) {
-            // --- 关键修改：瞬间停止并关闭通道 ---
-            mciSendStringA("stop UI_BGM_CHANNEL", NULL, 0, NULL);
-            mciSendStringA("close UI_BGM_CHANNEL", NULL, 0, NULL);
-
+            if (isUIBGMFallback) audio.stopLoop();
+            else audio.pauseMusic();
             isUIBGMPlaying = false;
         }
     }
@@ -587,27 +1084,61 @@ void Game::update(float deltaTime) {
         shakeIntensity *= 0.9f;          // 逐渐减弱震动强度
     }
 
-    // 更新所有云朵的位置
-    for (auto& cloud : clouds) {
-        cloud.update(deltaTime);
-    }
+    // 云朵的视差层向左滚动
+    cloudLayers->update(deltaTime);
 
     // 更新所有粒子效果
     updateParticles(deltaTime);
 
+    // 主菜单无操作一段时间后进入自动演示；演示中小鸟死亡后稍等片刻重新开始。
+    // 演示满 ATTRACT_MAX_ROUNDS 局后回到主菜单，直到有按键都不再演示，主菜单重新进入省电等待
+    if (currentState == STATE_MENU || (attractMode && currentState == STATE_GAME_OVER)) {
+        idleTime += deltaTime;
+        float waitSeconds = attractMode ? ATTRACT_RESTART_SECONDS : ATTRACT_IDLE_SECONDS;
+        if (idleTime >= waitSeconds) {
+            if (attractRounds < ATTRACT_MAX_ROUNDS) {
+                startAttractMode();
+            }
+            else if (attractMode) {
+                stopAttractMode();
+            }
+        }
+    }
+
     // 根据游戏状态执行不同的更新逻辑
     switch (currentState) {
     case STATE_PLAYING:
         updateGameplay(deltaTime);  // 更新游戏玩法逻辑
+        // 记录这一帧供倒带使用（死亡的那一帧和自动演示不记录）
+        if (currentState == STATE_PLAYING && !attractMode) {
+            RewindFrame frame;
+            captureRewindFrame(frame);
+            rewind->record(frame);
+        }
         break;
     default:
         // 其他状态不需要更新游戏玩法
         break;
     }
+
+    // 观战：每帧把画面发给观战服务器
+    if (broadcaster) {
+        publishSpectatorFrame();
+    }
 }
 
 // 更新游戏玩法逻辑
 void Game::updateGameplay(float deltaTime) {
+    PROFILE_SCOPE("updateGameplay");
+    // 自动驾驶：用当前局面规划，决定本帧是否跳跃（与玩家输入一样在更新之前生效）
+    if (autopilotEnabled) {
+        SimState state;
+        captureSimState(state);
+        if (autopilot->decide(state)) {
+            jumpBird();
+        }
+    }
+
     gameTime += deltaTime;  // 累计游戏时间
 
     bird->update(deltaTime);  // 更新小鸟状态
@@ -618,6 +1149,9 @@ void Game::updateGameplay(float deltaTime) {
         return;      // 提前返回，不再执行后面的代码
     }
 
+    // 地面与管道一起向左滚动
+    groundOffset = fmodf(groundOffset + gameSpeed * GROUND_PARALLAX, (float)GROUND_TILE_PERIOD);
+
     // 更新管道管理器（移动管道，检查碰撞等）
     pipeManager->update(gameSpeed, bird, score, level,
         gameSpeed, shakeTime, shakeIntensity, *this);
@@ -635,6 +1169,7 @@ void Game::updateGameplay(float deltaTime) {
         // 创建硬币收集粒子效果
         createParticles(bird->getX(), bird->getY(), 15, RGB(255, 215, 0), 1);
         shakeScreen(5.0f);  // 屏幕震动效果
+        spectatorEvents |= SPECTATE_EVENT_COIN;
     }
 
     // 检查小鸟是否通过管道
@@ -643,7 +1178,7 @@ void Game::updateGameplay(float deltaTime) {
         // 计算得分：基础分1分乘以连击倍数
         score += 1 * bird->getScoreMultiplier();
         // --- 新增：得分音效 ---
-        AudioManager::getInstance().playSound("score");
+        AudioManager::getInstance().playSound(SOUND_SCORE);
         bird->addCombo();
 
 		// 播放特殊音效逻辑
@@ -651,28 +1186,9 @@ void Game::updateGameplay(float deltaTime) {
             // 1. 计算当前应该是哪个数字（1, 2, 3, 4, 5）
             int specialIndex = ((pipesPassed / 5 - 1) % 5) + 1;
 
-            // 2. 构造文件路径（assets/1.wav, assets/2.wav ...）
-            std::string soundPath = "assets/" + std::to_string(specialIndex) + ".wav";
-
-            // 3. 构造一个唯一的别名（例如：Channel_1, Channel_2 ...）
-            // 使用独立别名是“不被打断”的关键
-            std::string alias = "Channel_" + std::to_string(specialIndex);
-
-            // 4. 使用 MCI 命令播放
-            // 先关闭该别名（防止上次播放没结束导致无法重新打开）
-            mciSendStringA(("close " + alias).c_str(), NULL, 0, NULL);
-            // 打开文件并分配别名
-            std::string openCmd = "open \"" + soundPath + "\" type mpegvideo alias " + alias;
-            mciSendStringA(openCmd.c_str(), NULL, 0, NULL);
-
-            // 这里设置音量为 800 (范围 0-1000)，你可以根据需要修改这个数字
-            int volumeValue = 300;
-            std::string volCmd = "setaudio " + alias + " volume to " + std::to_string(volumeValue);
-            mciSendStringA(volCmd.c_str(), NULL, 0, NULL);
-
-            // 播放该别名（从头开始播放）
-            std::string playCmd = "play " + alias + " from 0";
-            mciSendStringA(playCmd.c_str(), NULL, 0, NULL);
+            // 2. 播放对应的预加载音效（SOUND_LEVEL_1 ~ SOUND_LEVEL_5）
+            // 与得分音效各用一个声部同时播放；只有全部声部都在发声时，最早开始的声音才会被抢占
+            AudioManager::getInstance().playSound((SoundId)(SOUND_LEVEL_1 + specialIndex - 1), 30.0f);
 
             // 每通过5个管道，提升等级和游戏速度
             level++;              // 等级提升
@@ -681,15 +1197,25 @@ void Game::updateGameplay(float deltaTime) {
         }
         else {
             // 不是5的倍数，播放普通得分音效
-            AudioManager::getInstance().playSound("score",50.0f);
+            AudioManager::getInstance().playSound(SOUND_SCORE, 50.0f);
         }
 
-        // 更新最高分
-        if (score > highScore) {
+        // 更新最高分（自动演示、练习局和开过自动驾驶的成绩不算）
+        if (score > highScore && !attractMode && !practiceRun && !autopilotRun) {
             highScore = score;
         }
     }
 
+    gameTicks++;
+
+    // 比赛模式：按赛道记录的帧号生成管道，不再使用计时器
+    if (pipeManager->hasCourse()) {
+        while (pipeManager->getNextCourseSpawnTick() <= (uint32_t)gameTicks) {
+            pipeManager->addPipe((float)SCREEN_WIDTH, nextPipeID++);
+        }
+        return;
+    }
+
     // 更新管道生成计时器
     pipeTimer += deltaTime;
     // 计算管道生成间隔：随着等级提高，间隔变短（最低1.5秒）
@@ -706,8 +1232,8 @@ void Game::updateGameplay(float deltaTime) {
 // 创建粒子效果方法
 void Game::createParticles(float x, float y, int count,
     COLORREF color, int type) {
-    // 创建指定数量的粒子
-    for (int i = 0; i < count; i++) {
+    // 创建指定数量的粒子（达到预分配容量后不再添加，避免游戏中扩容）
+    for (int i = 0; i < count && particles.size() < particles.capacity(); i++) {
         // 在指定位置创建粒子并添加到粒子数组
         particles.push_back(Particle(x, y, color, type));
     }
@@ -715,21 +1241,15 @@ void Game::createParticles(float x, float y, int count,
 
 // 更新所有粒子效果
 void Game::updateParticles(float deltaTime) {
+    PROFILE_SCOPE("updateParticles");
     // 遍历所有粒子并更新它们
     for (auto& particle : particles) {
         particle.update(deltaTime);
     }
 
-    // 删除生命周期结束的粒子
-    auto it = particles.begin();  // 获取粒子数组的起始迭代器
-    while (it != particles.end()) {
-        if (it->shouldRemove()) {           // 使用公有方法
-            it = particles.erase(it);  // 删除粒子，并获取下一个迭代器
-        }
-        else {
-            ++it;  // 移动到下一个粒子
-        }
-    }
+    // 删除生命周期结束的粒子（一次遍历压缩，保持绘制顺序，不释放容量）
+    particles.erase(std::remove_if(particles.begin(), particles.end(),
+        [](const Particle& p) { return p.shouldRemove(); }), particles.end());
 }
 
 // 屏幕震动效果方法
@@ -753,9 +1273,32 @@ void Game::startNewGame() {
     gameTime = 0;       // 游戏时间重置
     pipesPassed = 0;    // 通过的管道数量重置
     nextPipeID = 0;     // 管道ID重置
+    gameTicks = 0;      // 帧数重置
+
+    // 加载了比赛赛道时，每局都从赛道开头生成管道
+    pipeManager->setCourse(course.isOpen() ? &course : nullptr);
+
+    // 随机管道的种子每局不同，和跳跃一起记进回放
+    uint32_t seed = ((uint32_t)rand() << 16) ^ (uint32_t)rand() ^ ((uint32_t)time(0) * 2654435761u);
+    pipeManager->setSeed(seed);
+    replay->start(seed, difficulty);
 
     applyDifficulty();  // 应用当前难度设置
 
+    // 丢弃上一局的计划；自动驾驶只在自动演示中保持开启，玩家的新一局总是从手动开始
+    autopilot->reset();
+    autopilotEnabled = attractMode;
+    autopilotRun = false;
+
+    particleSeed++;     // 观众端的粒子随机序列每局重新开始
+
+    // 倒带缓冲从这一局的第0帧开始记录
+    practiceRun = false;
+    rewind->clear();
+    RewindFrame frame;
+    captureRewindFrame(frame);
+    rewind->record(frame);
+
     currentState = STATE_PLAYING;  // 切换到游戏状态
 }
 
@@ -764,20 +1307,30 @@ void Game::gameOver() {
     bird->kill();  // 设置小鸟为死亡状态
 
     // --- 新增：撞击音效 ---
-    AudioManager::getInstance().playSound("hit");
+    AudioManager::getInstance().playSound(SOUND_HIT);
 
     // 创建游戏结束粒子效果（红色轨迹效果）
     createParticles(bird->getX(), bird->getY(), 50, RGB(255, 50, 50), 2);
+    spectatorEvents |= SPECTATE_EVENT_HIT;
 
     shakeScreen(10.0f);  // 强烈的屏幕震动效果
 
-    addToLeaderboard();  // 将分数添加到排行榜
+    // 将分数添加到排行榜并追加回放（自动演示、用过倒带的练习局和开过自动驾驶的局不记录）
+    if (!attractMode && !practiceRun && !autopilotRun) {
+        addToLeaderboard();
+    }
+    idleTime = 0;
 
     currentState = STATE_GAME_OVER;  // 切换到游戏结束状态
 }
 
 // 游戏渲染方法：绘制游戏画面
 void Game::render() {
+    PROFILE_SCOPE("Game::render");
+    // 先把整帧录制成命令列表，最后按状态合并批次一次执行
+    RenderList& canvas = RenderList::getInstance();
+    canvas.begin();
+
     BeginBatchDraw();  // 开始批量绘制（提高绘制效率）
 
     // 计算屏幕震动偏移
@@ -788,13 +1341,14 @@ void Game::render() {
         shakeY = (rand() % (int)(shakeIntensity * 2)) - (int)shakeIntensity;
     }
 
-    cleardevice();  // 清空屏幕（用背景色填充）
+    canvas.clear();  // 清空屏幕（用背景色填充）
 
     drawSkyBackground();  // 绘制天空背景
 
-    // 绘制所有云朵
-    for (const auto& cloud : clouds) {
-        cloud.draw();
+    // 绘制云朵：由远到近每层一次贴图
+    {
+        PROFILE_SCOPE("drawClouds");
+        cloudLayers->draw();
     }
 
     drawGround();  // 绘制地面
@@ -802,16 +1356,24 @@ void Game::render() {
     // 只在游戏相关状态绘制游戏元素
     if (currentState == STATE_PLAYING ||
         currentState == STATE_PAUSED ||
-        currentState == STATE_GAME_OVER) {
+        currentState == STATE_GAME_OVER ||
+        currentState == STATE_REWIND) {
 
-        pipeManager->draw();  // 绘制所有管道
+        {
+            PROFILE_SCOPE("PipeManager::draw");
+            pipeManager->draw();  // 绘制所有管道
+        }
 
         // 绘制所有粒子效果
-        for (const auto& particle : particles) {
-            particle.draw();
+        {
+            PROFILE_SCOPE("drawParticles");
+            particleRenderer->draw(particles);
         }
 
-        bird->draw();  // 绘制小鸟
+        {
+            PROFILE_SCOPE("Bird::draw");
+            bird->draw();  // 绘制小鸟
+        }
 
         // 如果开启了碰撞框显示，绘制碰撞框
         if (showHitboxes) {
@@ -822,28 +1384,34 @@ void Game::render() {
     }
 
     // 根据当前游戏状态绘制对应的界面
-    switch (currentState) {
-    case STATE_MENU:
-        drawMenu();        // 绘制主菜单
-        break;
-    case STATE_PAUSED:
-        drawPauseMenu();   // 绘制暂停菜单
-        break;
-    case STATE_GAME_OVER:
-        drawGameOver();    // 绘制游戏结束界面
-        break;
-    case STATE_LEADERBOARD:
-        drawLeaderboard(); // 绘制排行榜
-        break;
-    case STATE_SETTINGS:
-        drawSettings();    // 绘制设置界面
-        break;
-    case STATE_HELP:
-        drawHelp();        // 绘制帮助界面
-        break;
-    case STATE_CREDITS:
-        drawCredits();     // 绘制制作人员界面
-        break;
+    {
+        PROFILE_SCOPE("drawScreen");
+        switch (currentState) {
+        case STATE_MENU:
+            drawMenu();        // 绘制主菜单
+            break;
+        case STATE_PAUSED:
+            drawPauseMenu();   // 绘制暂停菜单
+            break;
+        case STATE_GAME_OVER:
+            drawGameOver();    // 绘制游戏结束界面
+            break;
+        case STATE_LEADERBOARD:
+            drawLeaderboard(); // 绘制排行榜
+            break;
+        case STATE_SETTINGS:
+            drawSettings();    // 绘制设置界面
+            break;
+        case STATE_HELP:
+            drawHelp();        // 绘制帮助界面
+            break;
+        case STATE_CREDITS:
+            drawCredits();     // 绘制制作人员界面
+            break;
+        case STATE_REWIND:
+            drawRewindOverlay();  // 绘制倒带时间轴
+            break;
+        }
     }
 
     // 如果开启了FPS显示，绘制FPS
@@ -856,192 +1424,332 @@ void Game::render() {
         drawShakeEffect(shakeX, shakeY);
     }
 
+    // 观战画面：机台编号和连接状态
+    if (spectator) {
+        drawSpectatorOverlay();
+    }
+
+    // 与上一帧的命令完全相同：屏幕上已经是这个画面，不再执行和刷新
+    if (canvas.isSameAsPrevious()) {
+        canvas.countSkippedFrame();
+        return;
+    }
+    {
+        PROFILE_SCOPE("RenderList::execute");
+        canvas.execute();
+    }
+
+    PROFILE_SCOPE("FlushBatchDraw");
     FlushBatchDraw();  // 结束批量绘制，实际显示到屏幕
 }
 
+
+// 天空渐变在第 y 行的颜色（从浅蓝色渐变到深蓝色）
+static COLORREF getSkyColor(int y) {
+    float ratio = (float)y / SCREEN_HEIGHT;  // 渐变比例（0到1之间）
+    int r = (int)(GetRValue(COLOR_SKY_START) * (1 - ratio) + GetRValue(COLOR_SKY_END) * ratio);
+    int g = (int)(GetGValue(COLOR_SKY_START) * (1 - ratio) + GetGValue(COLOR_SKY_END) * ratio);
+    int b = (int)(GetBValue(COLOR_SKY_START) * (1 - ratio) + GetBValue(COLOR_SKY_END) * ratio);
+    return RGB(r, g, b);
+}
+
 // 绘制天空背景：创建渐变天空效果
 void Game::drawSkyBackground() {
+    PROFILE_SCOPE("drawSkyBackground");
+    RenderList& canvas = RenderList::getInstance();
     // 从上到下绘制渐变线，创建天空效果
     for (int y = 0; y < SCREEN_HEIGHT; y++) {
-        // 计算当前位置的渐变比例（0到1之间）
-        float ratio = (float)y / SCREEN_HEIGHT;
-
-        // 计算当前行的颜色（从浅蓝色渐变到深蓝色）
-        int r = (int)(GetRValue(COLOR_SKY_START) * (1 - ratio) +
-            GetRValue(COLOR_SKY_END) * ratio);
-        int g = (int)(GetGValue(COLOR_SKY_START) * (1 - ratio) +
-            GetGValue(COLOR_SKY_END) * ratio);
-        int b = (int)(GetBValue(COLOR_SKY_START) * (1 - ratio) +
-            GetBValue(COLOR_SKY_END) * ratio);
-
-        setlinecolor(RGB(r, g, b));  // 设置线条颜色
-        line(0, y, SCREEN_WIDTH, y); // 绘制一条横线
+        canvas.setLineColor(getSkyColor(y));  // 设置线条颜色
+        canvas.line(0, y, SCREEN_WIDTH, y); // 绘制一条横线
     }
 
     // 绘制太阳
-    setfillcolor(RGB(255, 255, 0));  // 黄色填充
-    setlinecolor(RGB(255, 200, 0));  // 橙黄色边框
-    solidcircle(SCREEN_WIDTH - 80, 80, 40);  // 绘制实心圆作为太阳
+    canvas.setFillColor(RGB(255, 255, 0));  // 黄色填充
+    canvas.setLineColor(RGB(255, 200, 0));  // 橙黄色边框
+    canvas.solidCircle(SCREEN_WIDTH - 80, 80, 40);  // 绘制实心圆作为太阳
 
     // 绘制太阳光晕（多个同心圆）
-    setlinecolor(RGB(255, 255, 0));  // 黄色边框
+    canvas.setLineColor(RGB(255, 255, 0));  // 黄色边框
     for (int i = 1; i <= 3; i++) {
         int radius = 40 + i * 10;  // 计算每个光晕圈的半径
-        circle(SCREEN_WIDTH - 80, 80, radius);  // 绘制圆形
+        canvas.circle(SCREEN_WIDTH - 80, 80, radius);  // 绘制圆形
     }
 }
 
 // 绘制地面：包括地面、草和装饰
 void Game::drawGround() {
-    // 绘制地面主体
-    setfillcolor(COLOR_GROUND);  // 设置地面颜色（土黄色）
-    fillrectangle(0, SCREEN_HEIGHT - GROUND_HEIGHT,
-        SCREEN_WIDTH, SCREEN_HEIGHT);  // 填充矩形
+    PROFILE_SCOPE("drawGround");
+    RenderList& canvas = RenderList::getInstance();
+    // 地面条在第一次绘制时生成（此时图形窗口已经创建）
+    if (groundTile.getwidth() != SCREEN_WIDTH + GROUND_TILE_PERIOD) {
+        buildGroundTile();
+    }
 
-    // 绘制草地（随机高度的草叶）
-    setfillcolor(COLOR_GRASS);  // 设置草的颜色（亮绿色）
-    for (int x = 0; x < SCREEN_WIDTH; x += 20) {
-        int height = 5 + rand() % 15;  // 随机草叶高度（5-19像素）
-        // 绘制草叶（细长的矩形）
-        fillrectangle(x, SCREEN_HEIGHT - GROUND_HEIGHT - height,
-            x + 15, SCREEN_HEIGHT - GROUND_HEIGHT);
+    // 从地面条的滚动位置截取一屏宽，一次贴图画出草地、地面和土块
+    canvas.putImage(0, SCREEN_HEIGHT - GROUND_HEIGHT - GROUND_GRASS_HEIGHT, SCREEN_WIDTH,
+        GROUND_HEIGHT + GROUND_GRASS_HEIGHT, &groundTile, (int)groundOffset, 0);
+}
+
+// 生成地面条：宽度为一屏再加一个周期，图案每 GROUND_TILE_PERIOD 像素重复一次，
+// 所以从 [0, GROUND_TILE_PERIOD) 内任意位置截取一屏宽都是无缝的。
+// 最上面 GROUND_GRASS_HEIGHT 行是草叶之间露出的天空（这一带只有天空渐变，云朵不会低到这里）
+void Game::buildGroundTile() {
+    const int width = SCREEN_WIDTH + GROUND_TILE_PERIOD;
+    const int groundTop = GROUND_GRASS_HEIGHT;     // 地面顶部在地面条中的行
+    const int screenTop = SCREEN_HEIGHT - GROUND_HEIGHT - GROUND_GRASS_HEIGHT;
+    // 一个周期内各草叶的高度（5-19像素，原来每帧随机）
+    const int grassHeights[GROUND_TILE_PERIOD / 20] = { 12, 7, 17, 9, 14, 5, 19, 10, 6, 15 };
+
+    groundTile.Resize(width, GROUND_HEIGHT + GROUND_GRASS_HEIGHT);
+    SetWorkingImage(&groundTile);
+
+    for (int y = 0; y < groundTop; y++) {
+        setlinecolor(getSkyColor(screenTop + y));
+        line(0, y, width, y);
+    }
+
+    // 草叶和土块带白色边框；地面主体左右各多画一像素，边框不出现在地面条里，接缝处看不出来
+    setlinecolor(WHITE);
+    setfillcolor(COLOR_GROUND);  // 地面主体（土黄色）
+    fillrectangle(-1, groundTop, width, groundTop + GROUND_HEIGHT);
+
+    setfillcolor(COLOR_GRASS);   // 草叶（亮绿色）
+    for (int x = 0; x < width; x += 20) {
+        int height = grassHeights[(x % GROUND_TILE_PERIOD) / 20];
+        fillrectangle(x, groundTop - height, x + 15, groundTop);
     }
 
-    // 绘制地面装饰（小土块）
-    setfillcolor(RGB(139, 69, 19));  // 设置土块颜色（棕色）
-    for (int x = 0; x < SCREEN_WIDTH; x += 40) {
-        // 绘制小土块
-        fillrectangle(x, SCREEN_HEIGHT - GROUND_HEIGHT,
-            x + 20, SCREEN_HEIGHT - GROUND_HEIGHT + 10);
+    setfillcolor(RGB(139, 69, 19));  // 小土块（棕色）
+    for (int x = 0; x < width; x += 40) {
+        fillrectangle(x, groundTop, x + 20, groundTop + 10);
     }
+
+    SetWorkingImage(NULL);
 }
 
 // 绘制游戏UI：显示分数、等级、硬币等信息
 void Game::drawGameUI() {
+    PROFILE_SCOPE("drawGameUI");
+    RenderList& canvas = RenderList::getInstance();
     // 设置分数显示的文字样式
-    settextstyle(36, 0, _T("Arial"));  // 36号Arial字体
-    settextcolor(COLOR_TEXT_WHITE);    // 白色文字
-    setbkmode(TRANSPARENT);            // 透明背景
+    canvas.setTextStyle(36, 0, _T("Arial"));  // 36号Arial字体
+    canvas.setTextColor(COLOR_TEXT_WHITE);    // 白色文字
+    canvas.setBkMode(TRANSPARENT);            // 透明背景
 
-    wchar_t wbuffer[100];  // 格式化字符串缓冲区
+    FrameArena& arena = FrameArena::getInstance();  // 文字格式化到帧内存，帧末统一释放
+    const wchar_t* text;
 
     // 格式化并显示当前分数
-    swprintf_s(wbuffer, 100, L"%d", score);
-    int scoreWidth = textwidth(wbuffer);  // 获取文字宽度
+    text = arena.format(L"%d", score);
+    int scoreWidth = canvas.textWidth(text);  // 获取文字宽度
     // 在屏幕顶部中央显示分数
-    outtextxy(SCREEN_WIDTH / 2 - scoreWidth / 2, 30, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - scoreWidth / 2, 30, text);
 
     // 如果有连击，显示连击数
     if (bird->getComboCount() > 0) {
-        settextstyle(24, 0, _T("Arial"));  // 稍小号字体
-        settextcolor(RGB(255, 215, 0));    // 金色文字
+        canvas.setTextStyle(24, 0, _T("Arial"));  // 稍小号字体
+        canvas.setTextColor(RGB(255, 215, 0));    // 金色文字
         // 格式化连击文本
-        swprintf_s(wbuffer, 100, L"COMBO x%d", bird->getComboCount());
+        text = arena.format(L"COMBO x%d", bird->getComboCount());
         // 在分数下方显示连击
-        outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 75, wbuffer);
+        canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(text) / 2, 75, text);
     }
 
     // 设置游戏信息显示的文字样式
-    settextstyle(18, 0, _T("Arial"));   // 小号字体
-    settextcolor(RGB(200, 200, 255));   // 浅蓝色文字
+    canvas.setTextStyle(18, 0, _T("Arial"));   // 小号字体
+    canvas.setTextColor(RGB(200, 200, 255));   // 浅蓝色文字
 
     // 显示等级
-    swprintf_s(wbuffer, 100, L"Level: %d", level);
-    outtextxy(20, 20, wbuffer);  // 左上角显示
+    text = arena.format(L"Level: %d", level);
+    canvas.outText(20, 20, text);  // 左上角显示
 
     // 显示硬币数量
-    swprintf_s(wbuffer, 100, L"Coins: %d", coins);
-    outtextxy(20, 50, wbuffer);  // 等级下方显示
+    text = arena.format(L"Coins: %d", coins);
+    canvas.outText(20, 50, text);  // 等级下方显示
 
     // 显示游戏速度
-    swprintf_s(wbuffer, 100, L"Speed: %.1f", gameSpeed);
-    outtextxy(20, 80, wbuffer);  // 硬币下方显示
+    text = arena.format(L"Speed: %.1f", gameSpeed);
+    canvas.outText(20, 80, text);  // 硬币下方显示
 
     // 显示游戏时间（分:秒格式）
     int minutes = (int)gameTime / 60;  // 计算分钟
     int seconds = (int)gameTime % 60;  // 计算秒数
-    swprintf_s(wbuffer, 100, L"Time: %02d:%02d", minutes, seconds);
-    outtextxy(20, 110, wbuffer);  // 速度下方显示
+    text = arena.format(L"Time: %02d:%02d", minutes, seconds);
+    canvas.outText(20, 110, text);  // 速度下方显示
 
     // 显示最高分
-    swprintf_s(wbuffer, 100, L"Best: %d", highScore);
-    outtextxy(20, 140, wbuffer);  // 时间下方显示
+    text = arena.format(L"Best: %d", highScore);
+    canvas.outText(20, 140, text);  // 时间下方显示
 
     // 显示玩家名称（屏幕右上角）
-    settextcolor(RGB(255, 200, 255));  // 浅粉色文字
-    wchar_t wname[100];
-    size_t converted = 0;
+    canvas.setTextColor(RGB(255, 200, 255));  // 浅粉色文字
     // 将玩家名称从多字节转换为宽字符
-    mbstowcs_s(&converted, wname, playerName.c_str(), 100);
-    swprintf_s(wbuffer, 100, L"Player: %s", wname);
+    text = arena.format(L"Player: %s", arena.widen(playerName.c_str()));
     // 计算文字宽度，靠右显示
-    outtextxy(SCREEN_WIDTH - textwidth(wbuffer) - 20, 20, wbuffer);
+    canvas.outText(SCREEN_WIDTH - canvas.textWidth(text) - 20, 20, text);
+
+    // 自动驾驶 / 自动演示标记
+    if (autopilotEnabled) {
+        canvas.setTextStyle(18, 0, _T("Arial"));
+        canvas.setTextColor(RGB(255, 215, 0));
+        text = attractMode ? L"DEMO - press any key" : L"AUTOPILOT (F7)";
+        canvas.outText(SCREEN_WIDTH - canvas.textWidth(text) - 20, 50, text);
+    }
 
     // 如果正在游戏中，显示操作提示
     if (currentState == STATE_PLAYING) {
-        settextcolor(RGB(150, 150, 150));  // 灰色文字
-        settextstyle(14, 0, _T("Arial"));  // 更小号字体
+        canvas.setTextColor(RGB(150, 150, 150));  // 灰色文字
+        canvas.setTextStyle(14, 0, _T("Arial"));  // 更小号字体
         // 在屏幕左下角显示操作提示
-        outtextxy(20, SCREEN_HEIGHT - 40,
-            L"SPACE: Jump  ESC: Pause  R: Restart");
+        canvas.outText(20, SCREEN_HEIGHT - 40,
+            L"SPACE: Jump  ESC: Pause  R: Restart  BACKSPACE: Rewind");
     }
 }
 
 // 绘制碰撞框方法：用于调试显示碰撞检测区域
 void Game::drawHitboxes() {
-    setlinecolor(RGB(255, 0, 0));  // 设置碰撞框颜色为红色
-    setlinestyle(PS_DASH, 1);       // 设置虚线样式，宽度为1像素
+    RenderList& canvas = RenderList::getInstance();
+    canvas.setLineColor(RGB(255, 0, 0));  // 设置碰撞框颜色为红色
+    canvas.setLineStyle(PS_DASH, 1);       // 设置虚线样式，宽度为1像素
 
     // 获取小鸟的碰撞矩形并绘制
     RECT birdRect = bird->getCollisionRect();
-    rectangle(birdRect.left, birdRect.top,
+    canvas.rectangle(birdRect.left, birdRect.top,
         birdRect.right, birdRect.bottom);  // 绘制矩形框
 
     // 绘制所有管道的碰撞框
     pipeManager->drawHitboxes();
 
-    setlinestyle(PS_SOLID, 1);  // 恢复实线样式，避免影响其他绘制
+    canvas.setLineStyle(PS_SOLID, 1);  // 恢复实线样式，避免影响其他绘制
 }
 
-// 绘制FPS（每秒帧数）显示
+// 绘制帧时间统计面板：FPS、帧/更新/渲染耗时的分位数，以及最近若干帧的耗时曲线
 void Game::drawFPS() {
-    // 静态变量用于计算FPS
-    static DWORD lastTime = GetTickCount();  // 上次计算时间
-    static int frameCount = 0;               // 帧数计数器
-    static float fps = 0;                    // 当前FPS值
-
-    frameCount++;  // 每调用一次增加一帧
-    DWORD currentTime = GetTickCount();  // 获取当前时间（毫秒）
-
-    // 如果超过1秒（1000毫秒），重新计算FPS
-    if (currentTime - lastTime >= 1000) {
-        // 计算FPS：帧数 ÷ 经过的时间（秒）
-        fps = frameCount * 1000.0f / (currentTime - lastTime);
-        frameCount = 0;          // 重置帧数计数器
-        lastTime = currentTime;  // 更新上次计算时间
+    PROFILE_SCOPE("drawFPS");
+    RenderList& canvas = RenderList::getInstance();
+
+    const int panelW = 290, panelH = 202;
+    const int left = SCREEN_WIDTH - panelW - 8;
+    const int top = SCREEN_HEIGHT - panelH - 8;
+
+    // 深色底板
+    canvas.setFillColor(RGB(20, 20, 30));
+    canvas.solidRectangle(left, top, left + panelW, top + panelH);
+
+    canvas.setTextStyle(12, 0, _T("Arial"));  // 12号小字体
+    canvas.setBkMode(TRANSPARENT);            // 透明背景
+
+    wchar_t wbuffer[64];  // 格式化字符串缓冲区
+    canvas.setTextColor(RGB(220, 220, 220));
+    swprintf_s(wbuffer, 64, L"FPS: %.1f   (last %.0fs, ms)", frameStats->getAverageFps(),
+        frameStats->getWindowSeconds());
+    canvas.outText(left + 6, top + 4, wbuffer);
+
+    // 表头 + 三行分位数：帧、更新、渲染
+    const int columnX[] = { 6, 62, 118, 174, 230 };
+    const wchar_t* headers[] = { L"", L"p50", L"p95", L"p99", L"max" };
+    canvas.setTextColor(RGB(150, 150, 150));
+    for (int c = 1; c < 5; c++) {
+        canvas.outText(left + columnX[c], top + 18, headers[c]);
+    }
+
+    const wchar_t* rowNames[] = { L"frame", L"update", L"render" };
+    const FrameTimeSummary* rows[] = {
+        &frameStats->getFrameSummary(),
+        &frameStats->getUpdateSummary(),
+        &frameStats->getRenderSummary()
+    };
+    for (int r = 0; r < 3; r++) {
+        int y = top + 32 + r * 14;
+        canvas.setTextColor(RGB(150, 150, 150));
+        canvas.outText(left + columnX[0], y, rowNames[r]);
+
+        const float values[] = { rows[r]->p50, rows[r]->p95, rows[r]->p99, rows[r]->max };
+        canvas.setTextColor(RGB(220, 220, 220));
+        for (int c = 0; c < 4; c++) {
+            swprintf_s(wbuffer, 64, L"%.2f", values[c]);
+            canvas.outText(left + columnX[c + 1], y, wbuffer);
+        }
     }
 
-    wchar_t wbuffer[20];  // 格式化字符串缓冲区
-    swprintf_s(wbuffer, 20, L"FPS: %.1f", fps);  // 格式化FPS字符串
-
-    // 设置FPS显示的文字样式
-    settextstyle(12, 0, _T("Arial"));        // 12号小字体
-    settextcolor(RGB(150, 150, 150));        // 灰色文字
-    setbkmode(TRANSPARENT);                  // 透明背景
-    // 在屏幕右下角显示FPS
-    outtextxy(SCREEN_WIDTH - 70, SCREEN_HEIGHT - 20, wbuffer);
+    // 堆分配次数：稳定运行时两项都应该是0
+    canvas.setTextColor(tickAllocations || frameAllocations ? RGB(230, 60, 60) : RGB(150, 150, 150));
+    swprintf_s(wbuffer, 64, L"allocs  tick %llu  frame %llu",
+        (unsigned long long)tickAllocations, (unsigned long long)frameAllocations);
+    canvas.outText(left + columnX[0], top + 74, wbuffer);
+
+    // 帧内存：本帧用量 / 历史最高 / 已分配容量
+    const FrameArena& arena = FrameArena::getInstance();
+    canvas.setTextColor(RGB(150, 150, 150));
+    swprintf_s(wbuffer, 64, L"arena  %.1f / %.1f KB (cap %.0f KB)", arena.getUsedBytes() / 1024.0,
+        arena.getHighWaterBytes() / 1024.0, arena.getCapacityBytes() / 1024.0);
+    canvas.outText(left + columnX[0], top + 88, wbuffer);
+
+    // 命令列表（上一帧）：命令数、批次数、排序后/按录制顺序的状态切换次数、跳过的相同帧
+    swprintf_s(wbuffer, 64, L"draw  %d cmd  %d batch  %d/%d state  skip %llu",
+        (int)canvas.getCommandCount(), canvas.getBatchCount(), canvas.getStateChanges(),
+        canvas.getUnsortedStateChanges(), (unsigned long long)canvas.getSkippedFrames());
+    canvas.outText(left + columnX[0], top + 102, wbuffer);
+
+    // 功耗：进程 CPU 占用（100% = 一个核心）和主循环每秒唤醒次数；静态界面应只有约10次
+    swprintf_s(wbuffer, 64, L"power  cpu %.1f%%  wake %.1f/s%s", idleWaiter->getCpuPercent(),
+        idleWaiter->getWakeupsPerSecond(), isStaticScreen() ? L"  (idle)" : L"");
+    canvas.outText(left + columnX[0], top + 116, wbuffer);
+
+    // 自动驾驶：搜索吞吐量、每帧平均耗时、当前计划能存活的帧数
+    if (autopilotEnabled) {
+        swprintf_s(wbuffer, 64, L"autopilot  %.1f M nodes/s  %.0f us  plan %d",
+            autopilot->getNodesPerSecond() / 1e6, autopilot->getAverageSearchMicros(), autopilot->getPlanTicks());
+        canvas.outText(left + columnX[0], top + 130, wbuffer);
+    }
+
+    // 音乐流：环形缓冲区的填充程度和累计欠载（次数 / 补静音的帧数），欠载不为0时标红
+    const AudioManager& audio = AudioManager::getInstance();
+    if (audio.isMusicPlaying()) {
+        const MusicStream& music = audio.getMusicStream();
+        canvas.setTextColor(music.getUnderrunCount() ? RGB(230, 60, 60) : RGB(150, 150, 150));
+        swprintf_s(wbuffer, 64, L"music  buffer %.0f%%  underrun %llu (%llu frames)",
+            music.getBufferCapacity() ? music.getBufferedFrames() * 100.0 / music.getBufferCapacity() : 0.0,
+            (unsigned long long)music.getUnderrunCount(), (unsigned long long)music.getUnderrunFrames());
+        canvas.outText(left + columnX[0], top + 144, wbuffer);
+    }
+
+    // 帧时间曲线：每帧一根竖条，纵轴 0~33.3 毫秒（两帧的时间），超出的截断
+    const int graphLeft = left + 6, graphBottom = top + panelH - 6;
+    const int graphH = 36, barW = 2;
+    const float targetMs = (float)(1000.0 / FPS);
+    const float scaleMs = targetMs * 2;
+
+    int samples = std::min(frameStats->getSampleCount(), FRAME_GRAPH_SAMPLES);
+    for (int i = 0; i < samples; i++) {
+        float ms = frameStats->getRecent(i).frameMs;
+        int h = (int)(std::min(ms, scaleMs) / scaleMs * graphH);
+        // 绿：接近目标帧时间；黄：明显变慢；红：掉了一整帧以上
+        if (ms <= targetMs * 1.2f) canvas.setFillColor(RGB(80, 200, 80));
+        else if (ms <= targetMs * 2.0f) canvas.setFillColor(RGB(230, 200, 60));
+        else canvas.setFillColor(RGB(230, 60, 60));
+        // 最新的一帧在最右边
+        int x = graphLeft + (FRAME_GRAPH_SAMPLES - 1 - i) * barW;
+        canvas.solidRectangle(x, graphBottom - h, x + barW - 1, graphBottom);
+    }
+
+    // 目标帧时间参考线
+    canvas.setLineColor(RGB(120, 120, 160));
+    int targetY = graphBottom - graphH / 2;
+    canvas.line(graphLeft, targetY, graphLeft + FRAME_GRAPH_SAMPLES * barW, targetY);
 }
 
 // 绘制屏幕震动效果：多层白色边框
 void Game::drawShakeEffect(int shakeX, int shakeY) {
-    setlinecolor(RGB(255, 255, 255));  // 白色边框
+    RenderList& canvas = RenderList::getInstance();
+    canvas.setLineColor(RGB(255, 255, 255));  // 白色边框
 
     // 绘制5层逐渐增大的白色边框
     for (int i = 0; i < 5; i++) {
         int offset = i * 2;  // 每层边框偏移2像素
 
         // 绘制矩形边框
-        rectangle(offset + shakeX, offset + shakeY,              // 左上角
+        canvas.rectangle(offset + shakeX, offset + shakeY,              // 左上角
             SCREEN_WIDTH - offset + shakeX,                // 右下角X
             SCREEN_HEIGHT - offset + shakeY);              // 右下角Y
     }
@@ -1049,29 +1757,30 @@ void Game::drawShakeEffect(int shakeX, int shakeY) {
 
 // 绘制主菜单界面
 void Game::drawMenu() {
+    RenderList& canvas = RenderList::getInstance();
     // 1. 绘制你要求的背景图片
     // 注意：menuBackground 必须在 game.h 声明，并在 init() 中 loadimage
-    putimage(0, 0, &menuBackground);
+    canvas.putImage(0, 0, &menuBackground);
 
     // 2. 增强视觉效果：绘制一个半透明的黑色遮罩，让背景图不干扰文字
     // 如果你的 EasyX 版本不支持高级透明，这个循环会产生一种复古的扫描线效果
     for (int i = 0; i < SCREEN_HEIGHT; i += 4) {
-        setlinecolor(RGB(0, 0, 0));
+        canvas.setLineColor(RGB(0, 0, 0));
         // line(0, i, SCREEN_WIDTH, i); // 如果觉得背景太亮，可以取消这行的注释
     }
 
     // 3. 绘制游戏大标题（保留原来的文字，但配色更高级）
-    setbkmode(TRANSPARENT);
+    canvas.setBkMode(TRANSPARENT);
     const wchar_t* titleText = L"FLAPPY BIRD";
 
     // 绘制标题阴影（深色，偏移效果）
-    settextstyle(82, 0, _T("Arial Black"));
-    settextcolor(RGB(50, 20, 0));
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(titleText) / 2 + 4, 84, titleText);
+    canvas.setTextStyle(82, 0, _T("Arial Black"));
+    canvas.setTextColor(RGB(50, 20, 0));
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(titleText) / 2 + 4, 84, titleText);
 
     // 绘制标题主体（亮金色）
-    settextcolor(RGB(255, 215, 0));
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(titleText) / 2, 80, titleText);
+    canvas.setTextColor(RGB(255, 215, 0));
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(titleText) / 2, 80, titleText);
 
     // 4. 定义菜单项：完全保留你原来的 7 个选项顺序
     const wchar_t* menuItems[] = {
@@ -1091,62 +1800,63 @@ void Game::drawMenu() {
 
         if (i == selectedMenu) {
             // --- 选中项的状态 ---
-            settextstyle(32, 0, _T("Arial Black")); // 字体稍微变大变粗
-            settextcolor(RGB(255, 255, 255));       // 选中时文字变白
+            canvas.setTextStyle(32, 0, _T("Arial Black")); // 字体稍微变大变粗
+            canvas.setTextColor(RGB(255, 255, 255));       // 选中时文字变白
 
-            int itemWidth = textwidth(menuItems[i]);
-            outtextxy(SCREEN_WIDTH / 2 - itemWidth / 2, y, menuItems[i]);
+            int itemWidth = canvas.textWidth(menuItems[i]);
+            canvas.outText(SCREEN_WIDTH / 2 - itemWidth / 2, y, menuItems[i]);
 
             // 在选中项两侧画两个发光的小圆点
-            setfillcolor(RGB(255, 215, 0));
-            solidcircle(SCREEN_WIDTH / 2 - itemWidth / 2 - 30, y + 16, 6);
-            solidcircle(SCREEN_WIDTH / 2 + itemWidth / 2 + 30, y + 16, 6);
+            canvas.setFillColor(RGB(255, 215, 0));
+            canvas.solidCircle(SCREEN_WIDTH / 2 - itemWidth / 2 - 30, y + 16, 6);
+            canvas.solidCircle(SCREEN_WIDTH / 2 + itemWidth / 2 + 30, y + 16, 6);
         }
         else {
             // --- 未选中项的状态 ---
-            settextstyle(28, 0, _T("Arial"));      // 普通字体
-            settextcolor(RGB(100, 100, 100));      // 灰色文字，表示未选中
-            outtextxy(SCREEN_WIDTH / 2 - textwidth(menuItems[i]) / 2, y, menuItems[i]);
+            canvas.setTextStyle(28, 0, _T("Arial"));      // 普通字体
+            canvas.setTextColor(RGB(100, 100, 100));      // 灰色文字，表示未选中
+            canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(menuItems[i]) / 2, y, menuItems[i]);
         }
     }
 
     // 6. 绘制底部信息栏
-    settextstyle(16, 0, _T("Consolas"));
-    settextcolor(RGB(0, 0, 0));
+    canvas.setTextStyle(16, 0, _T("Consolas"));
+    canvas.setTextColor(RGB(0, 0, 0));
 
     // 左下角：版本号
-    outtextxy(10, SCREEN_HEIGHT - 30, L"Version 2.0 | Ultimate Edition");
+    canvas.outText(10, SCREEN_HEIGHT - 30, L"Version 2.0 | Ultimate Edition");
 
     // 正下方：操作提示
     const wchar_t* hint = L"Use ARROW KEYS to navigate, ENTER to select";
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(hint) / 2, SCREEN_HEIGHT - 60, hint);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(hint) / 2, SCREEN_HEIGHT - 60, hint);
 }
 // 绘制暂停菜单
 void Game::drawPauseMenu() {
+    RenderList& canvas = RenderList::getInstance();
     // 1. 绘制你自己的背景图片
-    putimage(0, 0, &pauseBackground);
+    canvas.putImage(0, 0, &pauseBackground);
 
     // 2. 绘制 "PAUSED" 标题（保留原有位置）
-    setbkmode(TRANSPARENT);
-    settextstyle(64, 0, _T("Arial Black"));
-    settextcolor(COLOR_TEXT_YELLOW);
+    canvas.setBkMode(TRANSPARENT);
+    canvas.setTextStyle(64, 0, _T("Arial Black"));
+    canvas.setTextColor(COLOR_TEXT_YELLOW);
     const wchar_t* pausedTitle = L"PAUSED";
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(pausedTitle) / 2, 150, pausedTitle);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(pausedTitle) / 2, 150, pausedTitle);
 
     // 3. 绘制游戏信息（保留原有分数和等级显示）
-    settextstyle(24, 0, _T("Arial"));
-    settextcolor(COLOR_TEXT_WHITE);
+    canvas.setTextStyle(24, 0, _T("Arial"));
+    canvas.setTextColor(COLOR_TEXT_WHITE);
 
     wchar_t wbuffer[100];
     swprintf_s(wbuffer, 100, L"Score: %d", score);
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 240, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(wbuffer) / 2, 240, wbuffer);
 
     swprintf_s(wbuffer, 100, L"Level: %d", level);
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 280, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(wbuffer) / 2, 280, wbuffer);
 
     // 4. 绘制操作提示（保留原有的操作项说明）
-    settextstyle(20, 0, _T("Arial"));
-    settextcolor(RGB(100, 100, 100)); // 浅蓝色
+    canvas.setTextStyle(20, 0, _T("Arial"));
+    canvas.setTextColor(RGB(100, 100, 100)); // 浅蓝色
 
     // 保持与 handlePauseInput 逻辑一致的操作提示
     const wchar_t* tips[] = {
@@ -1156,56 +1866,57 @@ void Game::drawPauseMenu() {
     };
 
     for (int i = 0; i < 3; i++) {
-        outtextxy(SCREEN_WIDTH / 2 - textwidth(tips[i]) / 2, 350 + i * 30, tips[i]);
+        canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(tips[i]) / 2, 350 + i * 30, tips[i]);
     }
 }
 
 // 绘制游戏结束界面
 void Game::drawGameOver() {
+    RenderList& canvas = RenderList::getInstance();
     // 黑色背景
-    setfillcolor(BLACK);
-    fillrectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    canvas.setFillColor(BLACK);
+    canvas.fillRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     // 绘制"GAME OVER"标题
-    settextstyle(64, 0, _T("Arial"));      // 64号大字体
-    settextcolor(COLOR_TEXT_RED);          // 红色文字
-    outtextxy(SCREEN_WIDTH / 2 - 180, 100, L"GAME OVER");
+    canvas.setTextStyle(64, 0, _T("Arial"));      // 64号大字体
+    canvas.setTextColor(COLOR_TEXT_RED);          // 红色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 180, 100, L"GAME OVER");
 
     // 绘制游戏结果信息
-    settextstyle(36, 0, _T("Arial"));      // 36号字体
-    settextcolor(COLOR_TEXT_WHITE);        // 白色文字
+    canvas.setTextStyle(36, 0, _T("Arial"));      // 36号字体
+    canvas.setTextColor(COLOR_TEXT_WHITE);        // 白色文字
 
     wchar_t wbuffer[100];
 
     // 显示最终分数
     swprintf_s(wbuffer, 100, L"Final Score: %d", score);
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 200, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(wbuffer) / 2, 200, wbuffer);
 
     // 显示游戏统计数据
-    settextstyle(24, 0, _T("Arial"));      // 24号字体
+    canvas.setTextStyle(24, 0, _T("Arial"));      // 24号字体
 
     // 达到的最高等级
     swprintf_s(wbuffer, 100, L"Level Reached: %d", level);
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 250, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(wbuffer) / 2, 250, wbuffer);
 
     // 收集的硬币数量
     swprintf_s(wbuffer, 100, L"Coins Collected: %d", coins);
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 280, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(wbuffer) / 2, 280, wbuffer);
 
     // 游戏时间（分钟:秒格式）
     int minutes = (int)gameTime / 60;      // 分钟
     int seconds = (int)gameTime % 60;      // 秒
     swprintf_s(wbuffer, 100, L"Play Time: %02d:%02d", minutes, seconds);
-    outtextxy(SCREEN_WIDTH / 2 - textwidth(wbuffer) / 2, 310, wbuffer);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(wbuffer) / 2, 310, wbuffer);
 
     // 如果获得了新高分，显示特殊效果
     if (score == highScore && score > 0) {
-        settextstyle(32, 0, _T("Arial"));          // 32号字体
-        settextcolor(RGB(255, 215, 0));            // 金色文字
-        outtextxy(SCREEN_WIDTH / 2 - 100, 350, L"NEW HIGH SCORE!");
+        canvas.setTextStyle(32, 0, _T("Arial"));          // 32号字体
+        canvas.setTextColor(RGB(255, 215, 0));            // 金色文字
+        canvas.outText(SCREEN_WIDTH / 2 - 100, 350, L"NEW HIGH SCORE!");
 
         // 绘制动态星星效果
-        setfillcolor(RGB(255, 215, 0));            // 金色填充
+        canvas.setFillColor(RGB(255, 215, 0));            // 金色填充
         for (int i = 0; i < 5; i++) {
             // 计算星星的动画角度（基于时间和索引）
             float angle = animationTime * 2 + i * 1.256f;
@@ -1216,50 +1927,97 @@ void Game::drawGameOver() {
             // 计算星星大小（使用正弦函数产生大小变化）
             int starSize = 10 + (int)(sin(animationTime * 3 + i) * 5);
             // 绘制星星（实心圆）
-            solidcircle(starX, starY, starSize);
+            canvas.solidCircle(starX, starY, starSize);
         }
     }
 
     // 绘制操作提示
-    settextstyle(20, 0, _T("Arial"));              // 20号字体
-    settextcolor(RGB(200, 200, 255));              // 浅蓝色文字
+    canvas.setTextStyle(20, 0, _T("Arial"));              // 20号字体
+    canvas.setTextColor(RGB(200, 200, 255));              // 浅蓝色文字
     // 重新开始游戏提示
-    outtextxy(SCREEN_WIDTH / 2 - 150, 450,
+    canvas.outText(SCREEN_WIDTH / 2 - 150, 450,
         L"Press SPACE to play again");
     // 返回主菜单提示
-    outtextxy(SCREEN_WIDTH / 2 - 120, 480,
+    canvas.outText(SCREEN_WIDTH / 2 - 120, 480,
         L"Press ESC to return to menu");
+    // 倒带提示（自动演示不能倒带）
+    if (!attractMode && !rewind->isEmpty()) {
+        const wchar_t* tip = L"Press BACKSPACE to rewind";
+        canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(tip) / 2, 510, tip);
+    }
+}
+
+// 绘制倒带界面：剩余可倒带的时间轴、当前位置、操作提示和缓冲占用
+void Game::drawRewindOverlay() {
+    RenderList& canvas = RenderList::getInstance();
+    FrameArena& arena = FrameArena::getInstance();
+    const uint32_t oldest = rewind->getOldestTick();
+    const uint32_t newest = rewind->getNewestTick();
+    const wchar_t* text;
+
+    canvas.setBkMode(TRANSPARENT);
+    canvas.setTextStyle(32, 0, _T("Arial"));
+    canvas.setTextColor(COLOR_TEXT_YELLOW);
+    text = arena.format(L"<< REWIND  -%.2f s", (newest - rewindTick) / FPS);
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(text) / 2, 110, text);
+
+    // 时间轴：整条代表 REWIND_SECONDS 秒，已记录的部分为灰色，当前位置为黄色
+    const int barLeft = 100, barRight = SCREEN_WIDTH - 100;
+    const int barTop = SCREEN_HEIGHT - GROUND_HEIGHT + 12, barBottom = barTop + 10;
+    auto tickToX = [&](uint32_t tick) {
+        int64_t fromEnd = (int64_t)newest - tick;
+        return barRight - (int)(fromEnd * (barRight - barLeft) / REWIND_TICKS);
+    };
+    canvas.setFillColor(RGB(60, 60, 80));
+    canvas.solidRectangle(barLeft, barTop, barRight, barBottom);
+    canvas.setFillColor(RGB(150, 150, 170));
+    canvas.solidRectangle(tickToX(oldest), barTop, barRight, barBottom);
+    canvas.setFillColor(COLOR_TEXT_YELLOW);
+    int cursorX = tickToX(rewindTick);
+    canvas.solidRectangle(cursorX - 2, barTop - 4, cursorX + 2, barBottom + 4);
+
+    canvas.setTextStyle(14, 0, _T("Arial"));
+    canvas.setTextColor(COLOR_TEXT_WHITE);
+    text = L"LEFT/BACKSPACE: back  RIGHT: forward  SPACE: resume here  ESC: cancel";
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(text) / 2, barBottom + 8, text);
+
+    canvas.setTextColor(RGB(200, 200, 255));
+    text = arena.format(L"buffer %d KB, seek %.1f us, keyframes %llu (forced %llu)",
+        (int)(RewindBuffer::getMemoryBytes() / 1024), rewindSeekMicros,
+        (unsigned long long)rewind->getKeyframeCount(), (unsigned long long)rewind->getForcedKeyframeCount());
+    canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(text) / 2, 150, text);
 }
 
 // 绘制排行榜界面
 void Game::drawLeaderboard() {
+    RenderList& canvas = RenderList::getInstance();
     // 深蓝色背景
-    setfillcolor(RGB(20, 25, 40));  // RGB(20,25,40)深蓝色
-    fillrectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    canvas.setFillColor(RGB(20, 25, 40));  // RGB(20,25,40)深蓝色
+    canvas.fillRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     // 绘制标题"LEADERBOARD"
-    settextstyle(48, 0, _T("Arial"));       // 48号字体
-    settextcolor(COLOR_TEXT_YELLOW);        // 黄色文字
-    outtextxy(SCREEN_WIDTH / 2 - 100, 40, L"LEADERBOARD");
+    canvas.setTextStyle(48, 0, _T("Arial"));       // 48号字体
+    canvas.setTextColor(COLOR_TEXT_YELLOW);        // 黄色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 100, 40, L"LEADERBOARD");
 
     // 绘制列标题
-    settextstyle(20, 0, _T("Arial"));       // 20号字体
-    settextcolor(RGB(180, 180, 255));       // 浅紫色文字
+    canvas.setTextStyle(20, 0, _T("Arial"));       // 20号字体
+    canvas.setTextColor(RGB(180, 180, 255));       // 浅紫色文字
 
     // 显示各列标题
-    outtextxy(100, 110, L"Rank");    // 排名
-    outtextxy(180, 110, L"Player");  // 玩家
-    outtextxy(350, 110, L"Score");   // 分数
-    outtextxy(450, 110, L"Level");   // 等级
-    outtextxy(550, 110, L"Time");    // 时间
-    outtextxy(650, 110, L"Date");    // 日期
+    canvas.outText(100, 110, L"Rank");    // 排名
+    canvas.outText(180, 110, L"Player");  // 玩家
+    canvas.outText(350, 110, L"Score");   // 分数
+    canvas.outText(450, 110, L"Level");   // 等级
+    canvas.outText(550, 110, L"Time");    // 时间
+    canvas.outText(650, 110, L"Date");    // 日期
 
     // 绘制标题下方的分隔线
-    setlinecolor(RGB(100, 100, 150));       // 深蓝色线条
-    line(80, 140, 720, 140);               // 从(80,140)到(720,140)
+    canvas.setLineColor(RGB(100, 100, 150));       // 深蓝色线条
+    canvas.line(80, 140, 720, 140);               // 从(80,140)到(720,140)
 
     // 绘制排行榜数据
-    settextstyle(18, 0, _T("Arial"));       // 18号字体
+    canvas.setTextStyle(18, 0, _T("Arial"));       // 18号字体
 
     // 显示最多10条记录
     int displayCount = (int)leaderboard.size() < 10 ? (int)leaderboard.size() : 10;
@@ -1268,75 +2026,73 @@ void Game::drawLeaderboard() {
 
         // 交替行使用不同背景色，提高可读性
         if (i % 2 == 0) {
-            setfillcolor(RGB(40, 45, 70));  // 较浅的深蓝色
+            canvas.setFillColor(RGB(40, 45, 70));  // 较浅的深蓝色
         }
         else {
-            setfillcolor(RGB(30, 35, 60));  // 较深的深蓝色
+            canvas.setFillColor(RGB(30, 35, 60));  // 较深的深蓝色
         }
         // 填充行背景
-        fillrectangle(80, y - 5, 720, y + 30);
+        canvas.fillRectangle(80, y - 5, 720, y + 30);
 
         // 根据排名设置文字颜色
-        if (i == 0) settextcolor(RGB(255, 215, 0));      // 第一名：金色
-        else if (i == 1) settextcolor(RGB(192, 192, 192)); // 第二名：银色
-        else if (i == 2) settextcolor(RGB(205, 127, 50));  // 第三名：铜色
-        else settextcolor(RGB(200, 200, 255));           // 其他名次：浅蓝色
+        if (i == 0) canvas.setTextColor(RGB(255, 215, 0));      // 第一名：金色
+        else if (i == 1) canvas.setTextColor(RGB(192, 192, 192)); // 第二名：银色
+        else if (i == 2) canvas.setTextColor(RGB(205, 127, 50));  // 第三名：铜色
+        else canvas.setTextColor(RGB(200, 200, 255));           // 其他名次：浅蓝色
 
-        wchar_t wbuffer[50];  // 格式化字符串缓冲区
+        FrameArena& arena = FrameArena::getInstance();  // 每行的文字都放在帧内存里
 
         // 显示排名（第几名）
-        swprintf_s(wbuffer, 50, L"%d.", i + 1);
-        outtextxy(100, y, wbuffer);
+        const wchar_t* text = arena.format(L"%d.", i + 1);
+        canvas.outText(100, y, text);
 
         // 显示玩家名称（绿色文字）
-        settextcolor(RGB(100, 255, 100));  // 亮绿色
-        wchar_t wname[50];
-        size_t converted = 0;
+        canvas.setTextColor(RGB(100, 255, 100));  // 亮绿色
         // 转换玩家名称从多字节到宽字符
-        mbstowcs_s(&converted, wname, leaderboard[i].playerName.c_str(), 50);
-        outtextxy(180, y, wname);
+        canvas.outText(180, y, arena.widen(leaderboard[i].playerName.c_str()));
 
         // 显示分数（白色文字）
-        settextcolor(COLOR_TEXT_WHITE);
-        swprintf_s(wbuffer, 50, L"%d", leaderboard[i].score);
-        outtextxy(350, y, wbuffer);
+        canvas.setTextColor(COLOR_TEXT_WHITE);
+        text = arena.format(L"%d", leaderboard[i].score);
+        canvas.outText(350, y, text);
 
         // 显示等级（白色文字）
-        swprintf_s(wbuffer, 50, L"%d", leaderboard[i].level);
-        outtextxy(450, y, wbuffer);
+        text = arena.format(L"%d", leaderboard[i].level);
+        canvas.outText(450, y, text);
 
         // 显示游戏时间（分钟:秒格式）
         int minutes = leaderboard[i].playTime / 60;  // 分钟
         int seconds = leaderboard[i].playTime % 60;  // 秒
-        swprintf_s(wbuffer, 50, L"%02d:%02d", minutes, seconds);
-        outtextxy(550, y, wbuffer);
+        text = arena.format(L"%02d:%02d", minutes, seconds);
+        canvas.outText(550, y, text);
 
         // 显示日期（月/日格式）
         tm timeinfo;  // 时间结构体
         localtime_s(&timeinfo, &leaderboard[i].date);  // 转换时间为本地时间
-        swprintf_s(wbuffer, 50, L"%02d/%02d",
+        text = arena.format(L"%02d/%02d",
             timeinfo.tm_mon + 1,  // 月份（从0开始，所以+1）
             timeinfo.tm_mday);    // 日
-        outtextxy(650, y, wbuffer);
+        canvas.outText(650, y, text);
     }
 
     // 绘制返回提示
-    settextstyle(18, 0, _T("Arial"));       // 18号字体
-    settextcolor(RGB(150, 150, 200));       // 浅紫色文字
-    outtextxy(SCREEN_WIDTH / 2 - 100, 550,
+    canvas.setTextStyle(18, 0, _T("Arial"));       // 18号字体
+    canvas.setTextColor(RGB(150, 150, 200));       // 浅紫色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 100, 550,
         L"Press ESC to return to menu");
 }
 
 // 绘制设置界面
 void Game::drawSettings() {
+    RenderList& canvas = RenderList::getInstance();
     // 深蓝色背景
-    setfillcolor(RGB(30, 35, 50));  // RGB(30,35,50)
-    fillrectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    canvas.setFillColor(RGB(30, 35, 50));  // RGB(30,35,50)
+    canvas.fillRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     // 绘制标题"SETTINGS"
-    settextstyle(48, 0, _T("Arial"));       // 48号字体
-    settextcolor(COLOR_TEXT_BLUE);          // 蓝色文字
-    outtextxy(SCREEN_WIDTH / 2 - 100, 40, L"SETTINGS");
+    canvas.setTextStyle(48, 0, _T("Arial"));       // 48号字体
+    canvas.setTextColor(COLOR_TEXT_BLUE);          // 蓝色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 100, 40, L"SETTINGS");
 
     // 设置项名称数组
     const wchar_t* settingNames[] = {
@@ -1351,23 +2107,23 @@ void Game::drawSettings() {
     const wchar_t* difficultyNames[] = { L"EASY", L"NORMAL", L"HARD" };
 
     // 绘制所有设置项
-    settextstyle(24, 0, _T("Arial"));       // 24号字体
+    canvas.setTextStyle(24, 0, _T("Arial"));       // 24号字体
 
     for (int i = 0; i < 5; i++) {
         int y = 120 + i * 70;  // 计算每个设置项的Y坐标（间距70像素）
 
         // 根据是否选中设置不同的文字颜色
         if (i == selectedSetting) {
-            settextcolor(COLOR_TEXT_RED);  // 选中项：红色
+            canvas.setTextColor(COLOR_TEXT_RED);  // 选中项：红色
         }
         else {
-            settextcolor(COLOR_TEXT_WHITE); // 未选中：白色
+            canvas.setTextColor(COLOR_TEXT_WHITE); // 未选中：白色
         }
         // 显示设置项名称
-        outtextxy(150, y, settingNames[i]);
+        canvas.outText(150, y, settingNames[i]);
 
         // 显示设置项的当前值（浅蓝色文字）
-        settextcolor(RGB(200, 200, 255));
+        canvas.setTextColor(RGB(200, 200, 255));
         wchar_t wbuffer[50];
 
         // 根据设置项索引显示对应的值
@@ -1390,7 +2146,7 @@ void Game::drawSettings() {
         }
 
         // 显示设置项的值
-        outtextxy(500, y, wbuffer);
+        canvas.outText(500, y, wbuffer);
 
         // 前3个设置项有进度条
         if (i < 3) {
@@ -1399,27 +2155,28 @@ void Game::drawSettings() {
 
         // 如果当前设置项被选中，在左侧绘制红色小圆点
         if (i == selectedSetting) {
-            setfillcolor(COLOR_TEXT_RED);
-            solidcircle(120, y + 15, 8);  // 绘制小圆点
+            canvas.setFillColor(COLOR_TEXT_RED);
+            canvas.solidCircle(120, y + 15, 8);  // 绘制小圆点
         }
     }
 
     // 绘制操作提示
-    settextstyle(18, 0, _T("Arial"));       // 18号字体
-    settextcolor(RGB(150, 150, 200));       // 浅紫色文字
+    canvas.setTextStyle(18, 0, _T("Arial"));       // 18号字体
+    canvas.setTextColor(RGB(150, 150, 200));       // 浅紫色文字
     // 导航和调整提示
-    outtextxy(SCREEN_WIDTH / 2 - 200, 500,
+    canvas.outText(SCREEN_WIDTH / 2 - 200, 500,
         L"Use ARROW KEYS to navigate and adjust values");
     // 保存返回提示
-    outtextxy(SCREEN_WIDTH / 2 - 120, 530,
+    canvas.outText(SCREEN_WIDTH / 2 - 120, 530,
         L"Press ESC to save and return");
 }
 
 // 绘制进度条方法
 void Game::drawProgressBar(int x, int y, int width, int height, int type) {
+    RenderList& canvas = RenderList::getInstance();
     // 绘制进度条背景（深灰色）
-    setfillcolor(RGB(60, 60, 80));
-    fillrectangle(x, y, x + width, y + height);
+    canvas.setFillColor(RGB(60, 60, 80));
+    canvas.fillRectangle(x, y, x + width, y + height);
 
     float value = 0;        // 进度值（0到1之间）
     COLORREF fillColor;     // 进度条填充颜色
@@ -1444,29 +2201,30 @@ void Game::drawProgressBar(int x, int y, int width, int height, int type) {
     }
 
     // 绘制进度条填充部分
-    setfillcolor(fillColor);
+    canvas.setFillColor(fillColor);
     // 根据value计算填充宽度
-    fillrectangle(x, y, x + (int)(width * value), y + height);
+    canvas.fillRectangle(x, y, x + (int)(width * value), y + height);
 
     // 绘制进度条边框
-    setlinecolor(RGB(100, 100, 120));  // 深灰色边框
-    rectangle(x, y, x + width, y + height);
+    canvas.setLineColor(RGB(100, 100, 120));  // 深灰色边框
+    canvas.rectangle(x, y, x + width, y + height);
 }
 
 // 绘制帮助界面
 void Game::drawHelp() {
+    RenderList& canvas = RenderList::getInstance();
     // 深绿色背景
-    setfillcolor(RGB(25, 40, 30));  // RGB(25,40,30)深绿色
-    fillrectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    canvas.setFillColor(RGB(25, 40, 30));  // RGB(25,40,30)深绿色
+    canvas.fillRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     // 绘制标题"HELP"
-    settextstyle(48, 0, _T("Arial"));       // 48号字体
-    settextcolor(COLOR_TEXT_GREEN);         // 绿色文字
-    outtextxy(SCREEN_WIDTH / 2 - 80, 40, L"HELP");
+    canvas.setTextStyle(48, 0, _T("Arial"));       // 48号字体
+    canvas.setTextColor(COLOR_TEXT_GREEN);         // 绿色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 80, 40, L"HELP");
 
     // 设置帮助文本样式
-    settextstyle(20, 0, _T("Arial"));       // 20号字体
-    settextcolor(COLOR_TEXT_WHITE);         // 白色文字
+    canvas.setTextStyle(20, 0, _T("Arial"));       // 20号字体
+    canvas.setTextColor(COLOR_TEXT_WHITE);         // 白色文字
 
     // 帮助文本数组（多行）
     const wchar_t* helpLines[] = {
@@ -1498,35 +2256,36 @@ void Game::drawHelp() {
     // 绘制所有帮助文本行
     for (int i = 0; i < numLines; i++) {
         // 每行垂直间距25像素
-        outtextxy(100, 100 + i * 25, helpLines[i]);
+        canvas.outText(100, 100 + i * 25, helpLines[i]);
     }
 
     // 绘制返回提示
-    settextstyle(18, 0, _T("Arial"));       // 18号字体
-    settextcolor(RGB(150, 200, 150));       // 浅绿色文字
-    outtextxy(SCREEN_WIDTH / 2 - 120, 550,
+    canvas.setTextStyle(18, 0, _T("Arial"));       // 18号字体
+    canvas.setTextColor(RGB(150, 200, 150));       // 浅绿色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 120, 550,
         L"Press ESC to return to menu");
 }
 
 // 绘制制作人员界面
 void Game::drawCredits() {
+    RenderList& canvas = RenderList::getInstance();
     // 深紫色背景
-    setfillcolor(RGB(40, 30, 50));  // RGB(40,30,50)深紫色
-    fillrectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    canvas.setFillColor(RGB(40, 30, 50));  // RGB(40,30,50)深紫色
+    canvas.fillRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
     // 绘制标题"CREDITS"
-    settextstyle(48, 0, _T("Arial"));       // 48号字体
-    settextcolor(COLOR_TEXT_PURPLE);        // 紫色文字
-    outtextxy(SCREEN_WIDTH / 2 - 120, 40, L"CREDITS");
+    canvas.setTextStyle(48, 0, _T("Arial"));       // 48号字体
+    canvas.setTextColor(COLOR_TEXT_PURPLE);        // 紫色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 120, 40, L"CREDITS");
 
     // 绘制副标题
-    settextstyle(28, 0, _T("Arial"));       // 28号字体
-    settextcolor(RGB(255, 200, 255));       // 浅粉色文字
-    outtextxy(SCREEN_WIDTH / 2 - 150, 120, L"FLAPPY BIRD ULTIMATE EDITION");
+    canvas.setTextStyle(28, 0, _T("Arial"));       // 28号字体
+    canvas.setTextColor(RGB(255, 200, 255));       // 浅粉色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 150, 120, L"FLAPPY BIRD ULTIMATE EDITION");
 
     // 设置制作人员信息样式
-    settextstyle(22, 0, _T("Arial"));       // 22号字体
-    settextcolor(COLOR_TEXT_WHITE);         // 白色文字
+    canvas.setTextStyle(22, 0, _T("Arial"));       // 22号字体
+    canvas.setTextColor(COLOR_TEXT_WHITE);         // 白色文字
 
     // 制作人员信息数组
     const wchar_t* credits[] = {
@@ -1552,19 +2311,19 @@ void Game::drawCredits() {
     for (int i = 0; i < numCredits; i++) {
         int y = 180 + i * 30;  // 每行垂直间距30像素
         // 居中显示每一行
-        outtextxy(SCREEN_WIDTH / 2 - textwidth(credits[i]) / 2, y, credits[i]);
+        canvas.outText(SCREEN_WIDTH / 2 - canvas.textWidth(credits[i]) / 2, y, credits[i]);
     }
 
     // 绘制动态的心形效果（使用圆形替代）
     float pulse = sin(animationTime * 2) * 0.5f + 0.5f;  // 计算脉冲值（0-1之间）
-    setfillcolor(RGB(255, 0, 0));  // 红色填充
+    canvas.setFillColor(RGB(255, 0, 0));  // 红色填充
     // 绘制大小动态变化的圆形（20-30像素）
-    solidcircle(SCREEN_WIDTH / 2, 500, 20 + (int)(pulse * 10));
+    canvas.solidCircle(SCREEN_WIDTH / 2, 500, 20 + (int)(pulse * 10));
 
     // 绘制返回提示
-    settextstyle(18, 0, _T("Arial"));       // 18号字体
-    settextcolor(RGB(200, 150, 200));       // 浅紫色文字
-    outtextxy(SCREEN_WIDTH / 2 - 120, 550,
+    canvas.setTextStyle(18, 0, _T("Arial"));       // 18号字体
+    canvas.setTextColor(RGB(200, 150, 200));       // 浅紫色文字
+    canvas.outText(SCREEN_WIDTH / 2 - 120, 550,
         L"Press ESC to return to menu");
 }
 
@@ -1582,19 +2341,30 @@ void Game::run() {
     LARGE_INTEGER lastTime, currentTime;  // 上次和当前时间
     QueryPerformanceFrequency(&frequency);  // 获取计时器频率（每秒计数次数）
     QueryPerformanceCounter(&lastTime);     // 获取初始时间
+    LARGE_INTEGER startTime = lastTime;     // 启动时刻，帧时间样本的时间戳从这里算起
 
     const double frameInterval = 1.0 / FPS;  // 每帧的理想时间（秒）
     double accumulator = 0.0;                // 时间累积器
 
     srand((unsigned)time(NULL));
 
+    Profiler::getInstance().setThreadName("Main");
+
+    // 静态界面的省电等待；注册失败时所有界面都按60FPS运行
+    bool idleAvailable = idleWaiter->init();
+    bool idleFrame = false;     // 这一帧之前是省电等待（帧间隔不计入帧时间统计）
+
     // 游戏主循环
     while (true) {
+        // 上一帧的临时数据全部释放（帧内存只移动指针，O(1)）
+        FrameArena::getInstance().reset();
+
         QueryPerformanceCounter(&currentTime);  // 获取当前时间
 
         // 计算自上次循环以来经过的时间（秒）
         double elapsedTime = (double)(currentTime.QuadPart - lastTime.QuadPart) / frequency.QuadPart;
         lastTime = currentTime;  // 更新上次时间
+        float frameMs = (float)(elapsedTime * 1000.0);  // 记录未截断的真实帧间隔
 
         if (elapsedTime > 0.25) elapsedTime = 0.25;  // 防止时间过长（防卡顿）
 
@@ -1604,13 +2374,56 @@ void Game::run() {
         updateInput();
 
         // 固定时间步长更新（维持稳定的游戏更新频率）
+        tickAllocations = 0;
         while (accumulator >= frameInterval) {
+            AllocationScope tickScope;
             update((float)frameInterval);  // 用固定的时间步长更新游戏
             accumulator -= frameInterval;   // 减去已消耗的时间
+            tickAllocations = std::max(tickAllocations, tickScope.count());
         }
 
+        LARGE_INTEGER updateEnd;
+        QueryPerformanceCounter(&updateEnd);
+
         // 渲染当前帧
+        AllocationScope frameScope;
         render();
+        frameAllocations = frameScope.count();
+
+        LARGE_INTEGER renderEnd;
+        QueryPerformanceCounter(&renderEnd);
+        double ticksPerMs = frequency.QuadPart / 1000.0;
+        if (!idleFrame) {
+            frameStats->addSample(
+                (double)(currentTime.QuadPart - startTime.QuadPart) / frequency.QuadPart,
+                frameMs,
+                (float)((updateEnd.QuadPart - currentTime.QuadPart) / ticksPerMs),
+                (float)((renderEnd.QuadPart - updateEnd.QuadPart) / ticksPerMs));
+        }
+        idleWaiter->updateStats();
+
+        // 性能分析：一帧结束，采集满了就写出文件
+        Profiler& profiler = Profiler::getInstance();
+        if (profiler.isCapturing()) {
+            if (profiler.endFrame()) {
+                std::cout << "性能分析已保存: " << profiler.getLastTracePath() << std::endl;
+            }
+        }
+
+        // 静态界面：画完这一帧后阻塞，直到有按键或到了下一次动画帧，不再每16毫秒醒来。
+        // 观战广播和性能分析采集需要连续的帧，不进入省电等待
+        idleFrame = idleAvailable && isStaticScreen() && !broadcaster && !profiler.isCapturing();
+        if (idleFrame) {
+            PROFILE_SCOPE("IdleWait");
+            ULONGLONG deadline = GetTickCount64() + 1000 / IDLE_ANIMATION_FPS;
+            while (true) {
+                ULONGLONG now = GetTickCount64();
+                if (now >= deadline) break;
+                // 键盘连发、与按键状态无关的输入只唤醒一下，不重画
+                if (idleWaiter->wait((DWORD)(deadline - now)) && keyStateChanged()) break;
+            }
+            continue;
+        }
 
         // 计算并控制帧率
         double frameTime = (double)(currentTime.QuadPart - lastTime.QuadPart) / frequency.QuadPart;
@@ -1620,8 +2433,10 @@ void Game::run() {
         if (sleepTime > 0) {
             DWORD sleepMs = (DWORD)(sleepTime * 1000.0);  // 转换为毫秒
 
+            PROFILE_SCOPE("FrameWait");
             if (sleepMs > 0) {
                 Sleep(sleepMs);  // 使用Sleep函数休眠
+                idleWaiter->countWakeup();
             }
             else {
                 // 如果睡眠时间太短，使用忙等待